@@ -241,6 +241,51 @@ out:
     return ret;
 }
 
+/* Back-patches a FILE by seeking, for comparing against the size pass that <owf_binary_writer_init_file> uses. */
+static bool owf_bench_file_patch_cb(const void *src, const size_t size, const size_t distance, void *data) {
+    FILE *ptr = (FILE *)data;
+    return distance <= LONG_MAX &&
+        fseek(ptr, -(long)distance, SEEK_CUR) == 0 &&
+        fwrite(src, sizeof(uint8_t), size, ptr) == size &&
+        fseek(ptr, (long)(distance - size), SEEK_CUR) == 0;
+}
+
+bool owf_benchmark_run_file(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, owf_package_t *package_to_encode, uint32_t size, size_t num_iterations, bool patch) {
+    owf_binary_writer_t writer;
+    owf_bench_rolling_avg_t avg;
+    owf_time_t start, end;
+    FILE *file = tmpfile();
+
+    if (file == NULL) {
+        fprintf(logger, "couldn't open a temporary file\n");
+        return false;
+    }
+
+    owf_bench_rolling_avg_init(&avg);
+    for (size_t i = 0; i < num_iterations; i++) {
+        rewind(file);
+        start = owf_benchmark_time_now();
+        {
+            owf_binary_writer_init_file(&writer, file, alloc, error);
+            if (patch) {
+                writer.writer.patch = owf_bench_file_patch_cb;
+            }
+            if (OWF_NOEXPECT(!owf_binary_write(&writer, package_to_encode) || fflush(file) != 0)) {
+                fprintf(logger, "binary write failed\n");
+                fclose(file);
+                return false;
+            }
+        }
+        end = owf_benchmark_time_now();
+        owf_bench_rolling_avg_put(&avg, (end - start) / 1.0e7);
+    }
+    owf_bench_rolling_avg_print(&avg, logger, patch ? "Encoding to a file (back-patched)" : "Encoding to a file");
+    fprintf(logger, "Throughput: %.0f bytes/sec\n", size / owf_bench_rolling_avg_mean(&avg));
+
+    fclose(file);
+    return true;
+}
+
 bool owf_benchmark_run(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, owf_package_t *package_to_encode, uint32_t size, size_t num_iterations) {
     owf_binary_writer_t writer;
     owf_binary_reader_t reader;
@@ -343,7 +388,9 @@ bool owf_benchmark_start(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, o
     } else {
         owf_package_stringify(&package, buf, sizeof(buf));
         fprintf(logger, "Package %s, length: " OWF_PRINT_U32 " bytes\n", buf, package_size);
-        ret = owf_benchmark_run(logger, alloc, error, &package, package_size, config->num_messages);
+        ret = owf_benchmark_run(logger, alloc, error, &package, package_size, config->num_messages) &&
+            owf_benchmark_run_file(logger, alloc, error, &package, package_size, config->num_messages, false) &&
+            owf_benchmark_run_file(logger, alloc, error, &package, package_size, config->num_messages, true);
     }
 
     owf_package_destroy(&package, alloc);
@@ -13,6 +13,11 @@
  */
 #define OWF_ALLOC_DEFAULT_MAX 1048576
 
+/* The alignment <owf_malloc> asks for, which is enough for every type stored in a package.
+ * Any malloc implementation already guarantees this much.
+ */
+#define OWF_ALLOC_DEFAULT_ALIGN (sizeof(double) > sizeof(void *) ? sizeof(double) : sizeof(void *))
+
 /* A malloc callback.
  *
  * Takes the size of the allocation, which will never be 0.
@@ -32,7 +37,54 @@ typedef void *(*owf_realloc_cb_t)(void *, size_t);
  */
 typedef void (*owf_free_cb_t)(void *);
 
-/* A struct holding information about memory allocation functions. */
+/* A context-aware malloc callback.
+ *
+ * Takes the allocator's context, the size of the allocation, which will never be 0,
+ * and the required alignment, which will always be a power of two.
+ */
+typedef void *(*owf_ctx_malloc_cb_t)(void *, size_t, size_t);
+
+/* A context-aware realloc callback.
+ *
+ * Takes the allocator's context, the block pointer, which will never be NULL,
+ * the block's current size, or 0 if it isn't known,
+ * the size of the new allocation, which will never be 0,
+ * and the required alignment, which will always be a power of two.
+ */
+typedef void *(*owf_ctx_realloc_cb_t)(void *, void *, size_t, size_t, size_t);
+
+/* A context-aware free callback.
+ *
+ * Takes the allocator's context, the block pointer, which will never be NULL,
+ * and the block's size, or 0 if it isn't known.
+ */
+typedef void (*owf_ctx_free_cb_t)(void *, void *, size_t);
+
+/* A table of context-aware allocation callbacks.
+ *
+ * Unlike the plain callbacks, these get the allocator's context along with every call, so an arena,
+ * a pool, or a per-thread cache can be plugged in without any global state. Size hints are passed
+ * wherever the caller knows them; 0 means the caller doesn't know, and the callbacks must cope.
+ */
+typedef struct owf_alloc_vtable owf_alloc_vtable_t;
+
+/* @see owf_alloc_vtable_t */
+struct owf_alloc_vtable {
+    /* The malloc callback. */
+    owf_ctx_malloc_cb_t malloc;
+
+    /* The realloc callback. */
+    owf_ctx_realloc_cb_t realloc;
+
+    /* The free callback. */
+    owf_ctx_free_cb_t free;
+};
+
+/* A struct holding information about memory allocation functions.
+ *
+ * If `vtable` is set, its callbacks are used along with `ctx`, and the plain callbacks are ignored.
+ * Otherwise, the plain callbacks are used, so an allocator initialized the old way keeps working.
+ */
 typedef struct owf_alloc owf_alloc_t;
 
 /* @see owf_alloc_t */
@@ -48,6 +100,12 @@ struct owf_alloc {
 
     /* The maximum size we are willing to allocate. */
     size_t max_alloc;
+
+    /* The context-aware callbacks, or NULL to use the plain ones. */
+    const owf_alloc_vtable_t *vtable;
+
+    /* The context passed to the context-aware callbacks. */
+    void *ctx;
 };
 
 /* Initializes an <owf_alloc_t> structure.
@@ -59,6 +117,14 @@ struct owf_alloc {
  */
 void owf_alloc_init(owf_alloc_t *alloc, owf_malloc_cb_t malloc_fn, owf_realloc_cb_t realloc_fn, owf_free_cb_t free_fn, size_t max_alloc);
 
+/* Initializes an <owf_alloc_t> structure with context-aware callbacks.
+ * @alloc A pointer to an <owf_alloc_t>
+ * @vtable The callbacks, which must outlive the allocator
+ * @ctx The context to pass to the callbacks
+ * @max_alloc The maximum size that we should ever allocate in a single allocation.
+ */
+void owf_alloc_init_vtable(owf_alloc_t *alloc, const owf_alloc_vtable_t *vtable, void *ctx, size_t max_alloc);
+
 /* Calls the provided malloc callback. Will never pass it a zero or too large size.
  * @alloc A pointer to an <owf_alloc_t>
  * @error A pointer to an <owf_error_t> to store potential errors resulting from the call
@@ -69,6 +135,18 @@ void owf_alloc_init(owf_alloc_t *alloc, owf_malloc_cb_t malloc_fn, owf_realloc_c
  */
 void *owf_malloc(owf_alloc_t *alloc, owf_error_t *error, size_t size);
 
+/* Like <owf_malloc>, but with a stricter alignment.
+ * @alloc A pointer to an <owf_alloc_t>
+ * @error A pointer to an <owf_error_t> to store potential errors resulting from the call
+ * @size The size of the allocation
+ * @align The alignment, which must be a power of two
+ * Plain callbacks can't honor more than <OWF_ALLOC_DEFAULT_ALIGN>, so asking them for more is an error.
+ *
+ * @return A pointer to an allocated block of at least size `size`, or NULL on error.
+ *         If this function returns NULL, an error will be set in the <owf_error_t>.
+ */
+void *owf_malloc_aligned(owf_alloc_t *alloc, owf_error_t *error, size_t size, size_t align);
+
 /* Calls the provided realloc callback. Will never pass it a NULL pointer, zero size, or too large size.
  * @alloc A pointer to an <owf_alloc_t>
  * @error A pointer to an <owf_error_t> to store potential errors resulting from the call
@@ -81,10 +159,28 @@ void *owf_malloc(owf_alloc_t *alloc, owf_error_t *error, size_t size);
  */
 bool owf_realloc(owf_alloc_t *alloc, owf_error_t *error, void **bp, size_t size);
 
+/* Like <owf_realloc>, but tells the allocator how big the block was.
+ * @alloc A pointer to an <owf_alloc_t>
+ * @error A pointer to an <owf_error_t> to store potential errors resulting from the call
+ * @bp A pointer to a pointer to the previously allocated block
+ * @old_size The block's current size, or 0 if it isn't known
+ * @size The size of the allocation
+ *
+ * @return True on success, or false on failure. On failure, the input pointer is not freed or changed.
+ */
+bool owf_realloc_sized(owf_alloc_t *alloc, owf_error_t *error, void **bp, size_t old_size, size_t size);
+
 /* Calls the provided free callback. Will never pass it a NULL pointer.
  * @alloc A pointer to an <owf_alloc_t>
  * @bp A pointer to an allocated block
  */
 void owf_free(owf_alloc_t *alloc, void *bp);
 
+/* Like <owf_free>, but tells the allocator how big the block was.
+ * @alloc A pointer to an <owf_alloc_t>
+ * @bp A pointer to an allocated block
+ * @size The block's size, or 0 if it isn't known
+ */
+void owf_free_sized(owf_alloc_t *alloc, void *bp, size_t size);
+
 #endif /* OWF_ALLOC_H */
@@ -0,0 +1,76 @@
+#include <owf.h>
+#include <owf/error.h>
+#include <owf/alloc.h>
+
+#ifndef OWF_ARENA_H
+#define OWF_ARENA_H
+
+/* The default chunk size for an <owf_arena_t>. */
+#define OWF_ARENA_DEFAULT_CHUNK_SIZE 65536
+
+/* A bump allocator.
+ *
+ * Carves allocations out of large chunks taken from a parent allocator, so allocating is a pointer
+ * bump and freeing does nothing. Everything is released at once by <owf_arena_reset>, which makes
+ * it a good fit for decoding a packet, handing it on, and throwing it away: initialize a reader with
+ * the arena's `alloc`, and reset the arena instead of calling <owf_package_destroy>.
+ *
+ * The most recent allocation can be grown or shrunk in place. Other blocks are copied when they
+ * grow, which needs their old size; every realloc made by this library passes it. An arena isn't
+ * thread-safe, so give each thread of <owf_binary_materialize_parallel> its own.
+ */
+typedef struct owf_arena owf_arena_t;
+
+/* @see owf_arena_t */
+struct owf_arena {
+    /* The allocator to hand out, whose context is this arena */
+    owf_alloc_t alloc;
+
+    /* The allocator chunks come from */
+    owf_alloc_t *parent;
+
+    /* The error from the last chunk allocation that failed */
+    owf_error_t error;
+
+    /* The chunks, newest first */
+    void *chunks;
+
+    /* The next free byte and the end of the newest chunk */
+    uint8_t *next, *end;
+
+    /* The most recent allocation, or NULL */
+    uint8_t *last;
+
+    /* The size of the next chunk */
+    size_t chunk_size;
+
+    /* The total size of all chunks */
+    size_t total;
+
+    /* The number of bytes handed out from chunks older than the newest one */
+    size_t spilled;
+};
+
+/* Initializes an empty <owf_arena_t>. Nothing is allocated until the first allocation.
+ * @arena The arena
+ * @parent The allocator chunks come from, which must outlive the arena
+ * @chunk_size The size of each chunk, or 0 for <OWF_ARENA_DEFAULT_CHUNK_SIZE>
+ * The arena's `alloc` points back at the arena, so the arena mustn't move while it's in use.
+ * Its `max_alloc` is the parent's, less room for a chunk header, and allocations bigger than a chunk get a chunk to themselves.
+ */
+void owf_arena_init(owf_arena_t *arena, owf_alloc_t *parent, size_t chunk_size);
+
+/* Releases everything allocated from an <owf_arena_t>.
+ * @arena The arena
+ * If the allocations spilled into several chunks, they're replaced by one chunk big enough for
+ * all of them (up to the parent's `max_alloc`), so an arena reset between packets of similar
+ * size settles into a single chunk.
+ */
+void owf_arena_reset(owf_arena_t *arena);
+
+/* Destroys an <owf_arena_t>, returning its chunks to the parent allocator.
+ * @arena The arena
+ */
+void owf_arena_destroy(owf_arena_t *arena);
+
+#endif /* OWF_ARENA_H */
@@ -0,0 +1,53 @@
+#include <owf.h>
+#include <owf/platform.h>
+
+#ifndef OWF_BYTESWAP_H
+#define OWF_BYTESWAP_H
+
+/* A bulk 64-bit byteswap kernel.
+ *
+ * Takes a destination, a source, and a number of 64-bit words.
+ */
+typedef void (*owf_byteswap64_cb_t)(void *, const void *, size_t);
+
+/* Byteswaps `count` 64-bit words from `src` into `dst`.
+ * @dst The destination
+ * @src The source
+ * @count The number of 64-bit words
+ * `dst` and `src` may be the same pointer, but must not otherwise overlap. Neither needs
+ * to be aligned. Uses the fastest kernel the CPU supports, chosen on the first call.
+ */
+void owf_byteswap64(void *dst, const void *src, size_t count);
+
+/* Byteswaps `count` 64-bit words from `src` into `dst` one at a time.
+ * @dst The destination
+ * @src The source
+ * @count The number of 64-bit words
+ * This is the portable fallback for <owf_byteswap64>.
+ */
+void owf_byteswap64_scalar(void *dst, const void *src, size_t count);
+
+/* Returns the name of the kernel <owf_byteswap64> uses on this CPU.
+ *
+ * @return "avx512bw", "avx2", "ssse3", "neon", or "scalar"
+ */
+const char *owf_byteswap64_kernel(void);
+
+/* Converts an array of 64-bit words between network and host byte order.
+ * @_dst The destination
+ * @_src The source
+ * @_count The number of 64-bit words
+ */
+#if OWF_ENDIAN == OWF_ENDIAN_LITTLE
+    #define OWF_HOST64_ARRAY(_dst, _src, _count) owf_byteswap64(_dst, _src, _count)
+#else
+    #define OWF_HOST64_ARRAY(_dst, _src, _count) \
+        do { \
+            if ((const void *)(_dst) != (const void *)(_src)) { \
+                memcpy(_dst, _src, (_count) * sizeof(uint64_t)); \
+            } \
+        } while (0)
+#endif
+#define OWF_NET64_ARRAY(_dst, _src, _count) OWF_HOST64_ARRAY(_dst, _src, _count)
+
+#endif /* OWF_BYTESWAP_H */
@@ -0,0 +1,89 @@
+#include <owf.h>
+#include <owf/error.h>
+#include <owf/alloc.h>
+#include <owf/thread.h>
+#include <owf/types.h>
+
+#ifndef OWF_INTERN_H
+#define OWF_INTERN_H
+
+/* The number of independently locked shards in an <owf_intern_t>. Must be a power of two. */
+#define OWF_INTERN_SHARDS 16
+
+/* The number of slots in a shard's first hash table. Must be a power of two. */
+#define OWF_INTERN_MIN_CAPACITY 64
+
+/* An open-addressed hash table of interned strings. Private to intern.c. */
+typedef struct owf_intern_table owf_intern_table_t;
+
+/* One shard of an <owf_intern_t>. */
+typedef struct owf_intern_shard owf_intern_shard_t;
+
+/* @see owf_intern_shard_t */
+struct owf_intern_shard {
+    /* Guards inserts */
+    owf_mutex_t lock;
+
+    /* The current table, which readers load without taking the lock */
+    owf_intern_table_t *table;
+
+    /* Tables replaced by a bigger one, which readers may still be probing until the table is destroyed */
+    owf_intern_table_t *retired;
+
+    /* The number of strings in the shard */
+    uint32_t count;
+};
+
+/* A table of canonical strings.
+ *
+ * The same IDs and units show up in every packet from a device, so a reader given an intern table
+ * (see <owf_binary_reader_set_intern>) points them at one shared, immutable copy instead of giving
+ * each package its own. That saves the allocations, and two interned strings with the same value
+ * have the same pointer, which <owf_str_binary_compare> checks before comparing bytes.
+ *
+ * Lookups don't take a lock, so any number of readers (including the workers of
+ * <owf_binary_materialize_parallel>) can share one table. Inserting a new string locks one of
+ * <OWF_INTERN_SHARDS> shards, picked by the string's hash. Strings are never removed, and their
+ * memory belongs to the table, so packages holding interned strings must not outlive it.
+ */
+typedef struct owf_intern owf_intern_t;
+
+/* @see owf_intern_t */
+struct owf_intern {
+    /* The allocator tables and strings come from, which must be thread-safe if the table is shared */
+    owf_alloc_t *alloc;
+
+    /* The shards */
+    owf_intern_shard_t shards[OWF_INTERN_SHARDS];
+};
+
+/* Initializes an empty <owf_intern_t>. Nothing is allocated until the first string is interned.
+ * @intern The table
+ * @alloc The allocator
+ */
+void owf_intern_init(owf_intern_t *intern, owf_alloc_t *alloc);
+
+/* Returns the canonical copy of a string, adding it to an <owf_intern_t> if it isn't there yet.
+ * @intern The table
+ * @error The error context
+ * @value The string, which doesn't need to be NUL-terminated
+ * @length The length of `value` in bytes, which must be greater than 0
+ * The canonical string is borrowed from the table: copy it by value, and never modify or destroy it.
+ *
+ * @return The canonical string, or NULL if it couldn't be added
+ */
+const owf_str_t *owf_intern_get(owf_intern_t *intern, owf_error_t *error, const char *value, uint32_t length);
+
+/* Returns the number of strings in an <owf_intern_t>.
+ * @intern The table
+ *
+ * @return The number of strings
+ */
+uint32_t owf_intern_count(owf_intern_t *intern);
+
+/* Destroys an <owf_intern_t> and every string in it.
+ * @intern The table
+ */
+void owf_intern_destroy(owf_intern_t *intern);
+
+#endif /* OWF_INTERN_H */
@@ -152,6 +152,15 @@
     #error "invalid OWF_SIZE_BITS value"
 #endif
 
+/* Pointer loads and stores that publish data to other threads */
+#if OWF_PLATFORM_IS_GNU
+    #define OWF_ATOMIC_LOAD_PTR(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+    #define OWF_ATOMIC_STORE_PTR(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#elif OWF_PLATFORM == OWF_PLATFORM_WINDOWS
+    #define OWF_ATOMIC_LOAD_PTR(ptr) InterlockedCompareExchangePointer((PVOID volatile *)(ptr), NULL, NULL)
+    #define OWF_ATOMIC_STORE_PTR(ptr, value) ((void)InterlockedExchangePointer((PVOID volatile *)(ptr), (value)))
+#endif
+
 /* Token concatenation */
 #define OWF_CONCAT2(a, b) a ## b
 #define OWF_CONCAT(a, b) OWF_CONCAT2(a, b)
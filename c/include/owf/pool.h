@@ -0,0 +1,122 @@
+#include <owf.h>
+#include <owf/error.h>
+#include <owf/alloc.h>
+#include <owf/thread.h>
+
+#ifndef OWF_POOL_H
+#define OWF_POOL_H
+
+/* The number of size classes in an <owf_pool_t>. */
+#define OWF_POOL_CLASSES 14
+
+/* The largest allocation an <owf_pool_t> serves from its slabs. Larger ones go to the parent allocator. */
+#define OWF_POOL_MAX_CLASS_SIZE 2048
+
+/* The default slab size for an <owf_pool_t>. */
+#define OWF_POOL_DEFAULT_SLAB_SIZE 65536
+
+/* The number of blocks of each size class an <owf_pool_magazine_t> caches before giving half back. */
+#define OWF_POOL_MAGAZINE_SIZE 64
+
+/* A list of free blocks of one size class. */
+typedef struct owf_pool_list owf_pool_list_t;
+
+/* @see owf_pool_list_t */
+struct owf_pool_list {
+    /* The first free block, which points to the next, or NULL */
+    void *head;
+
+    /* The number of blocks in the list */
+    uint32_t count;
+};
+
+/* A pool of fixed-size blocks.
+ *
+ * Small allocations (ID strings and short node arrays, which make up most of a package) are rounded
+ * up to one of a few size classes and carved out of slabs, one size class per slab. Freed blocks go on
+ * a free list for their class and are reused by the next allocation of that class, so a long-running
+ * process that keeps decoding packages reaches a steady number of slabs instead of fragmenting the
+ * heap. Slabs are only returned to the parent allocator when the pool is destroyed.
+ *
+ * The pool's own `alloc` is thread-safe, and takes a lock for every call. Threads that allocate a lot
+ * should each use an <owf_pool_magazine_t> instead, which only takes the lock to move blocks in bulk.
+ * Every block has a small header, so blocks can be freed without knowing their size, and can be freed
+ * through any magazine of the same pool. Alignments beyond <OWF_ALLOC_DEFAULT_ALIGN> aren't supported.
+ */
+typedef struct owf_pool owf_pool_t;
+
+/* @see owf_pool_t */
+struct owf_pool {
+    /* The thread-safe allocator to hand out, whose context is this pool */
+    owf_alloc_t alloc;
+
+    /* The allocator slabs and large blocks come from */
+    owf_alloc_t *parent;
+
+    /* Guards everything below */
+    owf_mutex_t lock;
+
+    /* The slabs, newest first */
+    void *slabs;
+
+    /* Free blocks of each size class */
+    owf_pool_list_t free[OWF_POOL_CLASSES];
+
+    /* The part of each size class's newest slab that hasn't been handed out yet */
+    struct {
+        uint8_t *next, *end;
+    } carve[OWF_POOL_CLASSES];
+
+    /* The size of each slab */
+    size_t slab_size;
+
+    /* The number of slabs */
+    uint32_t slab_count;
+};
+
+/* A per-thread cache of blocks from an <owf_pool_t>.
+ *
+ * Allocating and freeing through a magazine's `alloc` only touches the magazine, except when a size
+ * class runs dry or overflows, and then blocks move to or from the pool half a magazine at a time.
+ * A magazine must only be used by one thread at a time.
+ */
+typedef struct owf_pool_magazine owf_pool_magazine_t;
+
+/* @see owf_pool_magazine_t */
+struct owf_pool_magazine {
+    /* The allocator to hand out, whose context is this magazine */
+    owf_alloc_t alloc;
+
+    /* The pool */
+    owf_pool_t *pool;
+
+    /* Cached blocks of each size class */
+    owf_pool_list_t free[OWF_POOL_CLASSES];
+};
+
+/* Initializes an empty <owf_pool_t>. Nothing is allocated until the first allocation.
+ * @pool The pool, which mustn't move while it's in use
+ * @parent The allocator slabs and large blocks come from, which must be thread-safe if the pool is shared
+ * @slab_size The size of each slab, or 0 for <OWF_POOL_DEFAULT_SLAB_SIZE>
+ */
+void owf_pool_init(owf_pool_t *pool, owf_alloc_t *parent, size_t slab_size);
+
+/* Destroys an <owf_pool_t>, returning its slabs to the parent allocator.
+ * @pool The pool
+ * Large blocks still allocated are not freed. Magazines of the pool mustn't be used afterwards.
+ */
+void owf_pool_destroy(owf_pool_t *pool);
+
+/* Initializes an empty <owf_pool_magazine_t>.
+ * @magazine The magazine, which mustn't move while it's in use
+ * @pool The pool
+ */
+void owf_pool_magazine_init(owf_pool_magazine_t *magazine, owf_pool_t *pool);
+
+/* Gives every block cached in an <owf_pool_magazine_t> back to its pool.
+ * @magazine The magazine
+ * Call this before a thread using the magazine exits, so other threads can reuse its blocks.
+ */
+void owf_pool_magazine_flush(owf_pool_magazine_t *magazine);
+
+#endif /* OWF_POOL_H */
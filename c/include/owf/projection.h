@@ -0,0 +1,88 @@
+#include <owf.h>
+#include <owf/platform.h>
+
+#include <string.h>
+
+#ifndef OWF_PROJECTION_H
+#define OWF_PROJECTION_H
+
+/* Flags that drop whole kinds of namespace children. */
+typedef enum owf_projection_flags owf_projection_flags_t;
+
+/* @see owf_projection_flags_t */
+enum owf_projection_flags {
+    /* Skip signals */
+    OWF_PROJECTION_NO_SIGNALS = 1 << 0,
+
+    /* Skip events */
+    OWF_PROJECTION_NO_EVENTS = 1 << 1,
+
+    /* Skip alarms */
+    OWF_PROJECTION_NO_ALARMS = 1 << 2
+};
+
+/* A set of IDs to keep.
+ *
+ * An empty set keeps everything. IDs are compared against each entry in turn, so
+ * sets are meant to be small.
+ */
+typedef struct owf_projection_set owf_projection_set_t;
+
+/* @see owf_projection_set_t */
+struct owf_projection_set {
+    /* The IDs, as NULL-terminated strings */
+    const char *const *ids;
+
+    /* The number of IDs */
+    uint32_t count;
+
+    /* Whether the IDs are prefixes rather than whole IDs */
+    bool prefix;
+};
+
+/* Describes which parts of a package a reader should decode.
+ *
+ * Channels, namespaces, and signals whose IDs aren't in the corresponding set are skipped
+ * before anything is allocated for them, as are the kinds of children excluded by `flags`.
+ * Skipped nodes are never passed to the visitor.
+ */
+typedef struct owf_projection owf_projection_t;
+
+/* @see owf_projection_t */
+struct owf_projection {
+    /* Channel IDs to keep */
+    owf_projection_set_t channels;
+
+    /* Namespace IDs to keep */
+    owf_projection_set_t namespaces;
+
+    /* Signal IDs to keep */
+    owf_projection_set_t signals;
+
+    /* A combination of <owf_projection_flags_t> */
+    uint32_t flags;
+};
+
+/* Initializes a projection that keeps everything.
+ * @projection The projection
+ */
+void owf_projection_init(owf_projection_t *projection);
+
+/* Sets the IDs in a projection set.
+ * @set The set
+ * @ids The IDs, which must outlive the set
+ * @count The number of IDs; 0 keeps everything
+ * @prefix Whether the IDs are prefixes rather than whole IDs
+ */
+void owf_projection_set_init(owf_projection_set_t *set, const char *const *ids, uint32_t count, bool prefix);
+
+/* Tests whether an ID is in a projection set.
+ * @set The set, or NULL to match everything
+ * @id The ID, which doesn't need to be NULL-terminated
+ * @length The maximum length of the ID; it ends at the first NULL or at this length
+ *
+ * @return Whether the ID should be kept
+ */
+bool owf_projection_set_match(const owf_projection_set_t *set, const char *id, size_t length);
+
+#endif /* OWF_PROJECTION_H */
@@ -64,6 +64,11 @@ typedef struct owf_reader owf_reader_t;
 /* A read callback. Takes a destination, a size, and a data pointer. */
 typedef bool (*owf_read_cb_t)(void *, const size_t, void *);
 
+/* A seek callback. Takes a number of bytes to skip forward and a data pointer.
+ * Returns false if the source can't seek, in which case the bytes are read and discarded instead.
+ */
+typedef bool (*owf_seek_cb_t)(const size_t, void *);
+
 /* A visit callback. Takes a reader, a reader context, the type we're reading, and a data pointer. */
 typedef bool (*owf_visit_cb_t)(owf_reader_t *, owf_reader_ctx_t *, owf_reader_cb_type_t, void *);
 
@@ -81,6 +86,9 @@ struct owf_reader {
     /* The read callback */
     owf_read_cb_t read;
 
+    /* The seek callback, or NULL if the source can only be read */
+    owf_seek_cb_t seek;
+
     /* The visit callback */
     owf_visit_cb_t visit;
 
@@ -2,6 +2,9 @@
 #include <owf/types.h>
 #include <owf/arith.h>
 #include <owf/reader.h>
+#include <owf/platform.h>
+#include <owf/projection.h>
+#include <owf/intern.h>
 
 #include <stdio.h>
 
@@ -11,10 +14,184 @@
 /* The size of the skip buffer. */
 #define OWF_BINARY_READER_SKIP_BUF_SIZE 256
 
+/* The result of feeding bytes to a binary reader. */
+typedef enum owf_binary_feed_status owf_binary_feed_status_t;
+
+/* @see owf_binary_feed_status_t */
+enum owf_binary_feed_status {
+    /* An error occurred, and has been set in the reader's error context */
+    OWF_BINARY_FEED_ERROR,
+
+    /* All input was consumed and the package isn't finished yet */
+    OWF_BINARY_FEED_MORE,
+
+    /* A whole package was read; input after it was not consumed */
+    OWF_BINARY_FEED_DONE
+};
+
+/* Where an incremental binary reader is in the package. */
+typedef enum owf_binary_feed_state owf_binary_feed_state_t;
+
+/* @see owf_binary_feed_state_t */
+enum owf_binary_feed_state {
+    /* Waiting for the magic and package length */
+    OWF_BINARY_FEED_PACKAGE,
+
+    /* Waiting for a channel length */
+    OWF_BINARY_FEED_CHANNEL,
+
+    /* Waiting for the length of a channel ID */
+    OWF_BINARY_FEED_CHANNEL_ID_LENGTH,
+
+    /* Waiting for a channel ID */
+    OWF_BINARY_FEED_CHANNEL_ID,
+
+    /* Waiting for the length of a namespace */
+    OWF_BINARY_FEED_NAMESPACE_LENGTH,
+
+    /* Waiting for a whole namespace */
+    OWF_BINARY_FEED_NAMESPACE,
+
+    /* Discarding the rest of a skipped channel */
+    OWF_BINARY_FEED_SKIP,
+
+    /* A previous feed failed */
+    OWF_BINARY_FEED_FAILED
+};
+
+/* State for an incremental binary reader.
+ *
+ * Channel headers are read as they arrive. Namespaces are the unit of decoding: each one is
+ * gathered into a scratch buffer (or decoded in place if it arrives in one piece), then read
+ * with the ordinary buffer reader.
+ */
+typedef struct owf_binary_feed owf_binary_feed_t;
+
+/* @see owf_binary_feed_t */
+struct owf_binary_feed {
+    /* The current state */
+    owf_binary_feed_state_t state;
+
+    /* The number of bytes needed to leave the current state */
+    uint32_t want;
+
+    /* Bytes left in the package and in the current channel */
+    uint32_t package_left, channel_left;
+
+    /* Scratch space for segments split across feeds */
+    owf_array_t scratch;
+};
+
+/* A file descriptor source for a binary reader. */
+typedef struct owf_binary_fd owf_binary_fd_t;
+
+/* @see owf_binary_fd_t */
+struct owf_binary_fd {
+    /* The file descriptor */
+    int fd;
+
+    /* Whether the descriptor supports positioned reads */
+    bool seekable;
+
+    /* The offset of the next read, if seekable */
+    int64_t offset;
+
+    /* The size of the file, or -1 if it isn't a regular file */
+    int64_t size;
+};
+
+/* State for a binary reader that reuses its package across packets.
+ *
+ * Nodes are overwritten in place, in the order they're read. Each one is taken out of the
+ * package into the reader's context before it's read, so its strings and arrays can be refilled
+ * without reallocating, and put back once it's visited. Nodes left over from a larger packet
+ * are destroyed once the reader moves past their parent.
+ */
+typedef struct owf_binary_reuse owf_binary_reuse_t;
+
+/* @see owf_binary_reuse_t */
+struct owf_binary_reuse {
+    /* Whether the reader reuses its package */
+    bool enabled;
+
+    /* Context nodes taken out of the package and not yet put back, as bits of (1 << <owf_reader_cb_type_t>) */
+    uint32_t open;
+
+    /* The number of nodes written so far to the package, the current channel, and the current namespace */
+    uint32_t channels, namespaces, signals, events, alarms;
+};
+
+/* What a validation pass found in a package. */
+typedef struct owf_binary_stats owf_binary_stats_t;
+
+/* @see owf_binary_stats_t */
+struct owf_binary_stats {
+    /* The number of each kind of node */
+    uint32_t channels, namespaces, signals, events, alarms;
+
+    /* The total number of samples across all signals */
+    uint64_t samples;
+
+    /* The total number of bytes in all strings, including terminators and padding */
+    uint64_t string_bytes;
+
+    /* The number of those bytes in strings short enough to be stored inline */
+    uint64_t inline_string_bytes;
+
+    /* The length of the package, including the magic and length header */
+    uint64_t length;
+};
+
+/* The regions of a block that <owf_binary_materialize_block> carves a package out of. */
+typedef enum owf_binary_block_region owf_binary_block_region_t;
+
+/* @see owf_binary_block_region_t */
+enum owf_binary_block_region {
+    /* Channels */
+    OWF_BINARY_BLOCK_CHANNELS,
+
+    /* Namespaces */
+    OWF_BINARY_BLOCK_NAMESPACES,
+
+    /* Signals */
+    OWF_BINARY_BLOCK_SIGNALS,
+
+    /* Events */
+    OWF_BINARY_BLOCK_EVENTS,
+
+    /* Alarms */
+    OWF_BINARY_BLOCK_ALARMS,
+
+    /* Samples */
+    OWF_BINARY_BLOCK_SAMPLES,
+
+    /* Strings */
+    OWF_BINARY_BLOCK_STRINGS,
+
+    /* The number of regions */
+    OWF_BINARY_BLOCK_REGIONS
+};
+
+/* Cursors into the regions of a block.
+ *
+ * Each kind of node gets its own region. Since packages are read depth-first, the children
+ * of each node are carved out one after another, so every node array is a contiguous slice
+ * of its region.
+ */
+typedef struct owf_binary_block owf_binary_block_t;
+
+/* @see owf_binary_block_t */
+struct owf_binary_block {
+    /* The next free byte and the end of each region */
+    struct {
+        uint8_t *next, *end;
+    } regions[OWF_BINARY_BLOCK_REGIONS];
+};
+
 /* A binary reader.
  *
  * Stores the <owf_reader_t> context, a skip buffer for scratch space,
- * and length markers.
+ * length markers, and the buffer being read or borrowed from, if any.
  */
 typedef struct owf_binary_reader owf_binary_reader_t;
 
@@ -28,6 +205,30 @@ struct owf_binary_reader {
 
     /* Internal segment and skip length accounting variables */
     uint32_t segment_length, skip_length;
+
+    /* The buffer being read from directly, or NULL to use the read callback */
+    owf_buffer_t *buffer;
+
+    /* The buffer that strings and samples are borrowed from, or NULL to copy them */
+    owf_buffer_t *borrow;
+
+    /* Incremental reader state */
+    owf_binary_feed_t feed;
+
+    /* The file descriptor being read from, for readers initialized with <owf_binary_reader_init_fd> */
+    owf_binary_fd_t fd;
+
+    /* The parts of the package to decode, or NULL to decode everything */
+    const owf_projection_t *projection;
+
+    /* The table IDs and units are interned in, or NULL to give each package its own copies */
+    owf_intern_t *intern;
+
+    /* The block nodes are being carved from, or NULL to allocate them separately */
+    owf_binary_block_t *block;
+
+    /* Package reuse state */
+    owf_binary_reuse_t reuse;
 };
 
 /* A callback used internally by the binary reader. */
@@ -40,6 +241,8 @@ typedef bool (*owf_binary_reader_cb_t)(owf_binary_reader_t *, void *);
  * @read The read callback
  * @visitor The visit callback
  * @data User data supplied to both the read callback and the visit callback
+ * Skipped segments are read and discarded. If the source can skip bytes more cheaply,
+ * set `binary->reader.seek` after initializing the reader.
  */
 void owf_binary_reader_init(owf_binary_reader_t *binary, owf_alloc_t *alloc, owf_error_t *error, owf_read_cb_t read, owf_visit_cb_t visitor, void *data);
 
@@ -49,18 +252,109 @@ void owf_binary_reader_init(owf_binary_reader_t *binary, owf_alloc_t *alloc, owf
  * @alloc The allocator
  * @error The error context
  * @visitor The visit callback
+ * Segments skipped by the visitor are stepped over with fseek. Streams that can't seek,
+ * like pipes, fall back to reading and discarding them.
  */
 void owf_binary_reader_init_file(owf_binary_reader_t *binary, FILE *file, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor);
 
+#if OWF_PLATFORM_IS_GNU
+/* Initializes this binary reader using a file descriptor.
+ * @binary The reader
+ * @fd The file descriptor
+ * @alloc The allocator
+ * @error The error context
+ * @visitor The visit callback
+ * Reading starts at the descriptor's current offset. Seekable descriptors are read with pread,
+ * so skipped segments cost no I/O at all and the descriptor's offset is left alone; others,
+ * like pipes and sockets, are read with read, and skipped segments are read and discarded.
+ */
+void owf_binary_reader_init_fd(owf_binary_reader_t *binary, int fd, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor);
+#endif
+
 /* Initializes this binary reader using an <owf_buffer_t>.
  * @binary The reader
  * @buf The buffer
  * @alloc The allocator
  * @error The error context
  * @visitor The visit callback
+ * Buffer readers bypass the read callback: each segment is bounds-checked against the
+ * buffer once when it is unwrapped, and fields are then copied straight out of it.
  */
 void owf_binary_reader_init_buffer(owf_binary_reader_t *binary, owf_buffer_t *buf, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor);
 
+/* Initializes this binary reader using an <owf_buffer_t>, borrowing from it instead of copying.
+ * @binary The reader
+ * @buf The buffer
+ * @alloc The allocator
+ * @error The error context
+ * @visitor The visit callback
+ * Strings and sample arrays that are read will point directly into `buf`, so `buf` must
+ * outlive everything read from it. Samples are byteswapped in place, so the buffer's contents
+ * are unspecified after reading. Sample arrays that are not suitably aligned are still copied.
+ */
+void owf_binary_reader_init_buffer_borrowed(owf_binary_reader_t *binary, owf_buffer_t *buf, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor);
+
+/* Makes a binary reader materialize every packet into the same package.
+ * @binary The reader
+ *
+ * The reader keeps the package between packets and overwrites it in place, keeping the
+ * allocations of its node arrays, strings, and samples. When packets have the same shape,
+ * materializing them allocates nothing. The package returned by <owf_binary_materialize> or
+ * finished by <owf_binary_reader_feed> is only valid until the next packet is read; free it
+ * with <owf_binary_reader_destroy> rather than <owf_package_destroy>. The reader's visitor is
+ * replaced. <owf_binary_materialize_block> and <owf_binary_materialize_parallel> start
+ * the package over instead of reusing it.
+ */
+void owf_binary_reader_reuse(owf_binary_reader_t *binary);
+
+/* Restricts a binary reader to part of each package.
+ * @binary The reader
+ * @projection The projection, which must outlive the reader, or NULL to read everything
+ * Node IDs are checked before they are copied, so skipped channels, namespaces, and signals
+ * cost no allocations. Buffer sources check IDs in place; other sources read IDs of up to
+ * <OWF_BINARY_READER_SKIP_BUF_SIZE> bytes into the skip buffer first.
+ */
+void owf_binary_reader_set_projection(owf_binary_reader_t *binary, const owf_projection_t *projection);
+
+/* Interns the IDs and signal units a binary reader decodes.
+ * @binary The reader
+ * @intern The intern table, which must outlive the reader and every package it decodes, or NULL to copy strings
+ * Decoded channel, namespace, and signal IDs and signal units point at the table's canonical
+ * copies, so repeated strings cost no allocations. Workers of <owf_binary_materialize_parallel>
+ * share the reader's table.
+ */
+void owf_binary_reader_set_intern(owf_binary_reader_t *binary, owf_intern_t *intern);
+
+/* Initializes this binary reader to be fed bytes incrementally with <owf_binary_reader_feed>.
+ * @binary The reader
+ * @alloc The allocator
+ * @error The error context
+ * @visitor The visit callback; use <owf_reader_materialize_cb> to build a package
+ * When you are finished, call <owf_binary_reader_destroy>.
+ */
+void owf_binary_reader_init_feed(owf_binary_reader_t *binary, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor);
+
+/* Feeds bytes to an incremental binary reader.
+ * @binary The reader
+ * @ptr The bytes
+ * @length The number of bytes
+ * @consumed A pointer to a size_t to store the number of bytes consumed
+ * Never blocks: input may be split anywhere, and the reader keeps its place across calls.
+ * After <OWF_BINARY_FEED_DONE>, the package is in `binary->reader.ctx.owf` if the visitor
+ * materialized one; take ownership of it before feeding the rest of the input, which starts
+ * the next package. After <OWF_BINARY_FEED_ERROR>, destroy `binary->reader.ctx.owf`, which holds
+ * whatever was read of the failed package (or nothing); the reader keeps failing until it is initialized again.
+ *
+ * @return The feed status
+ */
+owf_binary_feed_status_t owf_binary_reader_feed(owf_binary_reader_t *binary, const void *ptr, size_t length, size_t *consumed);
+
+/* Frees memory owned by a binary reader.
+ * @binary The reader
+ * Only incremental readers and readers reusing their package own memory, but this is safe to call on any binary reader.
+ */
+void owf_binary_reader_destroy(owf_binary_reader_t *binary);
+
 /* Reads the entire <owf_binary_reader_t>, invoking visitor callbacks for each node.
  * @binary The reader
  *
@@ -77,6 +371,56 @@ bool owf_binary_read(owf_binary_reader_t *binary);
  */
 owf_package_t *owf_binary_materialize(owf_binary_reader_t *binary);
 
+/* Materializes an entire OWF packet to an <owf_package_t>, decoding channels on several threads.
+ * @binary The reader, which must have been initialized with a buffer
+ * @nthreads The maximum number of threads to use, or 0 to use one per processor
+ * @allocs An allocator for each of the `nthreads` threads, or NULL to share this reader's allocator, which must then be thread-safe
+ * Channels are located with a scan of their length prefixes, split into contiguous runs of
+ * roughly equal size, and decoded by separate buffer readers. The calling thread decodes one of
+ * the runs. Channel order is preserved. Readers that aren't reading from a buffer fall back to
+ * <owf_binary_materialize>.
+ *
+ * Each allocator in `allocs` is only used by one thread at a time, so they can be
+ * <owf_pool_magazine_t>s or <owf_arena_t>s. The channels decoded by a thread come from its
+ * allocator, and the package's channel array from this reader's, so destroy the package with an
+ * allocator that can free all of them (such as the pool the magazines belong to), or reset the
+ * arenas instead. `allocs` needs a nonzero `nthreads`.
+ *
+ * @return A pointer to an <owf_package_t> if successful, NULL otherwise.
+ *         When you are finished, use owf_package_destroy to free the returned
+ *         package.
+ */
+owf_package_t *owf_binary_materialize_parallel(owf_binary_reader_t *binary, uint32_t nthreads, owf_alloc_t *const *allocs);
+
+/* Checks that an OWF packet is well-formed without materializing it.
+ * @binary The reader
+ * @stats A pointer to an <owf_binary_stats_t> to fill in, or NULL
+ *
+ * Checks everything <owf_binary_read> does (the magic, length alignment and nesting, string
+ * terminators, and that events and alarms fall inside their namespace) without calling the
+ * allocator or the visitor. The projection is ignored. The stats can be used to budget memory
+ * before decoding the package for real; they're only complete if validation succeeds.
+ *
+ * @return Whether the packet is valid
+ */
+bool owf_binary_validate(owf_binary_reader_t *binary, owf_binary_stats_t *stats);
+
+/* Materializes an entire OWF packet to an <owf_package_t> carved out of as few allocations as possible.
+ * @binary The reader, which must have been initialized with a buffer
+ *
+ * The packet is validated first, and the counts it reports size one block holding every node,
+ * string, and sample array exactly. Strings short enough to be stored inline stay out of the
+ * block. If the block would be larger than the allocator's `max_alloc`, its regions are split
+ * across a few blocks instead. Every array in the package is borrowed from the blocks, so
+ * <owf_package_destroy> frees them all at once. Readers that aren't reading from a buffer fall
+ * back to <owf_binary_materialize>.
+ *
+ * @return A pointer to an <owf_package_t> if successful, NULL otherwise.
+ *         When you are finished, use owf_package_destroy to free the returned
+ *         package.
+ */
+owf_package_t *owf_binary_materialize_block(owf_binary_reader_t *binary);
+
 /* Reads a channel from the <owf_binary_reader_t> into an <owf_channel_t>.
  * @binary The reader
  * @ptr A pointer to an <owf_channel_t>
@@ -0,0 +1,85 @@
+#include <owf.h>
+#include <owf/platform.h>
+#include <owf/error.h>
+
+#if OWF_PLATFORM_IS_GNU
+    #include <pthread.h>
+#endif
+
+#ifndef OWF_THREAD_H
+#define OWF_THREAD_H
+
+/* A thread entry point. Takes the data pointer passed to <owf_thread_create>. */
+typedef void (*owf_thread_cb_t)(void *);
+
+/* The platform's native thread handle. */
+#if OWF_PLATFORM_IS_GNU
+    typedef pthread_t owf_thread_handle_t;
+#elif OWF_PLATFORM == OWF_PLATFORM_WINDOWS
+    typedef HANDLE owf_thread_handle_t;
+#endif
+
+/* The platform's native mutex. */
+#if OWF_PLATFORM_IS_GNU
+    typedef pthread_mutex_t owf_mutex_t;
+#elif OWF_PLATFORM == OWF_PLATFORM_WINDOWS
+    typedef CRITICAL_SECTION owf_mutex_t;
+#endif
+
+/* A thin wrapper around native threads. */
+typedef struct owf_thread owf_thread_t;
+
+/* @see owf_thread_t */
+struct owf_thread {
+    /* The native handle */
+    owf_thread_handle_t handle;
+
+    /* The entry point */
+    owf_thread_cb_t cb;
+
+    /* Data passed to the entry point */
+    void *data;
+};
+
+/* Starts a thread.
+ * @thread The thread, which must stay at the same address until it is joined
+ * @error The error context
+ * @cb The entry point
+ * @data Data passed to the entry point
+ *
+ * @return Whether the thread was started
+ */
+bool owf_thread_create(owf_thread_t *thread, owf_error_t *error, owf_thread_cb_t cb, void *data);
+
+/* Waits for a thread started with <owf_thread_create> to finish.
+ * @thread The thread
+ */
+void owf_thread_join(owf_thread_t *thread);
+
+/* Returns the number of processors available to run threads on.
+ *
+ * @return The processor count, which is at least 1
+ */
+uint32_t owf_thread_count(void);
+
+/* Initializes a mutex.
+ * @mutex The mutex, which must stay at the same address until it is destroyed
+ */
+void owf_mutex_init(owf_mutex_t *mutex);
+
+/* Locks a mutex, waiting for it if another thread holds it.
+ * @mutex The mutex
+ */
+void owf_mutex_lock(owf_mutex_t *mutex);
+
+/* Unlocks a mutex held by this thread.
+ * @mutex The mutex
+ */
+void owf_mutex_unlock(owf_mutex_t *mutex);
+
+/* Destroys an unlocked mutex.
+ * @mutex The mutex
+ */
+void owf_mutex_destroy(owf_mutex_t *mutex);
+
+#endif /* OWF_THREAD_H */
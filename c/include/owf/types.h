@@ -35,6 +35,8 @@ typedef struct owf_memoize owf_memoize_t;
 /* An OWF array.
  *
  * Contains a pointer, number of elements, and total capacity.
+ * An array with a non-NULL pointer and a capacity of zero is borrowed: it points
+ * into memory owned by someone else, and is never freed by libowf.
  */
 typedef struct owf_array owf_array_t;
 
@@ -83,6 +85,15 @@ typedef struct owf_event owf_event_t;
  */
 typedef struct owf_alarm owf_alarm_t;
 
+/* A path from an OWF package down to one of its namespaces.
+ *
+ * Nodes don't point back at their parents, so pushing onto a node only keeps that node's
+ * memoized size up to date. Pushing through a path also adjusts the memoized sizes of every
+ * node above it on the path by the same amount, so a package that keeps accumulating samples
+ * can be sized in constant time before every write.
+ */
+typedef struct owf_path owf_path_t;
+
 /* @see owf_double_union_t */
 union owf_double_union {
     /* The double value */
@@ -144,6 +155,15 @@ uint32_t owf_memoize_fetch(owf_memoize_t *memoize);
  */
 uint32_t owf_memoize_cache(owf_memoize_t *memoize, uint32_t value);
 
+/* Adjusts the value in the provided <owf_memoize_t> after part of what it measures changed size.
+ * @memoize The <owf_memoize_t>
+ * @before The old size of the part
+ * @after The new size of the part
+ * Stale values stay stale. A value that would no longer fit goes stale, so that the next
+ * full calculation reports the overflow.
+ */
+void owf_memoize_adjust(owf_memoize_t *memoize, uint32_t before, uint32_t after);
+
 /* @see owf_array_t */
 struct owf_array {
     /* The pointer to the first element */
@@ -162,6 +182,15 @@ struct owf_array {
  */
 void owf_array_init(owf_array_t *arr);
 
+/* Points this <owf_array_t> at memory owned by the caller.
+ * @arr The array
+ * @ptr The borrowed memory
+ * @length The number of elements at `ptr`
+ * Borrowed arrays are not freed by <owf_array_destroy>, and are copied to the heap
+ * the first time they need to grow.
+ */
+void owf_array_borrow(owf_array_t *arr, void *ptr, uint32_t length);
+
 /* Destroys this <owf_array_t>.
  * @arr The array
  * @alloc The allocator
@@ -296,13 +325,36 @@ void *owf_array_ptr_for(owf_array_t *arr, owf_error_t *error, uint32_t idx, uint
  */
 #define OWF_ARRAY_LEN(_arr) ((&(_arr))->length)
 
+/* Returns whether an array is borrowed.
+ * @_arr The array
+ */
+#define OWF_ARRAY_BORROWED(_arr) ((&(_arr))->ptr != NULL && (&(_arr))->capacity == 0)
+
+/* The number of bytes, including the null terminator, that an <owf_str_t> can store without allocating.
+ * They overlay the byte array's pointer and length, so this is 12 on 64-bit platforms and 8 on 32-bit ones.
+ */
+#define OWF_STR_INLINE_SIZE (sizeof(owf_array_t) - sizeof(uint32_t))
+
+/* The value in place of the byte array's capacity that marks an <owf_str_t> as stored inline.
+ * <owf_str_reserve> never allocates this many bytes.
+ */
+#define OWF_STR_INLINE_TAG UINT32_MAX
+
 /* @see owf_str_t */
 struct owf_str {
     /* Memoization for the string's size and the total size in bytes */
     owf_memoize_t string_size, total_size;
 
-    /* The byte array */
-    owf_array_t bytes;
+    union {
+        /* The byte array, unless the string is stored inline */
+        owf_array_t bytes;
+
+        /* Storage for short strings. `tag` sits where the array's capacity would, and is <OWF_STR_INLINE_TAG>. */
+        struct {
+            char bytes[OWF_STR_INLINE_SIZE];
+            uint32_t tag;
+        } small;
+    };
 };
 
 /* Initializes a string to be empty.
@@ -317,17 +369,19 @@ void owf_str_init(owf_str_t *str);
  * @error The error context
  * @value The value to copy
  * If `str` is longer than 0 bytes, the null-terminated value will be copied into `str`.
- * Otherwise, no heap allocations will be made.
+ * Values that fit in <OWF_STR_INLINE_SIZE> bytes are stored inline, and empty values aren't stored at all,
+ * so neither makes any heap allocations.
  *
  * @return True if the operation was successful
  */
 bool owf_str_set(owf_str_t *str, owf_alloc_t *alloc, owf_error_t *error, const char *value);
 
-/* Reserves `length` bytes for a string.
+/* Reserves `length` bytes for a string on the heap.
  * @str The string
  * @alloc The allocator
  * @error The error context
  * @length The length to reserve
+ * Anything stored inline is discarded.
  *
  * @return True if the operation was successful
  */
@@ -356,6 +410,22 @@ int owf_str_binary_compare(owf_str_t *lhs, owf_str_t *rhs);
  */
 uint32_t owf_str_length(owf_str_t *str);
 
+/* Returns a pointer to the underlying NULL-terminated string of an <owf_str_t>.
+ * @str The string
+ * Use <OWF_STR_PTR> instead. Defined here so ID comparisons and lookups don't pay for a call.
+ *
+ * @return The string, which is only valid until the <owf_str_t> moves or changes, or NULL if it's empty
+ */
+static inline const char *owf_str_ptr(const owf_str_t *str) {
+    if (str->small.tag == OWF_STR_INLINE_TAG) {
+        return str->small.bytes;
+    } else if (str->bytes.length == 0) {
+        /* Reused strings keep their old bytes around */
+        return NULL;
+    }
+    return (const char *)str->bytes.ptr;
+}
+
 /* Computes the total size in bytes of an <owf_str_t>.
  * @str The string
  * @error The error context
@@ -365,8 +435,13 @@ uint32_t owf_str_length(owf_str_t *str);
  */
 bool owf_str_size(owf_str_t *str, owf_error_t *error, uint32_t *output_size);
 
+/* Returns whether a string is stored inline.
+ * @_str The string
+ */
+#define OWF_STR_INLINE(_str) ((&(_str))->small.tag == OWF_STR_INLINE_TAG)
+
 /* Returns a pointer to the underlying NULL-terminated string. */
-#define OWF_STR_PTR(_str) ((const char *)((&(_str))->bytes.ptr))
+#define OWF_STR_PTR(_str) owf_str_ptr(&(_str))
 
 /* @see owf_package_t */
 struct owf_package {
@@ -375,6 +450,11 @@ struct owf_package {
 
     /* An array of channels */
     owf_array_t channels;
+
+    /* A chain of blocks the package's nodes were carved from, or NULL if each node was allocated separately.
+     * Each block starts with a pointer to the next one.
+     */
+    void *blocks;
 };
 
 /* Initializes an <owf_package_t>.
@@ -382,7 +462,15 @@ struct owf_package {
  */
 void owf_package_init(owf_package_t *owf);
 
-/* Destroys an <owf_package_t> recursively.
+/* Resets an <owf_package_t> so that it can be overwritten in place.
+ * @owf The <owf_package_t> to reset
+ *
+ * Nothing is freed: the package keeps its nodes and everything they've allocated, and only
+ * forgets its memoized size. Readers reusing a package call this before each packet.
+ */
+void owf_package_reset(owf_package_t *owf);
+
+/* Destroys an <owf_package_t> recursively, and frees any blocks it was carved from.
  * @owf The <owf_package_t> to destroy
  * @alloc The allocator
  */
@@ -739,6 +827,10 @@ bool owf_signal_set_unit(owf_signal_t *signal, owf_alloc_t *alloc, owf_error_t *
  * @error The error context
  * @samples The sample array
  * @count The number of samples to push
+ * The signal's memoized size grows with it, but the nodes above it are left alone;
+ * use <owf_path_push_samples> to keep them current as well.
+ *
+ * @return True if the operation was successful
  */
 bool owf_signal_push_samples(owf_signal_t *signal, owf_alloc_t *alloc, owf_error_t *error, const double *samples, uint32_t count);
 
@@ -894,4 +986,77 @@ int owf_alarm_compare(owf_alarm_t *lhs, owf_alarm_t *rhs);
  */
 bool owf_alarm_size(owf_alarm_t *alarm, owf_error_t *error, uint32_t *output_size);
 
+/* @see owf_path_t */
+struct owf_path {
+    /* The package, or NULL */
+    owf_package_t *owf;
+
+    /* The channel in the package, or NULL */
+    owf_channel_t *channel;
+
+    /* The namespace in the channel, or NULL */
+    owf_namespace_t *ns;
+};
+
+/* Initializes an <owf_path_t>.
+ * @path The path
+ * @owf The package, or NULL
+ * @channel The channel in the package, or NULL
+ * @ns The namespace in the channel, or NULL
+ * Nodes left NULL aren't adjusted, and neither is anything above them.
+ */
+void owf_path_init(owf_path_t *path, owf_package_t *owf, owf_channel_t *channel, owf_namespace_t *ns);
+
+/* Pushes a namespace onto the channel at the end of an <owf_path_t>.
+ * @path The path, which must have a channel
+ * @alloc The allocator
+ * @error The error context
+ * @ns The namespace
+ *
+ * @return True if the operation was successful
+ */
+bool owf_path_push_namespace(owf_path_t *path, owf_alloc_t *alloc, owf_error_t *error, owf_namespace_t *ns);
+
+/* Pushes a signal onto the namespace at the end of an <owf_path_t>.
+ * @path The path, which must have a namespace
+ * @alloc The allocator
+ * @error The error context
+ * @signal The signal
+ *
+ * @return True if the operation was successful
+ */
+bool owf_path_push_signal(owf_path_t *path, owf_alloc_t *alloc, owf_error_t *error, owf_signal_t *signal);
+
+/* Pushes an event onto the namespace at the end of an <owf_path_t>.
+ * @path The path, which must have a namespace
+ * @alloc The allocator
+ * @error The error context
+ * @event The event
+ *
+ * @return True if the operation was successful
+ */
+bool owf_path_push_event(owf_path_t *path, owf_alloc_t *alloc, owf_error_t *error, owf_event_t *event);
+
+/* Pushes an alarm onto the namespace at the end of an <owf_path_t>.
+ * @path The path, which must have a namespace
+ * @alloc The allocator
+ * @error The error context
+ * @alarm The alarm
+ *
+ * @return True if the operation was successful
+ */
+bool owf_path_push_alarm(owf_path_t *path, owf_alloc_t *alloc, owf_error_t *error, owf_alarm_t *alarm);
+
+/* Appends samples to a signal in the namespace at the end of an <owf_path_t>.
+ * @path The path, which must have a namespace
+ * @signal The signal, which must be in the namespace
+ * @alloc The allocator
+ * @error The error context
+ * @samples The sample array
+ * @count The number of samples to push
+ *
+ * @return True if the operation was successful
+ */
+bool owf_path_push_samples(owf_path_t *path, owf_signal_t *signal, owf_alloc_t *alloc, owf_error_t *error, const double *samples, uint32_t count);
+
 #endif /* OWF_TYPES_H */
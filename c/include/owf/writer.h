@@ -18,6 +18,12 @@ typedef struct owf_writer owf_writer_t;
 /* A write callback. Takes a pointer, the size of the buffer, and user data. */
 typedef bool (*owf_write_cb_t)(const void *, const size_t, void *);
 
+/* A patch callback, for overwriting bytes that were already written.
+ * Takes a pointer, the size of the buffer, how many bytes before the end of the output to write it at, and user data.
+ * Afterwards, writes must continue at the end of the output.
+ */
+typedef bool (*owf_patch_cb_t)(const void *, const size_t, const size_t, void *);
+
 /* @see owf_writer_t */
 struct owf_writer {
     /* Error status */
@@ -29,6 +35,9 @@ struct owf_writer {
     /* Callbacks */
     owf_write_cb_t write;
 
+    /* The patch callback, or NULL if the target can't be overwritten */
+    owf_patch_cb_t patch;
+
     /* User data */
     void *data;
 };
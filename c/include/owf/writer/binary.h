@@ -2,6 +2,9 @@
 #include <owf/types.h>
 #include <owf/arith.h>
 #include <owf/writer.h>
+#include <owf/writer/iovec.h>
+#include <owf/writer/buffered.h>
+#include <owf/writer/growable.h>
 
 #include <stdio.h>
 
@@ -9,11 +12,72 @@
 #define OWF_BINARY_WRITER_H
 
 /* The size of the lookaside buffer for byteswaps. */
-#define OWF_BINARY_WRITER_BYTESWAP_BUFFER_LEN 32
+#define OWF_BINARY_WRITER_BYTESWAP_BUFFER_LEN 512
+
+/* How deep a streamed package is. */
+typedef enum owf_binary_stream_depth owf_binary_stream_depth_t;
+
+/* @see owf_binary_stream_depth_t */
+enum owf_binary_stream_depth {
+    /* Not streaming a package */
+    OWF_BINARY_STREAM_NONE = 0,
+
+    /* Inside a package */
+    OWF_BINARY_STREAM_PACKAGE,
+
+    /* Inside a channel */
+    OWF_BINARY_STREAM_CHANNEL,
+
+    /* Inside a namespace */
+    OWF_BINARY_STREAM_NAMESPACE,
+
+    /* Inside a signal's samples */
+    OWF_BINARY_STREAM_SIGNAL,
+
+    /* The number of depths */
+    OWF_BINARY_STREAM_DEPTHS
+};
+
+/* Which of a streamed namespace's arrays is open. Arrays are written in this order. */
+typedef enum owf_binary_stream_section owf_binary_stream_section_t;
+
+/* @see owf_binary_stream_section_t */
+enum owf_binary_stream_section {
+    /* Nothing has been written yet */
+    OWF_BINARY_STREAM_HEADER = 0,
+
+    /* Signals */
+    OWF_BINARY_STREAM_SIGNALS,
+
+    /* Events */
+    OWF_BINARY_STREAM_EVENTS,
+
+    /* Alarms */
+    OWF_BINARY_STREAM_ALARMS
+};
+
+/* The state of a package being streamed with <owf_binary_writer_begin_package> and friends. */
+typedef struct owf_binary_stream owf_binary_stream_t;
+
+/* @see owf_binary_stream_t */
+struct owf_binary_stream {
+    /* The current <owf_binary_stream_depth_t> */
+    uint8_t depth;
+
+    /* The open <owf_binary_stream_section_t> of the current namespace */
+    uint8_t section;
+
+    /* The positions of the open length prefixes, by depth; the namespace's array prefix is at depth 0 */
+    size_t slots[OWF_BINARY_STREAM_DEPTHS];
+
+    /* The current namespace's start time and duration, for checking events and alarms */
+    owf_time_t t0;
+    owf_duration_t dt;
+};
 
 /* A binary writer.
  *
- * Just stores the <owf_writer_t> context for now.
+ * Stores the <owf_writer_t> context, and the buffer being written to, if any.
  */
 typedef struct owf_binary_writer owf_binary_writer_t;
 
@@ -21,6 +85,21 @@ typedef struct owf_binary_writer owf_binary_writer_t;
 struct owf_binary_writer {
     /* The writer */
     owf_writer_t writer;
+
+    /* The buffer being written to directly, or NULL to use the write callback */
+    owf_buffer_t *buffer;
+
+    /* The growable buffer that owns `buffer`, or NULL if it can't grow */
+    owf_growable_t *growable;
+
+    /* The scatter-gather list being built, or NULL */
+    owf_iovec_t *iovec;
+
+    /* The number of bytes written so far */
+    size_t position;
+
+    /* The package being streamed */
+    owf_binary_stream_t stream;
 };
 
 /* A callback used internally by the binary writer. */
@@ -40,6 +119,8 @@ void owf_binary_writer_init(owf_binary_writer_t *binary, owf_alloc_t *alloc, owf
  * @file The file handle
  * @alloc The allocator
  * @error The error context
+ * Lengths are computed up front rather than back-patched: every seek flushes the stdio buffer, so
+ * patching a file is much slower than the size pass, and doesn't work at all in append mode.
  */
 void owf_binary_writer_init_file(owf_binary_writer_t *binary, FILE *file, owf_alloc_t *alloc, owf_error_t *error);
 
@@ -51,6 +132,35 @@ void owf_binary_writer_init_file(owf_binary_writer_t *binary, FILE *file, owf_al
  */
 void owf_binary_writer_init_buffer(owf_binary_writer_t *binary, owf_buffer_t *buf, owf_alloc_t *alloc, owf_error_t *error);
 
+/* Initializes this binary writer using an <owf_growable_t>.
+ * @binary The writer
+ * @growable The growable buffer, which is appended to
+ * @alloc The allocator
+ * @error The error context
+ * The buffer grows as needed, so packages can be written without being sized first.
+ */
+void owf_binary_writer_init_growable(owf_binary_writer_t *binary, owf_growable_t *growable, owf_alloc_t *alloc, owf_error_t *error);
+
+/* Initializes this binary writer to write through an <owf_buffered_t>.
+ * @binary The writer
+ * @buffered The buffered writer
+ * @alloc The allocator
+ * @error The error context
+ * Lengths are back-patched if the buffered writer's target can be patched. Call <owf_buffered_flush>
+ * once the package has been written.
+ */
+void owf_binary_writer_init_buffered(owf_binary_writer_t *binary, owf_buffered_t *buffered, owf_alloc_t *alloc, owf_error_t *error);
+
+/* Initializes this binary writer to build an <owf_iovec_t>.
+ * @binary The writer
+ * @iovec The list, which should be initialized and empty
+ * @alloc The allocator
+ * @error The error context
+ * Headers are packed into the list's scratch area, while long strings and sample arrays are referenced
+ * in place, so the package must outlive the list. Lengths are back-patched.
+ */
+void owf_binary_writer_init_iovec(owf_binary_writer_t *binary, owf_iovec_t *iovec, owf_alloc_t *alloc, owf_error_t *error);
+
 /* Writes the header for an <owf_package_t> to an <owf_binary_writer_t>.
  * @binary The binary writer
  * @owf The package
@@ -63,6 +173,9 @@ bool owf_binary_write_header(owf_binary_writer_t *binary, owf_package_t *owf, ui
 /* Writes an <owf_package_t> to an <owf_binary_writer_t>.
  * @binary The binary writer
  * @owf The package
+ * If the target can be patched (buffers, growable buffers, and scatter-gather lists), the tree is walked once: each length
+ * prefix is written as a placeholder and patched once its contents have been written. Otherwise,
+ * sizes are computed before anything is written.
  *
  * @return True if the write was successful, false otherwise
  */
@@ -74,12 +187,27 @@ bool owf_binary_write(owf_binary_writer_t *binary, owf_package_t *owf);
  * @buf The buffer to write to
  * @alloc The allocator
  * @error The error context
- * When you are done with the buffer, call owf_free on buf->ptr.
+ * When you are done with the buffer, call owf_free on buf->ptr. To reuse one buffer for
+ * many packages instead, write them with <owf_binary_writer_init_growable>.
  *
  * @return True if the write was successful, false otherwise
  */
 bool owf_binary_write_buffer(owf_binary_writer_t *binary, owf_package_t *owf, owf_buffer_t *buf, owf_alloc_t *alloc, owf_error_t *error);
 
+/* Writes an <owf_package_t> to an <owf_binary_writer_t>, encoding channels on several threads.
+ * @binary The binary writer, which must have been initialized with a buffer or growable buffer
+ * @owf The package
+ * @nthreads The maximum number of threads to use, or 0 to use one per processor
+ * Every subtree size is computed (and memoized) up front, which fixes where each channel will land.
+ * Channels are then split into contiguous runs of roughly equal size and encoded straight into their
+ * own disjoint parts of the buffer by separate writers. The calling thread encodes one of the runs.
+ * The package must not be modified while it is being written. Writers that aren't writing to a buffer
+ * fall back to <owf_binary_write>.
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_write_parallel(owf_binary_writer_t *binary, owf_package_t *owf, uint32_t nthreads);
+
 /* Writes the header for an <owf_channel_t> to an <owf_binary_writer_t>.
  * @binary The binary writer
  * @channel The channel
@@ -174,6 +302,102 @@ bool owf_binary_writer_write_alarm_header(owf_binary_writer_t *binary, owf_names
  */
 bool owf_binary_writer_write_alarm(owf_binary_writer_t *binary, owf_namespace_t *ns, owf_alarm_t *alarm);
 
+/* Starts streaming a package to an <owf_binary_writer_t>, without building an <owf_package_t>.
+ * @binary The binary writer, whose target must support patching
+ * Packages are streamed by nesting begin and end calls: channels go in packages, namespaces in channels,
+ * and signals, events, and alarms in namespaces, in that order. Each length prefix is reserved when its
+ * segment begins and back-patched when it ends.
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_begin_package(owf_binary_writer_t *binary);
+
+/* Finishes streaming a package.
+ * @binary The binary writer
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_end_package(owf_binary_writer_t *binary);
+
+/* Starts streaming a channel.
+ * @binary The binary writer
+ * @id The channel ID
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_begin_channel(owf_binary_writer_t *binary, const char *id);
+
+/* Finishes streaming a channel.
+ * @binary The binary writer
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_end_channel(owf_binary_writer_t *binary);
+
+/* Starts streaming a namespace.
+ * @binary The binary writer
+ * @t0 The start time
+ * @dt The duration
+ * @id The namespace ID
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_begin_namespace(owf_binary_writer_t *binary, owf_time_t t0, owf_duration_t dt, const char *id);
+
+/* Finishes streaming a namespace, writing any of its arrays that are still empty.
+ * @binary The binary writer
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_end_namespace(owf_binary_writer_t *binary);
+
+/* Starts streaming a signal. Follow this with any number of <owf_binary_writer_append_samples> calls.
+ * @binary The binary writer
+ * @id The signal ID
+ * @unit The signal's unit
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_begin_signal(owf_binary_writer_t *binary, const char *id, const char *unit);
+
+/* Streams samples into the current signal.
+ * @binary The binary writer
+ * @ptr A pointer to samples
+ * @count The number of samples
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_append_samples(owf_binary_writer_t *binary, const double *ptr, uint32_t count);
+
+/* Finishes streaming a signal.
+ * @binary The binary writer
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_end_signal(owf_binary_writer_t *binary);
+
+/* Streams an event into the current namespace.
+ * @binary The binary writer
+ * @t0 The event's time, which the namespace must cover
+ * @message The message
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_append_event(owf_binary_writer_t *binary, owf_time_t t0, const char *message);
+
+/* Streams an alarm into the current namespace.
+ * @binary The binary writer
+ * @t0 The alarm's start time, which the namespace must cover
+ * @dt The alarm's duration
+ * @level The level
+ * @volume The volume
+ * @type The type
+ * @message The message
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_append_alarm(owf_binary_writer_t *binary, owf_time_t t0, owf_duration_t dt, uint8_t level, uint8_t volume, const char *type, const char *message);
+
 /* Writes samples to the <owf_binary_writer_t>.
  * @binary The writer
  * @ptr A pointer to samples
@@ -191,6 +415,24 @@ bool owf_binary_writer_write_samples(owf_binary_writer_t *binary, const double *
  */
 bool owf_binary_writer_write_str(owf_binary_writer_t *binary, owf_str_t *str);
 
+/* Writes a NULL-terminated string to the <owf_binary_writer_t>.
+ * @binary The writer
+ * @str The string
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_write_cstr(owf_binary_writer_t *binary, const char *str);
+
+/* Writes bytes that are already encoded to the <owf_binary_writer_t>, as they are.
+ * @binary The writer
+ * @ptr The bytes
+ * @size The number of bytes, which should keep the output 4-byte aligned
+ * Scatter-gather lists reference long runs of bytes instead of copying them.
+ *
+ * @return True if the write was successful, false otherwise
+ */
+bool owf_binary_writer_write_bytes(owf_binary_writer_t *binary, const void *ptr, size_t size);
+
 /* Writes a double to the <owf_binary_writer_t>.
  * @binary The writer
  * @val The double to write
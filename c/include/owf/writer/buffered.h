@@ -0,0 +1,107 @@
+#include <owf.h>
+#include <owf/types.h>
+#include <owf/error.h>
+#include <owf/alloc.h>
+#include <owf/writer.h>
+
+#ifndef OWF_BUFFERED_H
+#define OWF_BUFFERED_H
+
+/* The default block size for an <owf_buffered_t>. */
+#define OWF_BUFFERED_DEFAULT_BLOCK_SIZE 65536
+
+/* A buffered write layer.
+ *
+ * Sits in front of a write callback and coalesces small writes into blocks, so writing a package
+ * to a socket or file costs a few large writes instead of one per field. Writes at least as large
+ * as a block skip the buffer entirely.
+ *
+ * Once `high` bytes are buffered, the buffer is drained until at most `low` bytes remain. Nothing
+ * is written otherwise until the buffer is full or <owf_buffered_flush> is called.
+ */
+typedef struct owf_buffered owf_buffered_t;
+
+/* @see owf_buffered_t */
+struct owf_buffered {
+    /* The allocator */
+    owf_alloc_t *alloc;
+
+    /* The error context */
+    owf_error_t *error;
+
+    /* The downstream write callback */
+    owf_write_cb_t write;
+
+    /* The downstream patch callback, or NULL */
+    owf_patch_cb_t patch;
+
+    /* User data supplied to the downstream callbacks */
+    void *data;
+
+    /* The buffer, allocated on the first write */
+    uint8_t *ptr;
+
+    /* The number of bytes buffered */
+    size_t length;
+
+    /* The size of the buffer */
+    size_t block_size;
+
+    /* The low and high watermarks */
+    size_t low, high;
+};
+
+/* Initializes an <owf_buffered_t>.
+ * @buffered The buffered writer
+ * @alloc The allocator
+ * @error The error context
+ * @write The downstream write callback
+ * @patch The downstream patch callback, or NULL if the target can't be patched
+ * @data User data supplied to the downstream callbacks
+ * @block_size The size of the buffer, or 0 for <OWF_BUFFERED_DEFAULT_BLOCK_SIZE>
+ * Both watermarks start at the block size, so the buffer is only written out when it fills up.
+ */
+void owf_buffered_init(owf_buffered_t *buffered, owf_alloc_t *alloc, owf_error_t *error, owf_write_cb_t write, owf_patch_cb_t patch, void *data, size_t block_size);
+
+/* Sets the watermarks of an <owf_buffered_t>.
+ * @buffered The buffered writer
+ * @low The number of bytes that may stay buffered after draining
+ * @high The number of buffered bytes that triggers a drain
+ *
+ * @return True if successful, false if the watermarks weren't ordered as low <= high <= block size
+ */
+bool owf_buffered_set_watermarks(owf_buffered_t *buffered, size_t low, size_t high);
+
+/* Writes bytes through an <owf_buffered_t>.
+ * @buffered The buffered writer
+ * @src The bytes
+ * @size The number of bytes
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_buffered_write(owf_buffered_t *buffered, const void *src, size_t size);
+
+/* Overwrites bytes already written through an <owf_buffered_t>.
+ * @buffered The buffered writer
+ * @src The bytes
+ * @size The number of bytes
+ * @distance How many bytes before the end of the output to write them at
+ * Bytes still in the buffer are patched in memory. Older bytes are flushed and patched downstream.
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_buffered_patch(owf_buffered_t *buffered, const void *src, size_t size, size_t distance);
+
+/* Writes out everything buffered in an <owf_buffered_t>.
+ * @buffered The buffered writer
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_buffered_flush(owf_buffered_t *buffered);
+
+/* Destroys an <owf_buffered_t>, discarding anything that wasn't flushed.
+ * @buffered The buffered writer
+ */
+void owf_buffered_destroy(owf_buffered_t *buffered);
+
+#endif /* OWF_BUFFERED_H */
@@ -0,0 +1,77 @@
+#include <owf.h>
+#include <owf/types.h>
+#include <owf/error.h>
+#include <owf/alloc.h>
+
+#ifndef OWF_GROWABLE_H
+#define OWF_GROWABLE_H
+
+/* The smallest capacity an <owf_growable_t> grows to. */
+#define OWF_GROWABLE_MIN_CAPACITY 4096
+
+/* A growable output buffer.
+ *
+ * Grows as it's written to, so a package can be written into memory without being sized first.
+ * Growth is geometric unless a chunk size is given, in which case the capacity is always a multiple
+ * of it. Clearing keeps the capacity, so a writer that reuses one buffer for every packet stops
+ * allocating once it has seen its largest packet.
+ */
+typedef struct owf_growable owf_growable_t;
+
+/* @see owf_growable_t */
+struct owf_growable {
+    /* The allocator */
+    owf_alloc_t *alloc;
+
+    /* The error context */
+    owf_error_t *error;
+
+    /* The bytes. The length is the capacity, and the position is the number of bytes written. */
+    owf_buffer_t buffer;
+
+    /* The unit of growth, or 0 to grow geometrically */
+    size_t chunk_size;
+};
+
+/* Initializes an empty <owf_growable_t>. Nothing is allocated until the first write.
+ * @growable The buffer
+ * @alloc The allocator
+ * @error The error context
+ * @chunk_size The unit of growth, or 0 to grow geometrically
+ */
+void owf_growable_init(owf_growable_t *growable, owf_alloc_t *alloc, owf_error_t *error, size_t chunk_size);
+
+/* Makes sure an <owf_growable_t> has room for some more bytes.
+ * @growable The buffer
+ * @size The number of bytes
+ *
+ * @return True if successful, false if the buffer couldn't grow
+ */
+bool owf_growable_reserve(owf_growable_t *growable, size_t size);
+
+/* Appends bytes to an <owf_growable_t>, growing it if needed.
+ * @growable The buffer
+ * @src The bytes
+ * @size The number of bytes
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_growable_write(owf_growable_t *growable, const void *src, size_t size);
+
+/* Empties an <owf_growable_t>, keeping its capacity for the next write.
+ * @growable The buffer
+ */
+void owf_growable_clear(owf_growable_t *growable);
+
+/* Hands the bytes in an <owf_growable_t> over to the caller, leaving it empty.
+ * @growable The buffer
+ * @buf The buffer to take the bytes; call owf_free on buf->ptr when done
+ */
+void owf_growable_take(owf_growable_t *growable, owf_buffer_t *buf);
+
+/* Destroys an <owf_growable_t>.
+ * @growable The buffer
+ */
+void owf_growable_destroy(owf_growable_t *growable);
+
+#endif /* OWF_GROWABLE_H */
@@ -0,0 +1,175 @@
+#include <owf.h>
+#include <owf/platform.h>
+#include <owf/types.h>
+#include <owf/error.h>
+#include <owf/alloc.h>
+#include <owf/writer.h>
+
+#ifndef OWF_IOVEC_H
+#define OWF_IOVEC_H
+
+/* The default minimum size of a payload that is referenced rather than copied. */
+#define OWF_IOVEC_DEFAULT_THRESHOLD 256
+
+/* The number of segments handed to the kernel per writev or sendmsg call. */
+#define OWF_IOVEC_BATCH_LEN 64
+
+/* Flags that change how an <owf_iovec_t> handles payloads. */
+typedef enum owf_iovec_flags owf_iovec_flags_t;
+
+/* @see owf_iovec_flags_t */
+enum owf_iovec_flags {
+    /* Byteswap large sample arrays in place and reference them, instead of swapping them into scratch.
+     * The samples are in network byte order until <owf_iovec_clear> or <owf_iovec_destroy> swaps them back,
+     * so the package must not be read or written by anything else in the meantime, nor written to the
+     * same list twice.
+     */
+    OWF_IOVEC_SWAP_IN_PLACE = 1 << 0
+};
+
+/* One contiguous run of output in an <owf_iovec_t>. */
+typedef struct owf_iovec_segment owf_iovec_segment_t;
+
+/* @see owf_iovec_segment_t */
+struct owf_iovec_segment {
+    /* The referenced memory, or NULL if this segment lives in scratch */
+    const void *ptr;
+
+    /* The offset into scratch, if `ptr` is NULL */
+    uint32_t offset;
+
+    /* The number of bytes in this segment */
+    uint32_t length;
+
+    /* The offset of this segment in the output */
+    size_t position;
+
+    /* Whether `ptr` points at samples that were byteswapped in place */
+    bool swapped;
+};
+
+/* A scatter-gather list of output.
+ *
+ * Small writes, like headers and length prefixes, are packed into a scratch area. Large strings
+ * and sample arrays are referenced where they are, so they are never copied, and the list can be
+ * written out with a handful of writev or sendmsg calls. The same list can be flushed any number of
+ * times, which suits sending one package to many consumers.
+ *
+ * Referenced memory must outlive the list.
+ */
+typedef struct owf_iovec owf_iovec_t;
+
+/* @see owf_iovec_t */
+struct owf_iovec {
+    /* The allocator */
+    owf_alloc_t *alloc;
+
+    /* The error context */
+    owf_error_t *error;
+
+    /* The <owf_iovec_segment_t> array */
+    owf_array_t segments;
+
+    /* The scratch area */
+    owf_array_t scratch;
+
+    /* The total number of bytes in the list */
+    size_t length;
+
+    /* Payloads at least this long are referenced rather than copied */
+    uint32_t threshold;
+
+    /* A combination of <owf_iovec_flags_t> */
+    uint32_t flags;
+};
+
+/* Initializes an <owf_iovec_t>.
+ * @iovec The list
+ * @alloc The allocator
+ * @error The error context
+ * @flags A combination of <owf_iovec_flags_t>
+ */
+void owf_iovec_init(owf_iovec_t *iovec, owf_alloc_t *alloc, owf_error_t *error, uint32_t flags);
+
+/* Copies bytes into the scratch area of an <owf_iovec_t>.
+ * @iovec The list
+ * @src The bytes
+ * @size The number of bytes
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_iovec_copy(owf_iovec_t *iovec, const void *src, size_t size);
+
+/* Appends bytes to an <owf_iovec_t>, referencing them if they are long enough and copying them otherwise.
+ * @iovec The list
+ * @src The bytes, which must outlive the list if referenced
+ * @size The number of bytes
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_iovec_reference(owf_iovec_t *iovec, const void *src, size_t size);
+
+/* Appends samples to an <owf_iovec_t> in network byte order.
+ * @iovec The list
+ * @ptr The samples
+ * @count The number of samples
+ * Samples are referenced directly if no byteswap is needed, or swapped in place and referenced with
+ * <OWF_IOVEC_SWAP_IN_PLACE>. Otherwise, they are swapped straight into scratch.
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_iovec_samples(owf_iovec_t *iovec, const double *ptr, uint32_t count);
+
+/* Overwrites bytes already in the scratch area of an <owf_iovec_t>.
+ * @iovec The list
+ * @src The bytes
+ * @size The number of bytes
+ * @distance How many bytes before the end of the list to write them at
+ *
+ * @return True if successful, false if the bytes weren't all in one scratch segment
+ */
+bool owf_iovec_patch(owf_iovec_t *iovec, const void *src, size_t size, size_t distance);
+
+/* Writes an <owf_iovec_t> using a write callback, one call per segment.
+ * @iovec The list
+ * @write The write callback
+ * @data User data supplied to the write callback
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_iovec_flush(owf_iovec_t *iovec, owf_write_cb_t write, void *data);
+
+#if OWF_PLATFORM_IS_GNU
+/* Writes an <owf_iovec_t> to a file descriptor with writev.
+ * @iovec The list
+ * @fd The file descriptor
+ * Short writes and interrupted calls are retried.
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_iovec_writev(owf_iovec_t *iovec, int fd);
+
+/* Writes an <owf_iovec_t> to a connected socket with sendmsg.
+ * @iovec The list
+ * @fd The socket
+ * @flags Flags for sendmsg, like MSG_NOSIGNAL
+ * Short writes and interrupted calls are retried.
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_iovec_sendmsg(owf_iovec_t *iovec, int fd, int flags);
+#endif
+
+/* Empties an <owf_iovec_t> so it can be reused, keeping its memory.
+ * @iovec The list
+ * Samples swapped in place are swapped back to host byte order.
+ */
+void owf_iovec_clear(owf_iovec_t *iovec);
+
+/* Destroys an <owf_iovec_t>.
+ * @iovec The list
+ * Samples swapped in place are swapped back to host byte order.
+ */
+void owf_iovec_destroy(owf_iovec_t *iovec);
+
+#endif /* OWF_IOVEC_H */
@@ -0,0 +1,118 @@
+#include <owf.h>
+#include <owf/types.h>
+#include <owf/error.h>
+#include <owf/alloc.h>
+#include <owf/writer/binary.h>
+
+#ifndef OWF_TEMPLATE_H
+#define OWF_TEMPLATE_H
+
+/* Where a namespace's fields are in an <owf_template_t>. */
+typedef struct owf_template_namespace owf_template_namespace_t;
+
+/* @see owf_template_namespace_t */
+struct owf_template_namespace {
+    /* The offset of the channel ID's bytes */
+    uint32_t channel_id;
+
+    /* The offset of the namespace ID's bytes */
+    uint32_t id;
+
+    /* The offset of `t0`, which `dt` immediately follows */
+    uint32_t t0;
+};
+
+/* Where a signal's fields are in an <owf_template_t>. */
+typedef struct owf_template_signal owf_template_signal_t;
+
+/* @see owf_template_signal_t */
+struct owf_template_signal {
+    /* The index of the signal's namespace */
+    uint32_t ns;
+
+    /* The offset of the signal ID's bytes */
+    uint32_t id;
+
+    /* The offset of the first sample */
+    uint32_t samples;
+
+    /* The number of samples */
+    uint32_t count;
+};
+
+/* A pre-encoded package.
+ *
+ * Encodes a package once and remembers where each namespace's times and each signal's samples
+ * ended up, so a package with the same shape can be sent again and again by overwriting just
+ * those fields. Namespaces and signals are numbered in the order they appear in the package.
+ *
+ * Events and alarms are kept exactly as they were encoded, and aren't checked against new namespace times.
+ */
+typedef struct owf_template owf_template_t;
+
+/* @see owf_template_t */
+struct owf_template {
+    /* The allocator */
+    owf_alloc_t *alloc;
+
+    /* The error context */
+    owf_error_t *error;
+
+    /* The encoded package */
+    owf_buffer_t buffer;
+
+    /* The <owf_template_namespace_t> array */
+    owf_array_t namespaces;
+
+    /* The <owf_template_signal_t> array */
+    owf_array_t signals;
+};
+
+/* Encodes a package into an <owf_template_t>.
+ * @tmpl The template
+ * @owf The package, which isn't needed afterwards
+ * @alloc The allocator
+ * @error The error context
+ * On failure, the template is left empty and doesn't need destroying.
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_template_init(owf_template_t *tmpl, owf_package_t *owf, owf_alloc_t *alloc, owf_error_t *error);
+
+/* Finds a signal in an <owf_template_t> by its IDs.
+ * @tmpl The template
+ * @channel_id The channel ID
+ * @ns_id The namespace ID
+ * @signal_id The signal ID
+ * @index A pointer to store the signal's index in
+ *
+ * @return True if the signal was found, false otherwise
+ */
+bool owf_template_find_signal(owf_template_t *tmpl, const char *channel_id, const char *ns_id, const char *signal_id, uint32_t *index);
+
+/* Overwrites a namespace's start time and duration.
+ * @tmpl The template
+ * @ns The namespace's index
+ * @t0 The start time
+ * @dt The duration
+ *
+ * @return True if successful, false if there's no such namespace
+ */
+bool owf_template_set_time(owf_template_t *tmpl, uint32_t ns, owf_time_t t0, owf_duration_t dt);
+
+/* Overwrites a signal's samples.
+ * @tmpl The template
+ * @signal The signal's index
+ * @ptr The samples, in host byte order
+ * @count The number of samples, which must match the template
+ *
+ * @return True if successful, false if there's no such signal or the count was wrong
+ */
+bool owf_template_set_samples(owf_template_t *tmpl, uint32_t signal, const double *ptr, uint32_t count);
+
+/* Destroys an <owf_template_t>.
+ * @tmpl The template
+ */
+void owf_template_destroy(owf_template_t *tmpl);
+
+#endif /* OWF_TEMPLATE_H */
@@ -0,0 +1,93 @@
+#include <owf.h>
+#include <owf/types.h>
+#include <owf/error.h>
+#include <owf/projection.h>
+#include <owf/writer/binary.h>
+
+#ifndef OWF_TRANSFORM_H
+#define OWF_TRANSFORM_H
+
+/* Renames a node. */
+typedef struct owf_transform_rename owf_transform_rename_t;
+
+/* @see owf_transform_rename_t */
+struct owf_transform_rename {
+    /* The ID to match */
+    const char *from;
+
+    /* The ID to replace it with */
+    const char *to;
+};
+
+/* Describes how <owf_binary_transform> rewrites a package.
+ *
+ * The projection decides which channels, namespaces, and signals are kept, and which kinds of
+ * namespace children are dropped. Channels and namespaces matching a rename then get new IDs.
+ */
+typedef struct owf_transform owf_transform_t;
+
+/* @see owf_transform_t */
+struct owf_transform {
+    /* What to keep */
+    owf_projection_t projection;
+
+    /* Channel renames */
+    const owf_transform_rename_t *channels;
+    uint32_t channel_count;
+
+    /* Namespace renames */
+    const owf_transform_rename_t *namespaces;
+    uint32_t namespace_count;
+};
+
+/* Initializes a transform that keeps everything as it is.
+ * @transform The transform
+ */
+void owf_transform_init(owf_transform_t *transform);
+
+/* Sets the renames in a transform.
+ * @transform The transform
+ * @channels The channel renames, which must outlive the transform
+ * @channel_count The number of channel renames
+ * @namespaces The namespace renames, which must outlive the transform
+ * @namespace_count The number of namespace renames
+ */
+void owf_transform_set_renames(owf_transform_t *transform, const owf_transform_rename_t *channels, uint32_t channel_count,
+    const owf_transform_rename_t *namespaces, uint32_t namespace_count);
+
+/* Rewrites an encoded package without decoding it.
+ * @binary The binary writer
+ * @input The buffer holding the package at its position, which is advanced past it
+ * @transform The transform
+ * Only the headers the transform needs to look at are parsed. Subtrees it doesn't change are written
+ * as they are, as single runs of bytes, and only the lengths above changed nodes are recomputed. Bytes
+ * that are copied aren't validated, so run <owf_binary_validate> first if the input isn't trusted.
+ * Lengths are worked out before anything is written, so the writer doesn't need to be patchable.
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_binary_transform(owf_binary_writer_t *binary, owf_buffer_t *input, const owf_transform_t *transform);
+
+/* Flags for <owf_binary_splice>. */
+typedef enum owf_splice_flags owf_splice_flags_t;
+
+/* @see owf_splice_flags_t */
+enum owf_splice_flags {
+    /* Merge channels with the same ID into one, keeping their namespaces in order */
+    OWF_SPLICE_MERGE_CHANNELS = 1 << 0
+};
+
+/* Splices several encoded packages into one without decoding them.
+ * @binary The binary writer
+ * @inputs The buffers holding the packages at their positions, which are advanced past them
+ * @count The number of buffers
+ * @flags A combination of <owf_splice_flags_t>
+ * Channels are copied as they are, in order, under a new package header. When channels are merged,
+ * each merged channel gets a new length prefix, and every other byte is still copied as it is.
+ * Like <owf_binary_transform>, only headers are checked, and nothing is written if any input is invalid.
+ *
+ * @return True if successful, false otherwise
+ */
+bool owf_binary_splice(owf_binary_writer_t *binary, owf_buffer_t *inputs, uint32_t count, uint32_t flags);
+
+#endif /* OWF_TRANSFORM_H */
@@ -58,16 +58,34 @@
 #define OWF_SERVER_UDP 1
 
 #define OWF_SERVER_UDP_BUFFER_SIZE 1048576
+#define OWF_SERVER_TCP_CHUNK_SIZE 65536
 #define OWF_SERVER_MAX_CLIENT_BATCH 10
 #define OWF_SERVER_LISTEN_QUEUE 8192
 
+/* A TCP client: an incremental reader, so partial packets never block other clients,
+ * and a buffered writer, so echoes go out in a few large sends rather than one per field */
+typedef struct owf_server_client {
+    owf_binary_reader_t reader;
+    owf_buffered_t output;
+    owf_error_t error;
+} owf_server_client_t;
+
+/* The UDP server's reader, which reuses one package for every datagram */
+typedef struct owf_server_udp {
+    owf_binary_reader_t reader;
+    owf_buffer_t input;
+    owf_error_t error;
+} owf_server_udp_t;
+
 static volatile bool owf_server_go = true;
 
 void owf_server_signal(int sig);
 bool owf_server_setup_socket(owf_error_t *error, owf_socket_t fd, uint16_t mode, bool master);
 bool owf_server_start(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, const char *host_str, const char *protocol_str, const char *port_str);
-bool owf_server_loop_tcp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, struct pollfd *pfd, owf_socket_t sfd);
-bool owf_server_loop_udp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, uint8_t *buffer, size_t buffer_size, owf_socket_t sfd);
+bool owf_server_tcp_write_cb(const void *src, const size_t size, void *data);
+void owf_server_close_tcp(owf_alloc_t *alloc, struct pollfd *pfd, owf_server_client_t **client);
+bool owf_server_loop_tcp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, struct pollfd *pfd, owf_server_client_t **client);
+bool owf_server_loop_udp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, owf_server_udp_t *udp, owf_socket_t sfd);
 
 void owf_server_signal(int sig) {
     signal(sig, owf_server_signal);
@@ -129,7 +147,8 @@ bool owf_server_start(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, cons
     WSADATA ws;
 #endif
     char directory[1024];
-    owf_array_t fds;
+    owf_array_t fds, clients;
+    owf_server_udp_t udp;
     struct addrinfo hints, *host = NULL;
     struct addrinfo *ptr = NULL;
     uint8_t *buffer = NULL;
@@ -154,6 +173,14 @@ bool owf_server_start(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, cons
     hints.ai_flags = AI_NUMERICSERV | AI_CANONNAME;
     hints.ai_socktype = protocol == OWF_SERVER_TCP ? SOCK_STREAM : SOCK_DGRAM;
 
+    // Init an array of file descriptors, and a parallel array of clients
+    owf_array_init(&fds);
+    owf_array_init(&clients);
+    owf_error_init(&udp.error);
+    owf_buffer_init(&udp.input, NULL, 0);
+    owf_binary_reader_init_buffer(&udp.reader, &udp.input, alloc, &udp.error, NULL);
+    owf_binary_reader_reuse(&udp.reader);
+
 #if OWF_PLATFORM == OWF_PLATFORM_WINDOWS
     // initialize winsock
     if (WSAStartup(MAKEWORD(2, 2), &ws) != 0) {
@@ -225,9 +252,6 @@ bool owf_server_start(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, cons
         OWF_ERROR_SET(error, "couldn't bind");
         goto fail;
     }
-    
-    // Init an array of file descriptors
-    owf_array_init(&fds);
 
     // Loop
     if (protocol == OWF_SERVER_TCP) {
@@ -253,14 +277,32 @@ bool owf_server_start(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, cons
                         goto fail;
                     }
                     
-                    // create a poll file descriptor
+                    // create a client and a poll file descriptor; writes are done when we have a packet
+                    owf_server_client_t *client = owf_malloc(alloc, error, sizeof(owf_server_client_t));
                     struct pollfd pfd;
                     pfd.fd = cfd;
-                    pfd.events = POLLRDNORM | POLLWRNORM;
+                    pfd.events = POLLRDNORM;
+                    pfd.revents = 0;
+                    if (client == NULL) {
+                        owf_socket_close(cfd);
+                        goto fail;
+                    }
+                    owf_error_init(&client->error);
+                    owf_binary_reader_init_feed(&client->reader, alloc, &client->error, owf_reader_materialize_cb);
+                    owf_binary_reader_reuse(&client->reader);
+                    owf_buffered_init(&client->output, alloc, &client->error, owf_server_tcp_write_cb, NULL, NULL, OWF_SERVER_TCP_CHUNK_SIZE);
+
                     if (!owf_array_push(&fds, alloc, error, &pfd, sizeof(pfd))) {
+                        owf_socket_close(cfd);
+                        owf_free(alloc, client);
+                        goto fail;
+                    } else if (!owf_array_push(&clients, alloc, error, &client, sizeof(client))) {
+                        OWF_ARRAY_LEN(fds)--;
+                        owf_socket_close(cfd);
+                        owf_free(alloc, client);
                         goto fail;
                     } else {
-                        fprintf(logger, "accepted client on fd " OWF_SOCKET_PRINT "\n", fd);
+                        fprintf(logger, "accepted client on fd " OWF_SOCKET_PRINT "\n", cfd);
                     }
                 }
             }
@@ -272,10 +314,22 @@ bool owf_server_start(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, cons
             } else if (OWF_ARRAY_LEN(fds) > 0 && nfds > 0) {
                 for (uint32_t i = 0; i < OWF_ARRAY_LEN(fds); i++) {
                     // Process existing clients
-                    if (!owf_server_loop_tcp(logger, alloc, error, OWF_ARRAY_PTR(fds, struct pollfd, i), fd)) {
+                    if (!owf_server_loop_tcp(logger, alloc, error, OWF_ARRAY_PTR(fds, struct pollfd, i), OWF_ARRAY_PTR(clients, owf_server_client_t *, i))) {
                         goto fail;
                     }
                 }
+
+                // Compact away closed clients
+                for (uint32_t i = 0; i < OWF_ARRAY_LEN(fds);) {
+                    if (OWF_ARRAY_PTR(fds, struct pollfd, i)->fd < 0) {
+                        uint32_t last = --OWF_ARRAY_LEN(fds);
+                        OWF_ARRAY_LEN(clients)--;
+                        OWF_ARRAY_PUT(fds, struct pollfd, i, OWF_ARRAY_GET(fds, struct pollfd, last));
+                        OWF_ARRAY_PUT(clients, owf_server_client_t *, i, OWF_ARRAY_GET(clients, owf_server_client_t *, last));
+                    } else {
+                        i++;
+                    }
+                }
             }
         }
     } else {
@@ -284,10 +338,11 @@ bool owf_server_start(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, cons
         if (buffer == NULL) {
             goto fail;
         }
+        udp.input.ptr = buffer;
 
         while (owf_server_go) {
             // Process existing clients
-            if (!owf_server_loop_udp(logger, alloc, error, buffer, OWF_SERVER_UDP_BUFFER_SIZE, fd)) {
+            if (!owf_server_loop_udp(logger, alloc, error, &udp, fd)) {
                 goto fail;
             }
         }
@@ -299,8 +354,14 @@ fail:
 out:
     fprintf(logger, "Exiting\n");
     
-    // Destroy the array
+    // Close clients and destroy the arrays
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(fds); i++) {
+        owf_server_close_tcp(alloc, OWF_ARRAY_PTR(fds, struct pollfd, i), OWF_ARRAY_PTR(clients, owf_server_client_t *, i));
+    }
     owf_array_destroy(&fds, alloc);
+    owf_array_destroy(&clients, alloc);
+    owf_binary_reader_destroy(&udp.reader);
+    owf_free(alloc, buffer);
     
     if (fd != -1) {
         owf_socket_close(fd);
@@ -318,40 +379,6 @@ out:
     return ret;
 }
 
-bool owf_server_tcp_read_cb(void *dest, const size_t size, void *data) {
-    struct pollfd *pfd = (struct pollfd *)data;
-    size_t bytes_left = size;
-    ssize_t bytes_read;
-    uint8_t *buf = (uint8_t *)dest;
-
-#if OWF_PLATFORM == OWF_PLATFORM_LINUX
-    // covers SIGPIPE on Linux
-    const int flags = MSG_NOSIGNAL;
-#else
-    // BSD/Darwin are covered by setsockopt, Windows doesn't have the SIGPIPE issue
-    const int flags = 0;
-#endif
-
-    while (bytes_left > 0) {
-        if ((bytes_read = recv(pfd->fd, buf, bytes_left, flags)) < 0) {
-            if (OWF_NOEXPECT(OWF_SOCKET_ERROR == OWF_SOCKET_EINTR)) {
-                bytes_read = 0;
-            } else if (OWF_NOEXPECT(OWF_SOCKET_ERROR == OWF_SOCKET_EWOULDBLOCK)) {
-                continue;
-            } else {
-                return false;
-            }
-        } else if (bytes_read == 0) {
-            break;
-        }
-
-        bytes_left -= (size_t)bytes_read;
-        buf += (size_t)bytes_read;
-    }
-
-    return bytes_left == 0;
-}
-
 bool owf_server_tcp_write_cb(const void *src, const size_t size, void *data) {
     struct pollfd *pfd = (struct pollfd *)data;
     size_t bytes_left = size;
@@ -384,75 +411,104 @@ bool owf_server_tcp_write_cb(const void *src, const size_t size, void *data) {
     return bytes_left == 0;
 }
 
-bool owf_server_loop_tcp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, struct pollfd *pfd, owf_socket_t sfd) {
-    owf_binary_reader_t reader;
+void owf_server_close_tcp(owf_alloc_t *alloc, struct pollfd *pfd, owf_server_client_t **client) {
+    if (pfd->fd >= 0) {
+        owf_socket_close(pfd->fd);
+        pfd->fd = -1;
+        pfd->events = 0;
+        pfd->revents = 0;
+    }
+
+    if (*client != NULL) {
+        owf_binary_reader_destroy(&(*client)->reader);
+        owf_buffered_destroy(&(*client)->output);
+        owf_free(alloc, *client);
+        *client = NULL;
+    }
+}
+
+bool owf_server_loop_tcp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, struct pollfd *pfd, owf_server_client_t **client) {
+    owf_binary_reader_t *reader = &(*client)->reader;
     owf_binary_writer_t writer;
-    owf_error_t rw_error;
-    owf_package_t *owf = NULL;
+    owf_error_t w_error;
+    uint8_t chunk[OWF_SERVER_TCP_CHUNK_SIZE];
+    ssize_t bytes_read;
+    size_t offset, consumed;
     uint32_t size = 0;
 
-    if (pfd->revents & POLLRDNORM && pfd->revents & POLLWRNORM && !(pfd->revents & POLLHUP) && !(pfd->revents & POLLERR) && !(pfd->revents & POLLNVAL)) {
-        // Some data is here, hopefully containing an OWF message.
-        // Greedily eat the data until we can receive an OWF message.
-        owf_error_init(&rw_error);
-        owf_binary_reader_init(&reader, alloc, &rw_error, owf_server_tcp_read_cb, NULL, pfd);
-
-        if ((owf = owf_binary_materialize(&reader)) == NULL) {
-            fprintf(logger, "<= error materializing packet for fd " OWF_SOCKET_PRINT ": %s\n", pfd->fd, rw_error.error);
-            owf_socket_close(pfd->fd);
-            pfd->fd = 0;
-            pfd->events = 0;
-            pfd->revents = 0;
-        } else {
-            // hooray, we have an OWF packet
-            if (!owf_package_size(owf, &rw_error, &size)) {
-                fprintf(logger, "<= error getting OWF size for fd " OWF_SOCKET_PRINT "'s packet: %s\n", pfd->fd, rw_error.error);
-                owf_socket_close(pfd->fd);
-                pfd->fd = 0;
-                pfd->events = 0;
-                pfd->revents = 0;
-            } else {
-                fprintf(logger, "<= got a " OWF_PRINT_U32 "-byte OWF packet from fd " OWF_SOCKET_PRINT "\n", size, pfd->fd);
-            }
-        }
+#if OWF_PLATFORM == OWF_PLATFORM_LINUX
+    // covers SIGPIPE on Linux
+    const int flags = MSG_NOSIGNAL;
+#else
+    // BSD/Darwin are covered by setsockopt, Windows doesn't have the SIGPIPE issue
+    const int flags = 0;
+#endif
+
+    if (pfd->fd < 0) {
+        return true;
+    } else if (pfd->revents & (POLLERR | POLLNVAL)) {
+        fprintf(logger, "<= error polling fd " OWF_SOCKET_PRINT "\n", pfd->fd);
+        owf_server_close_tcp(alloc, pfd, client);
+        return true;
+    } else if (!(pfd->revents & (POLLRDNORM | POLLHUP))) {
+        return true;
     }
 
-    if (pfd->revents & POLLWRNORM && !(pfd->revents & POLLHUP) && !(pfd->revents & POLLERR) && !(pfd->revents & POLLNVAL) && owf != NULL) {
-        // initialize the binary writer
-        owf_error_init(&rw_error);
-        owf_binary_writer_init(&writer, alloc, &rw_error, owf_server_tcp_write_cb, pfd);
-
-        // write to the buffer
-        if (!owf_binary_write(&writer, owf)) {
-            fprintf(logger, "=> error writing packet to fd " OWF_SOCKET_PRINT ": %s\n", pfd->fd, rw_error.error);
-            owf_socket_close(pfd->fd);
-            pfd->fd = 0;
-            pfd->events = 0;
-            pfd->revents = 0;
-        } else {
-            if (!owf_package_size(owf, &rw_error, &size)) {
-                fprintf(logger, "=> error getting OWF size for fd " OWF_SOCKET_PRINT "'s packet: %s\n", pfd->fd, rw_error.error);
-                owf_socket_close(pfd->fd);
-                pfd->fd = 0;
-                pfd->events = 0;
-                pfd->revents = 0;
-            } else {
-                fprintf(logger, "=> wrote a " OWF_PRINT_U32 "-byte OWF packet to fd " OWF_SOCKET_PRINT "\n", size, pfd->fd);
+    // Eat whatever data is here, feeding it to this client's reader until the socket would block
+    while (true) {
+        if ((bytes_read = recv(pfd->fd, (char *)chunk, sizeof(chunk), flags)) < 0) {
+            if (OWF_SOCKET_ERROR == OWF_SOCKET_EINTR) {
+                continue;
+            } else if (OWF_SOCKET_ERROR == OWF_SOCKET_EAGAIN || OWF_SOCKET_ERROR == OWF_SOCKET_EWOULDBLOCK) {
+                // wait for poll to tell us there's more
+                return true;
             }
+            fprintf(logger, "<= error reading from fd " OWF_SOCKET_PRINT ": %d\n", pfd->fd, OWF_SOCKET_ERROR);
+            owf_server_close_tcp(alloc, pfd, client);
+            return true;
+        } else if (bytes_read == 0) {
+            fprintf(logger, "<= fd " OWF_SOCKET_PRINT " disconnected\n", pfd->fd);
+            owf_server_close_tcp(alloc, pfd, client);
+            return true;
         }
-    }
 
-    if (owf != NULL) {
-        owf_package_destroy(owf, alloc);
-    }
+        for (offset = 0; offset < (size_t)bytes_read; offset += consumed) {
+            owf_binary_feed_status_t status = owf_binary_reader_feed(reader, chunk + offset, (size_t)bytes_read - offset, &consumed);
+            owf_package_t *owf = &reader->reader.ctx.owf;
+
+            if (status == OWF_BINARY_FEED_ERROR) {
+                fprintf(logger, "<= error materializing packet for fd " OWF_SOCKET_PRINT ": %s\n", pfd->fd, (*client)->error.error);
+                owf_server_close_tcp(alloc, pfd, client);
+                return true;
+            } else if (status == OWF_BINARY_FEED_DONE) {
+                // hooray, we have an OWF packet; echo it back
+                // (the pollfd moves whenever the fd array grows or compacts, so point the output at it each time)
+                owf_buffered_t *output = &(*client)->output;
+                owf_error_init(&w_error);
+                output->data = pfd;
+                output->error = &w_error;
+                owf_binary_writer_init_buffered(&writer, output, alloc, &w_error);
+
+                if (!owf_package_size(owf, &w_error, &size)) {
+                    fprintf(logger, "<= error getting OWF size for fd " OWF_SOCKET_PRINT "'s packet: %s\n", pfd->fd, w_error.error);
+                } else if (fprintf(logger, "<= got a " OWF_PRINT_U32 "-byte OWF packet from fd " OWF_SOCKET_PRINT "\n", size, pfd->fd) &&
+                    (!owf_binary_write(&writer, owf) || !owf_buffered_flush(output))) {
+                    fprintf(logger, "=> error writing packet to fd " OWF_SOCKET_PRINT ": %s\n", pfd->fd, w_error.error);
+                } else {
+                    fprintf(logger, "=> wrote a " OWF_PRINT_U32 "-byte OWF packet to fd " OWF_SOCKET_PRINT "\n", size, pfd->fd);
+                    continue;
+                }
 
-    return true;
+                owf_server_close_tcp(alloc, pfd, client);
+                return true;
+            }
+        }
+    }
 }
 
-bool owf_server_loop_udp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, uint8_t *buffer, size_t buffer_size, owf_socket_t sfd) {
-    owf_binary_reader_t reader;
+bool owf_server_loop_udp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, owf_server_udp_t *udp, owf_socket_t sfd) {
     owf_binary_writer_t writer;
-    owf_buffer_t input_buffer, output_buffer;
+    owf_buffer_t output_buffer;
     owf_error_t rw_error;
 
     struct sockaddr_storage client_addr;
@@ -462,15 +518,15 @@ bool owf_server_loop_udp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, u
     uint32_t tmp;
 
     // Read the packet
-    if ((len = recvfrom(sfd, buffer, buffer_size, 0, (struct sockaddr *)&client_addr, &client_len)) > 0) {
-        // We've got the UDP packet in a buffer. Read it.
-        owf_error_init(&rw_error);
-        owf_buffer_init(&input_buffer, buffer, (size_t)len);
-        owf_binary_reader_init_buffer(&reader, &input_buffer, alloc, &rw_error, NULL);
+    if ((len = recvfrom(sfd, udp->input.ptr, OWF_SERVER_UDP_BUFFER_SIZE, 0, (struct sockaddr *)&client_addr, &client_len)) > 0) {
+        // We've got the UDP packet in a buffer. Read it over the last one.
+        owf_error_init(&udp->error);
+        owf_buffer_init(&udp->input, udp->input.ptr, (size_t)len);
 
-        if ((owf = owf_binary_materialize(&reader)) == NULL) {
-            fprintf(logger, "<= error materializing packet: %s\n", owf_error_strerror(&rw_error));
+        if ((owf = owf_binary_materialize(&udp->reader)) == NULL) {
+            fprintf(logger, "<= error materializing packet: %s\n", owf_error_strerror(&udp->error));
         } else {
+            owf_error_init(&rw_error);
             if (!owf_package_size(owf, &rw_error, &tmp)) {
                 fprintf(logger, "<= error getting OWF size packet: %s\n", owf_error_strerror(&rw_error));
             } else {
@@ -509,8 +565,6 @@ bool owf_server_loop_udp(FILE *logger, owf_alloc_t *alloc, owf_error_t *error, u
 
             owf_free(alloc, ptr);
         }
-
-        owf_package_destroy(owf, alloc);
     }
 
     return true;
@@ -6,9 +6,24 @@ void owf_alloc_init(owf_alloc_t *alloc, owf_malloc_cb_t malloc_fn, owf_realloc_c
     alloc->realloc = realloc_fn;
     alloc->free = free_fn;
     alloc->max_alloc = max_alloc;
+    alloc->vtable = NULL;
+    alloc->ctx = NULL;
+}
+
+void owf_alloc_init_vtable(owf_alloc_t *alloc, const owf_alloc_vtable_t *vtable, void *ctx, size_t max_alloc) {
+    alloc->malloc = NULL;
+    alloc->realloc = NULL;
+    alloc->free = NULL;
+    alloc->max_alloc = max_alloc;
+    alloc->vtable = vtable;
+    alloc->ctx = ctx;
 }
 
 void *owf_malloc(owf_alloc_t *alloc, owf_error_t *error, size_t size) {
+    return owf_malloc_aligned(alloc, error, size, OWF_ALLOC_DEFAULT_ALIGN);
+}
+
+void *owf_malloc_aligned(owf_alloc_t *alloc, owf_error_t *error, size_t size, size_t align) {
     if (OWF_NOEXPECT(size == 0)) {
         /* The size is too small */
         OWF_ERROR_SET(error, "can't allocate zero bytes");
@@ -17,9 +32,22 @@ void *owf_malloc(owf_alloc_t *alloc, owf_error_t *error, size_t size) {
         /* The size is too big */
         OWF_ERROR_SETF(error, "allocated size was greater than max (" OWF_PRINT_SIZE " > " OWF_PRINT_SIZE ")", size, alloc->max_alloc);
         return NULL;
+    } else if (OWF_NOEXPECT(align == 0 || (align & (align - 1)) != 0)) {
+        OWF_ERROR_SETF(error, "alignment wasn't a power of two (" OWF_PRINT_SIZE ")", align);
+        return NULL;
     } else {
-        /* This is just malloc */
-        void *ret = alloc->malloc(size);
+        void *ret;
+        if (alloc->vtable != NULL) {
+            ret = alloc->vtable->malloc(alloc->ctx, size, align);
+        } else if (OWF_NOEXPECT(align > OWF_ALLOC_DEFAULT_ALIGN)) {
+            /* Plain malloc has no way to ask for more */
+            OWF_ERROR_SETF(error, "alignment was greater than the allocator supports (" OWF_PRINT_SIZE " > " OWF_PRINT_SIZE ")", align, (size_t)OWF_ALLOC_DEFAULT_ALIGN);
+            return NULL;
+        } else {
+            /* This is just malloc */
+            ret = alloc->malloc(size);
+        }
+
         if (OWF_NOEXPECT(ret == NULL)) {
             OWF_ERROR_SET(error, "malloc failure");
             return NULL;
@@ -30,6 +58,10 @@ void *owf_malloc(owf_alloc_t *alloc, owf_error_t *error, size_t size) {
 }
 
 bool owf_realloc(owf_alloc_t *alloc, owf_error_t *error, void **bp, size_t size) {
+    return owf_realloc_sized(alloc, error, bp, 0, size);
+}
+
+bool owf_realloc_sized(owf_alloc_t *alloc, owf_error_t *error, void **bp, size_t old_size, size_t size) {
     void *new_bp = NULL;
 
     if (OWF_NOEXPECT(bp == NULL)) {
@@ -55,7 +87,9 @@ bool owf_realloc(owf_alloc_t *alloc, owf_error_t *error, void **bp, size_t size)
         return false;
     } else {
         /* This is realloc */
-        new_bp = alloc->realloc(*bp, size);
+        new_bp = alloc->vtable != NULL ?
+            alloc->vtable->realloc(alloc->ctx, *bp, old_size, size, OWF_ALLOC_DEFAULT_ALIGN) :
+            alloc->realloc(*bp, size);
         if (OWF_NOEXPECT(new_bp == NULL)) {
             OWF_ERROR_SET(error, "realloc failure");
             return false;
@@ -67,7 +101,15 @@ bool owf_realloc(owf_alloc_t *alloc, owf_error_t *error, void **bp, size_t size)
 }
 
 void owf_free(owf_alloc_t *alloc, void *bp) {
+    owf_free_sized(alloc, bp, 0);
+}
+
+void owf_free_sized(owf_alloc_t *alloc, void *bp, size_t size) {
     if (OWF_EXPECT(bp != NULL)) {
-        alloc->free(bp);
+        if (alloc->vtable != NULL) {
+            alloc->vtable->free(alloc->ctx, bp, size);
+        } else {
+            alloc->free(bp);
+        }
     }
 }
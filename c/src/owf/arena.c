@@ -0,0 +1,169 @@
+#include <owf/arena.h>
+#include <owf/platform.h>
+
+/* The header at the start of each chunk of an <owf_arena_t>. */
+typedef struct owf_arena_chunk owf_arena_chunk_t;
+
+/* @see owf_arena_chunk_t */
+struct owf_arena_chunk {
+    /* The next older chunk, or NULL */
+    owf_arena_chunk_t *next;
+
+    /* The size of the chunk, including this header */
+    size_t size;
+};
+
+/* Rounds a pointer up to an alignment.
+ * @ptr The pointer
+ * @align The alignment, which must be a power of two
+ *
+ * @return The rounded pointer
+ */
+static uint8_t *owf_arena_align(uint8_t *ptr, size_t align) {
+    return ptr + ((align - (uintptr_t)ptr % align) % align);
+}
+
+/* Starts a new chunk with room for at least `size` bytes at any alignment up to `align`.
+ * @arena The arena
+ * @size The size of the allocation that didn't fit
+ * @align The alignment of the allocation
+ *
+ * @return True if successful, false otherwise
+ */
+static bool owf_arena_grow(owf_arena_t *arena, size_t size, size_t align) {
+    owf_arena_chunk_t *chunk;
+    size_t chunk_size = OWF_MIN(arena->chunk_size, arena->parent->max_alloc);
+
+    if (OWF_NOEXPECT(size > SIZE_MAX - sizeof(owf_arena_chunk_t) - align)) {
+        OWF_ERROR_SETF(&arena->error, "chunk size overflow (" OWF_PRINT_SIZE " bytes)", size);
+        return false;
+    }
+    size += sizeof(owf_arena_chunk_t) + align;
+    chunk_size = OWF_MAX(chunk_size, size);
+
+    if (OWF_NOEXPECT((chunk = owf_malloc(arena->parent, &arena->error, chunk_size)) == NULL)) {
+        return false;
+    }
+
+    if (arena->chunks != NULL) {
+        arena->spilled += (size_t)(arena->next - (uint8_t *)((owf_arena_chunk_t *)arena->chunks + 1));
+    }
+    chunk->next = arena->chunks;
+    chunk->size = chunk_size;
+    arena->chunks = chunk;
+    arena->next = (uint8_t *)(chunk + 1);
+    arena->end = (uint8_t *)chunk + chunk_size;
+    arena->last = NULL;
+    arena->total += chunk_size;
+    return true;
+}
+
+static void *owf_arena_malloc_cb(void *ctx, size_t size, size_t align) {
+    owf_arena_t *arena = (owf_arena_t *)ctx;
+    uint8_t *ptr = arena->chunks == NULL ? NULL : owf_arena_align(arena->next, align);
+
+    if (OWF_NOEXPECT(ptr == NULL || ptr > arena->end || size > (size_t)(arena->end - ptr))) {
+        if (OWF_NOEXPECT(!owf_arena_grow(arena, size, align))) {
+            return NULL;
+        }
+        ptr = owf_arena_align(arena->next, align);
+    }
+
+    arena->last = ptr;
+    arena->next = ptr + size;
+    return ptr;
+}
+
+static void *owf_arena_realloc_cb(void *ctx, void *ptr, size_t old_size, size_t size, size_t align) {
+    owf_arena_t *arena = (owf_arena_t *)ctx;
+    void *ret;
+
+    if (ptr == arena->last) {
+        /* The most recent block can just move the cursor */
+        if (size <= (size_t)(arena->end - arena->last)) {
+            arena->next = arena->last + size;
+            return ptr;
+        }
+        old_size = (size_t)(arena->next - arena->last);
+    } else if (OWF_NOEXPECT(old_size == 0)) {
+        /* There's no telling how much to copy */
+        return NULL;
+    }
+
+    if (size <= old_size) {
+        return ptr;
+    } else if (OWF_NOEXPECT((ret = owf_arena_malloc_cb(ctx, size, align)) == NULL)) {
+        return NULL;
+    }
+    memcpy(ret, ptr, old_size);
+    return ret;
+}
+
+static void owf_arena_free_cb(void *ctx, void *ptr, size_t size) {
+    owf_arena_t *arena = (owf_arena_t *)ctx;
+    (void)size;
+
+    /* Only the most recent block can be given back early */
+    if (ptr == arena->last) {
+        arena->next = arena->last;
+        arena->last = NULL;
+    }
+}
+
+/* The callbacks behind every arena's allocator. */
+static const owf_alloc_vtable_t owf_arena_vtable = {
+    .malloc = owf_arena_malloc_cb,
+    .realloc = owf_arena_realloc_cb,
+    .free = owf_arena_free_cb
+};
+
+void owf_arena_init(owf_arena_t *arena, owf_alloc_t *parent, size_t chunk_size) {
+    /* Leave room for a chunk header and alignment, so anything the arena accepts fits in a chunk */
+    const size_t overhead = sizeof(owf_arena_chunk_t) + OWF_ALLOC_DEFAULT_ALIGN;
+
+    owf_alloc_init_vtable(&arena->alloc, &owf_arena_vtable, arena, parent->max_alloc > overhead ? parent->max_alloc - overhead : 0);
+    owf_error_init(&arena->error);
+    arena->parent = parent;
+    arena->chunks = NULL;
+    arena->next = NULL;
+    arena->end = NULL;
+    arena->last = NULL;
+    arena->chunk_size = chunk_size > 0 ? chunk_size : OWF_ARENA_DEFAULT_CHUNK_SIZE;
+    arena->total = 0;
+    arena->spilled = 0;
+}
+
+void owf_arena_reset(owf_arena_t *arena) {
+    owf_arena_chunk_t *chunk = (owf_arena_chunk_t *)arena->chunks;
+
+    if (chunk == NULL) {
+        return;
+    } else if (chunk->next != NULL) {
+        /* Coalesce with a quarter to spare, so the next packet of this size fits in one chunk */
+        size_t used = arena->spilled + (size_t)(arena->next - (uint8_t *)(chunk + 1));
+        used = used <= (SIZE_MAX - sizeof(owf_arena_chunk_t)) / 5 * 4 ? used + used / 4 + sizeof(owf_arena_chunk_t) : SIZE_MAX;
+        owf_arena_destroy(arena);
+        arena->chunk_size = OWF_MAX(arena->chunk_size, used);
+        return;
+    }
+
+    arena->next = (uint8_t *)(chunk + 1);
+    arena->last = NULL;
+}
+
+void owf_arena_destroy(owf_arena_t *arena) {
+    owf_arena_chunk_t *chunk = (owf_arena_chunk_t *)arena->chunks;
+
+    while (chunk != NULL) {
+        owf_arena_chunk_t *next = chunk->next;
+        owf_free_sized(arena->parent, chunk, chunk->size);
+        chunk = next;
+    }
+
+    arena->chunks = NULL;
+    arena->next = NULL;
+    arena->end = NULL;
+    arena->last = NULL;
+    arena->total = 0;
+    arena->spilled = 0;
+}
@@ -0,0 +1,188 @@
+#include <owf/byteswap.h>
+#include <owf/platform.h>
+
+#include <string.h>
+
+/* Unconditional 64-bit swaps, regardless of host endianness */
+#if OWF_PLATFORM_IS_GNU
+    #define OWF_BYTESWAP64(x) __builtin_bswap64(x)
+#elif OWF_PLATFORM == OWF_PLATFORM_WINDOWS
+    #define OWF_BYTESWAP64(x) _byteswap_uint64(x)
+#endif
+
+/* Vector kernels. These need GCC-style target attributes, so MSVC builds use the scalar kernel. */
+#if OWF_PLATFORM_IS_GNU && (defined(__x86_64__) || defined(__i386__))
+    #define OWF_BYTESWAP_X86 1
+    #include <immintrin.h>
+#elif OWF_PLATFORM_IS_GNU && defined(__aarch64__) && defined(__ARM_NEON)
+    #define OWF_BYTESWAP_NEON 1
+    #include <arm_neon.h>
+#endif
+
+void owf_byteswap64_scalar(void *dst, const void *src, size_t count) {
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    uint64_t word;
+
+    for (size_t i = 0; i < count; i++) {
+        memcpy(&word, s + i * sizeof(word), sizeof(word));
+        word = OWF_BYTESWAP64(word);
+        memcpy(d + i * sizeof(word), &word, sizeof(word));
+    }
+}
+
+#if OWF_BYTESWAP_X86
+__attribute__((target("ssse3")))
+static void owf_byteswap64_ssse3(void *dst, const void *src, size_t count) {
+    const __m128i mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    size_t i = 0;
+
+    /* Four vectors (eight words) per iteration */
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(s + i * 8));
+        __m128i b = _mm_loadu_si128((const __m128i *)(s + i * 8 + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *)(s + i * 8 + 32));
+        __m128i e = _mm_loadu_si128((const __m128i *)(s + i * 8 + 48));
+        _mm_storeu_si128((__m128i *)(d + i * 8), _mm_shuffle_epi8(a, mask));
+        _mm_storeu_si128((__m128i *)(d + i * 8 + 16), _mm_shuffle_epi8(b, mask));
+        _mm_storeu_si128((__m128i *)(d + i * 8 + 32), _mm_shuffle_epi8(c, mask));
+        _mm_storeu_si128((__m128i *)(d + i * 8 + 48), _mm_shuffle_epi8(e, mask));
+    }
+
+    for (; i + 2 <= count; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(s + i * 8));
+        _mm_storeu_si128((__m128i *)(d + i * 8), _mm_shuffle_epi8(a, mask));
+    }
+
+    owf_byteswap64_scalar(d + i * 8, s + i * 8, count - i);
+}
+
+__attribute__((target("avx2")))
+static void owf_byteswap64_avx2(void *dst, const void *src, size_t count) {
+    const __m256i mask = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    size_t i = 0;
+
+    /* Four vectors (sixteen words) per iteration */
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + i * 8));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(s + i * 8 + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i *)(s + i * 8 + 64));
+        __m256i e = _mm256_loadu_si256((const __m256i *)(s + i * 8 + 96));
+        _mm256_storeu_si256((__m256i *)(d + i * 8), _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256((__m256i *)(d + i * 8 + 32), _mm256_shuffle_epi8(b, mask));
+        _mm256_storeu_si256((__m256i *)(d + i * 8 + 64), _mm256_shuffle_epi8(c, mask));
+        _mm256_storeu_si256((__m256i *)(d + i * 8 + 96), _mm256_shuffle_epi8(e, mask));
+    }
+
+    for (; i + 4 <= count; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + i * 8));
+        _mm256_storeu_si256((__m256i *)(d + i * 8), _mm256_shuffle_epi8(a, mask));
+    }
+
+    owf_byteswap64_scalar(d + i * 8, s + i * 8, count - i);
+}
+
+__attribute__((target("avx512bw")))
+static void owf_byteswap64_avx512bw(void *dst, const void *src, size_t count) {
+    const __m512i mask = _mm512_broadcast_i32x4(_mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    size_t i = 0;
+
+    /* Two vectors (sixteen words) per iteration */
+    for (; i + 16 <= count; i += 16) {
+        __m512i a = _mm512_loadu_si512((const void *)(s + i * 8));
+        __m512i b = _mm512_loadu_si512((const void *)(s + i * 8 + 64));
+        _mm512_storeu_si512((void *)(d + i * 8), _mm512_shuffle_epi8(a, mask));
+        _mm512_storeu_si512((void *)(d + i * 8 + 64), _mm512_shuffle_epi8(b, mask));
+    }
+
+    for (; i + 8 <= count; i += 8) {
+        __m512i a = _mm512_loadu_si512((const void *)(s + i * 8));
+        _mm512_storeu_si512((void *)(d + i * 8), _mm512_shuffle_epi8(a, mask));
+    }
+
+    owf_byteswap64_scalar(d + i * 8, s + i * 8, count - i);
+}
+#endif
+
+#if OWF_BYTESWAP_NEON
+static void owf_byteswap64_neon(void *dst, const void *src, size_t count) {
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+    size_t i = 0;
+
+    /* Four vectors (eight words) per iteration */
+    for (; i + 8 <= count; i += 8) {
+        uint8x16_t a = vld1q_u8(s + i * 8);
+        uint8x16_t b = vld1q_u8(s + i * 8 + 16);
+        uint8x16_t c = vld1q_u8(s + i * 8 + 32);
+        uint8x16_t e = vld1q_u8(s + i * 8 + 48);
+        vst1q_u8(d + i * 8, vrev64q_u8(a));
+        vst1q_u8(d + i * 8 + 16, vrev64q_u8(b));
+        vst1q_u8(d + i * 8 + 32, vrev64q_u8(c));
+        vst1q_u8(d + i * 8 + 48, vrev64q_u8(e));
+    }
+
+    for (; i + 2 <= count; i += 2) {
+        vst1q_u8(d + i * 8, vrev64q_u8(vld1q_u8(s + i * 8)));
+    }
+
+    owf_byteswap64_scalar(d + i * 8, s + i * 8, count - i);
+}
+#endif
+
+/* A kernel and its name */
+typedef struct owf_byteswap64_impl {
+    owf_byteswap64_cb_t fn;
+    const char *name;
+} owf_byteswap64_impl_t;
+
+/* Picks the best kernel for this CPU */
+static owf_byteswap64_impl_t owf_byteswap64_select(void) {
+    owf_byteswap64_impl_t impl = {owf_byteswap64_scalar, "scalar"};
+#if OWF_BYTESWAP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+        impl.fn = owf_byteswap64_avx512bw;
+        impl.name = "avx512bw";
+    } else if (__builtin_cpu_supports("avx2")) {
+        impl.fn = owf_byteswap64_avx2;
+        impl.name = "avx2";
+    } else if (__builtin_cpu_supports("ssse3")) {
+        impl.fn = owf_byteswap64_ssse3;
+        impl.name = "ssse3";
+    }
+#elif OWF_BYTESWAP_NEON
+    impl.fn = owf_byteswap64_neon;
+    impl.name = "neon";
+#endif
+    return impl;
+}
+
+static void owf_byteswap64_resolve(void *dst, const void *src, size_t count);
+
+/* The selected kernel. Starts out as the resolver, which replaces itself on the first call;
+ * racing threads all store the same pointer, so no locking is needed.
+ */
+static volatile owf_byteswap64_cb_t owf_byteswap64_fn = owf_byteswap64_resolve;
+
+static void owf_byteswap64_resolve(void *dst, const void *src, size_t count) {
+    owf_byteswap64_cb_t fn = owf_byteswap64_select().fn;
+    owf_byteswap64_fn = fn;
+    fn(dst, src, count);
+}
+
+void owf_byteswap64(void *dst, const void *src, size_t count) {
+    owf_byteswap64_fn(dst, src, count);
+}
+
+const char *owf_byteswap64_kernel(void) {
+    return owf_byteswap64_select().name;
+}
@@ -0,0 +1,274 @@
+#include <owf/intern.h>
+#include <owf/platform.h>
+
+#include <string.h>
+
+/* The number of bits of a hash that pick the shard. */
+#define OWF_INTERN_SHARD_BITS 4
+
+#if (1 << OWF_INTERN_SHARD_BITS) != OWF_INTERN_SHARDS
+    #error "OWF_INTERN_SHARD_BITS doesn't match OWF_INTERN_SHARDS"
+#endif
+
+/* An interned string, followed by its bytes. */
+typedef struct owf_intern_entry owf_intern_entry_t;
+
+/* @see owf_intern_entry_t */
+struct owf_intern_entry {
+    /* The canonical string, which borrows `bytes` */
+    owf_str_t str;
+
+    /* The hash of the string */
+    uint32_t hash;
+
+    /* The length of the string, not including the NUL terminator */
+    uint32_t length;
+
+    /* The bytes of the string, including the NUL terminator */
+    char bytes[];
+};
+
+/* @see owf_intern_table_t */
+struct owf_intern_table {
+    /* The number of slots, which is a power of two */
+    uint32_t capacity;
+
+    /* The next older retired table */
+    owf_intern_table_t *next;
+
+    /* The slots, each holding an entry or NULL. Slots are only written once, from NULL to an entry. */
+    owf_intern_entry_t *slots[];
+};
+
+/* Hashes a string with 32-bit FNV-1a.
+ * @value The string
+ * @length The length of the string
+ *
+ * @return The hash
+ */
+static uint32_t owf_intern_hash(const char *value, uint32_t length) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)value[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/* Looks a string up in a table, without taking a lock.
+ * @table The table, which may be NULL
+ * @hash The hash of the string
+ * @value The string
+ * @length The length of the string
+ * @slot Set to the empty slot the string would go in if it's missing, if not NULL
+ *
+ * @return The entry, or NULL if the string isn't in the table
+ */
+static owf_intern_entry_t *owf_intern_probe(owf_intern_table_t *table, uint32_t hash, const char *value, uint32_t length, uint32_t *slot) {
+    if (table == NULL) {
+        return NULL;
+    }
+
+    const uint32_t mask = table->capacity - 1;
+    for (uint32_t idx = hash & mask;; idx = (idx + 1) & mask) {
+        owf_intern_entry_t *entry = OWF_ATOMIC_LOAD_PTR(&table->slots[idx]);
+        if (entry == NULL) {
+            if (slot != NULL) {
+                *slot = idx;
+            }
+            return NULL;
+        } else if (entry->hash == hash && entry->length == length && memcmp(entry->bytes, value, length) == 0) {
+            return entry;
+        }
+    }
+}
+
+/* Allocates an empty table.
+ * @intern The intern table
+ * @error The error context
+ * @capacity The number of slots, which must be a power of two
+ *
+ * @return The table, or NULL on failure
+ */
+static owf_intern_table_t *owf_intern_table_new(owf_intern_t *intern, owf_error_t *error, uint32_t capacity) {
+    if (OWF_NOEXPECT(capacity > (SIZE_MAX - sizeof(owf_intern_table_t)) / sizeof(owf_intern_entry_t *))) {
+        OWF_ERROR_SET(error, "intern table is too big");
+        return NULL;
+    }
+
+    const size_t size = sizeof(owf_intern_table_t) + capacity * sizeof(owf_intern_entry_t *);
+    owf_intern_table_t *table = owf_malloc(intern->alloc, error, size);
+    if (OWF_NOEXPECT(table == NULL)) {
+        return NULL;
+    }
+
+    table->capacity = capacity;
+    table->next = NULL;
+    memset(table->slots, 0, capacity * sizeof(owf_intern_entry_t *));
+    return table;
+}
+
+/* Makes room for one more string in a shard, replacing its table with one twice the size if it would get more than half full.
+ * @intern The intern table
+ * @error The error context
+ * @shard The shard, whose lock must be held
+ *
+ * @return true if there's room, false on failure
+ */
+static bool owf_intern_shard_reserve(owf_intern_t *intern, owf_error_t *error, owf_intern_shard_t *shard) {
+    owf_intern_table_t *old_table = shard->table, *new_table;
+    uint32_t capacity;
+
+    if (old_table == NULL) {
+        capacity = OWF_INTERN_MIN_CAPACITY;
+    } else if (OWF_EXPECT((shard->count + 1) <= old_table->capacity / 2)) {
+        return true;
+    } else if (OWF_NOEXPECT(old_table->capacity > UINT32_MAX / 2)) {
+        OWF_ERROR_SET(error, "intern table is too big");
+        return false;
+    } else {
+        capacity = old_table->capacity * 2;
+    }
+
+    if (OWF_NOEXPECT((new_table = owf_intern_table_new(intern, error, capacity)) == NULL)) {
+        return false;
+    }
+
+    if (old_table != NULL) {
+        /* Rehash into the new table before anyone can see it */
+        const uint32_t mask = capacity - 1;
+        for (uint32_t i = 0; i < old_table->capacity; i++) {
+            owf_intern_entry_t *entry = old_table->slots[i];
+            if (entry != NULL) {
+                uint32_t idx = entry->hash & mask;
+                while (new_table->slots[idx] != NULL) {
+                    idx = (idx + 1) & mask;
+                }
+                new_table->slots[idx] = entry;
+            }
+        }
+
+        /* Readers may still be probing the old table, so keep it around */
+        old_table->next = shard->retired;
+        shard->retired = old_table;
+    }
+
+    OWF_ATOMIC_STORE_PTR(&shard->table, new_table);
+    return true;
+}
+
+/* Allocates an entry for a string.
+ * @intern The intern table
+ * @error The error context
+ * @hash The hash of the string
+ * @value The string
+ * @length The length of the string
+ *
+ * @return The entry, or NULL on failure
+ */
+static owf_intern_entry_t *owf_intern_entry_new(owf_intern_t *intern, owf_error_t *error, uint32_t hash, const char *value, uint32_t length) {
+    if (OWF_NOEXPECT((size_t)length > SIZE_MAX - sizeof(owf_intern_entry_t) - 1)) {
+        OWF_ERROR_SET(error, "interned string is too long");
+        return NULL;
+    }
+
+    owf_intern_entry_t *entry = owf_malloc(intern->alloc, error, sizeof(owf_intern_entry_t) + length + 1);
+    if (OWF_NOEXPECT(entry == NULL)) {
+        return NULL;
+    }
+
+    entry->hash = hash;
+    entry->length = length;
+    memcpy(entry->bytes, value, length);
+    entry->bytes[length] = 0;
+
+    owf_str_init(&entry->str);
+    owf_array_borrow(&entry->str.bytes, entry->bytes, length + 1);
+
+    /* Fill in the memoized sizes now, so every copy of the string starts with them */
+    uint32_t size;
+    owf_str_length(&entry->str);
+    if (OWF_NOEXPECT(!owf_str_size(&entry->str, error, &size))) {
+        owf_free(intern->alloc, entry);
+        return NULL;
+    }
+
+    return entry;
+}
+
+void owf_intern_init(owf_intern_t *intern, owf_alloc_t *alloc) {
+    intern->alloc = alloc;
+    for (uint32_t i = 0; i < OWF_INTERN_SHARDS; i++) {
+        owf_intern_shard_t *shard = &intern->shards[i];
+        owf_mutex_init(&shard->lock);
+        shard->table = NULL;
+        shard->retired = NULL;
+        shard->count = 0;
+    }
+}
+
+const owf_str_t *owf_intern_get(owf_intern_t *intern, owf_error_t *error, const char *value, uint32_t length) {
+    if (OWF_NOEXPECT(length == 0)) {
+        OWF_ERROR_SET(error, "can't intern an empty string");
+        return NULL;
+    }
+
+    const uint32_t hash = owf_intern_hash(value, length);
+    owf_intern_shard_t *shard = &intern->shards[hash >> (32 - OWF_INTERN_SHARD_BITS)];
+    owf_intern_entry_t *entry;
+    uint32_t slot;
+
+    /* The common case: the string is already there */
+    if (OWF_EXPECT((entry = owf_intern_probe(OWF_ATOMIC_LOAD_PTR(&shard->table), hash, value, length, NULL)) != NULL)) {
+        return &entry->str;
+    }
+
+    owf_mutex_lock(&shard->lock);
+
+    /* Someone else may have added it, or grown the table, since we looked */
+    if ((entry = owf_intern_probe(shard->table, hash, value, length, NULL)) == NULL &&
+            owf_intern_shard_reserve(intern, error, shard) &&
+            (entry = owf_intern_entry_new(intern, error, hash, value, length)) != NULL) {
+        /* Reserving guarantees an empty slot, so this won't find the string */
+        owf_intern_probe(shard->table, hash, value, length, &slot);
+        OWF_ATOMIC_STORE_PTR(&shard->table->slots[slot], entry);
+        shard->count++;
+    }
+
+    owf_mutex_unlock(&shard->lock);
+    return entry == NULL ? NULL : &entry->str;
+}
+
+uint32_t owf_intern_count(owf_intern_t *intern) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < OWF_INTERN_SHARDS; i++) {
+        owf_intern_shard_t *shard = &intern->shards[i];
+        owf_mutex_lock(&shard->lock);
+        count += shard->count;
+        owf_mutex_unlock(&shard->lock);
+    }
+    return count;
+}
+
+void owf_intern_destroy(owf_intern_t *intern) {
+    for (uint32_t i = 0; i < OWF_INTERN_SHARDS; i++) {
+        owf_intern_shard_t *shard = &intern->shards[i];
+        owf_intern_table_t *table = shard->table, *next;
+
+        if (table != NULL) {
+            for (uint32_t j = 0; j < table->capacity; j++) {
+                owf_free(intern->alloc, table->slots[j]);
+            }
+            owf_free(intern->alloc, table);
+        }
+
+        for (table = shard->retired; table != NULL; table = next) {
+            next = table->next;
+            owf_free(intern->alloc, table);
+        }
+
+        shard->table = NULL;
+        shard->retired = NULL;
+        shard->count = 0;
+        owf_mutex_destroy(&shard->lock);
+    }
+}
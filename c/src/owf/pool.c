@@ -0,0 +1,305 @@
+#include <owf/pool.h>
+#include <owf/platform.h>
+
+/* The header before each block, holding the block's usable size. */
+#define OWF_POOL_HEADER_SIZE OWF_ALLOC_DEFAULT_ALIGN
+
+/* The header at the start of each slab, holding the next older slab. */
+#define OWF_POOL_SLAB_HEADER_SIZE OWF_ALLOC_DEFAULT_ALIGN
+
+/* The usable size of each size class. */
+static const size_t owf_pool_class_sizes[OWF_POOL_CLASSES] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, OWF_POOL_MAX_CLASS_SIZE
+};
+
+/* Finds the smallest size class an allocation fits in.
+ * @size The size of the allocation, which must be at most <OWF_POOL_MAX_CLASS_SIZE>
+ *
+ * @return The size class
+ */
+static uint32_t owf_pool_class(size_t size) {
+    uint32_t cls = 0;
+    while (owf_pool_class_sizes[cls] < size) {
+        cls++;
+    }
+    return cls;
+}
+
+/* Returns the usable size stored in a block's header.
+ * @ptr The block
+ *
+ * @return The usable size
+ */
+static size_t owf_pool_block_size(void *ptr) {
+    size_t size;
+    memcpy(&size, (uint8_t *)ptr - OWF_POOL_HEADER_SIZE, sizeof(size));
+    return size;
+}
+
+/* Pops a block off a free list.
+ * @list The list, which mustn't be empty
+ *
+ * @return The block
+ */
+static void *owf_pool_list_pop(owf_pool_list_t *list) {
+    void *ptr = list->head;
+    memcpy(&list->head, ptr, sizeof(void *));
+    list->count--;
+    return ptr;
+}
+
+/* Pushes a block onto a free list.
+ * @list The list
+ * @ptr The block
+ */
+static void owf_pool_list_push(owf_pool_list_t *list, void *ptr) {
+    memcpy(ptr, &list->head, sizeof(void *));
+    list->head = ptr;
+    list->count++;
+}
+
+/* Takes a block of a size class from a pool, carving a new one if none are free. The pool must be locked.
+ * @pool The pool
+ * @cls The size class
+ *
+ * @return The block, or NULL if a new slab was needed and couldn't be allocated
+ */
+static void *owf_pool_take(owf_pool_t *pool, uint32_t cls) {
+    const size_t size = owf_pool_class_sizes[cls], stride = OWF_POOL_HEADER_SIZE + size;
+    uint8_t *ptr;
+
+    if (pool->free[cls].head != NULL) {
+        return owf_pool_list_pop(&pool->free[cls]);
+    }
+
+    if ((size_t)(pool->carve[cls].end - pool->carve[cls].next) < stride) {
+        /* Start a new slab for this class; whatever was left of the last one is too small to use */
+        owf_error_t error = OWF_ERROR_DEFAULT;
+        uint8_t *slab = owf_malloc(pool->parent, &error, pool->slab_size);
+        if (OWF_NOEXPECT(slab == NULL)) {
+            return NULL;
+        }
+        memcpy(slab, &pool->slabs, sizeof(void *));
+        pool->slabs = slab;
+        pool->slab_count++;
+        pool->carve[cls].next = slab + OWF_POOL_SLAB_HEADER_SIZE;
+        pool->carve[cls].end = slab + pool->slab_size;
+    }
+
+    ptr = pool->carve[cls].next + OWF_POOL_HEADER_SIZE;
+    memcpy(ptr - OWF_POOL_HEADER_SIZE, &size, sizeof(size));
+    pool->carve[cls].next += stride;
+    return ptr;
+}
+
+/* Moves up to `count` blocks of a size class from a list to another, locking the pool.
+ * @pool The pool
+ * @from The list to take from, or NULL to take from the pool, carving blocks if needed
+ * @to The list to give to
+ * @cls The size class
+ * @count The number of blocks
+ */
+static void owf_pool_move(owf_pool_t *pool, owf_pool_list_t *from, owf_pool_list_t *to, uint32_t cls, uint32_t count) {
+    owf_mutex_lock(&pool->lock);
+    for (uint32_t i = 0; i < count; i++) {
+        void *ptr;
+        if (from != NULL) {
+            if (from->head == NULL) {
+                break;
+            }
+            ptr = owf_pool_list_pop(from);
+        } else if ((ptr = owf_pool_take(pool, cls)) == NULL) {
+            break;
+        }
+        owf_pool_list_push(to, ptr);
+    }
+    owf_mutex_unlock(&pool->lock);
+}
+
+/* Allocates a block from a pool.
+ * @pool The pool
+ * @cache The calling magazine's free lists, or NULL to go to the pool directly
+ * @size The size of the allocation
+ * @align The alignment
+ *
+ * @return The block, or NULL on failure
+ */
+static void *owf_pool_malloc(owf_pool_t *pool, owf_pool_list_t *cache, size_t size, size_t align) {
+    uint32_t cls;
+    uint8_t *ptr;
+
+    if (OWF_NOEXPECT(align > OWF_ALLOC_DEFAULT_ALIGN)) {
+        return NULL;
+    } else if (size > OWF_POOL_MAX_CLASS_SIZE) {
+        /* Too big to pool; give it a header anyway, so it can be told apart when it's freed */
+        owf_error_t error = OWF_ERROR_DEFAULT;
+        if (OWF_NOEXPECT((ptr = owf_malloc(pool->parent, &error, OWF_POOL_HEADER_SIZE + size)) == NULL)) {
+            return NULL;
+        }
+        memcpy(ptr, &size, sizeof(size));
+        return ptr + OWF_POOL_HEADER_SIZE;
+    }
+
+    cls = owf_pool_class(size);
+    if (cache == NULL) {
+        owf_mutex_lock(&pool->lock);
+        ptr = owf_pool_take(pool, cls);
+        owf_mutex_unlock(&pool->lock);
+        return ptr;
+    } else if (cache[cls].head == NULL) {
+        owf_pool_move(pool, NULL, &cache[cls], cls, OWF_POOL_MAGAZINE_SIZE / 2);
+        if (OWF_NOEXPECT(cache[cls].head == NULL)) {
+            return NULL;
+        }
+    }
+    return owf_pool_list_pop(&cache[cls]);
+}
+
+/* Frees a block allocated from a pool.
+ * @pool The pool
+ * @cache The calling magazine's free lists, or NULL to go to the pool directly
+ * @ptr The block
+ */
+static void owf_pool_free(owf_pool_t *pool, owf_pool_list_t *cache, void *ptr) {
+    const size_t size = owf_pool_block_size(ptr);
+    uint32_t cls;
+
+    if (size > OWF_POOL_MAX_CLASS_SIZE) {
+        owf_free_sized(pool->parent, (uint8_t *)ptr - OWF_POOL_HEADER_SIZE, OWF_POOL_HEADER_SIZE + size);
+        return;
+    }
+
+    cls = owf_pool_class(size);
+    if (cache == NULL) {
+        owf_mutex_lock(&pool->lock);
+        owf_pool_list_push(&pool->free[cls], ptr);
+        owf_mutex_unlock(&pool->lock);
+        return;
+    }
+
+    owf_pool_list_push(&cache[cls], ptr);
+    if (cache[cls].count > OWF_POOL_MAGAZINE_SIZE) {
+        owf_pool_move(pool, &cache[cls], &pool->free[cls], cls, OWF_POOL_MAGAZINE_SIZE / 2);
+    }
+}
+
+/* Resizes a block allocated from a pool.
+ * @pool The pool
+ * @cache The calling magazine's free lists, or NULL to go to the pool directly
+ * @ptr The block
+ * @size The new size
+ * @align The alignment
+ *
+ * @return The resized block, or NULL on failure
+ */
+static void *owf_pool_realloc(owf_pool_t *pool, owf_pool_list_t *cache, void *ptr, size_t size, size_t align) {
+    const size_t old_size = owf_pool_block_size(ptr);
+    void *ret;
+
+    if (size <= old_size) {
+        /* It already fits */
+        return ptr;
+    } else if (old_size > OWF_POOL_MAX_CLASS_SIZE) {
+        /* Large blocks can be resized by the parent */
+        owf_error_t error = OWF_ERROR_DEFAULT;
+        ret = (uint8_t *)ptr - OWF_POOL_HEADER_SIZE;
+        if (OWF_NOEXPECT(!owf_realloc_sized(pool->parent, &error, &ret, OWF_POOL_HEADER_SIZE + old_size, OWF_POOL_HEADER_SIZE + size))) {
+            return NULL;
+        }
+        memcpy(ret, &size, sizeof(size));
+        return (uint8_t *)ret + OWF_POOL_HEADER_SIZE;
+    } else if (OWF_NOEXPECT((ret = owf_pool_malloc(pool, cache, size, align)) == NULL)) {
+        return NULL;
+    }
+
+    memcpy(ret, ptr, old_size);
+    owf_pool_free(pool, cache, ptr);
+    return ret;
+}
+
+static void *owf_pool_malloc_cb(void *ctx, size_t size, size_t align) {
+    return owf_pool_malloc((owf_pool_t *)ctx, NULL, size, align);
+}
+
+static void *owf_pool_realloc_cb(void *ctx, void *ptr, size_t old_size, size_t size, size_t align) {
+    (void)old_size;
+    return owf_pool_realloc((owf_pool_t *)ctx, NULL, ptr, size, align);
+}
+
+static void owf_pool_free_cb(void *ctx, void *ptr, size_t size) {
+    (void)size;
+    owf_pool_free((owf_pool_t *)ctx, NULL, ptr);
+}
+
+static void *owf_pool_magazine_malloc_cb(void *ctx, size_t size, size_t align) {
+    owf_pool_magazine_t *magazine = (owf_pool_magazine_t *)ctx;
+    return owf_pool_malloc(magazine->pool, magazine->free, size, align);
+}
+
+static void *owf_pool_magazine_realloc_cb(void *ctx, void *ptr, size_t old_size, size_t size, size_t align) {
+    owf_pool_magazine_t *magazine = (owf_pool_magazine_t *)ctx;
+    (void)old_size;
+    return owf_pool_realloc(magazine->pool, magazine->free, ptr, size, align);
+}
+
+static void owf_pool_magazine_free_cb(void *ctx, void *ptr, size_t size) {
+    owf_pool_magazine_t *magazine = (owf_pool_magazine_t *)ctx;
+    (void)size;
+    owf_pool_free(magazine->pool, magazine->free, ptr);
+}
+
+/* The callbacks behind every pool's allocator. */
+static const owf_alloc_vtable_t owf_pool_vtable = {
+    .malloc = owf_pool_malloc_cb,
+    .realloc = owf_pool_realloc_cb,
+    .free = owf_pool_free_cb
+};
+
+/* The callbacks behind every magazine's allocator. */
+static const owf_alloc_vtable_t owf_pool_magazine_vtable = {
+    .malloc = owf_pool_magazine_malloc_cb,
+    .realloc = owf_pool_magazine_realloc_cb,
+    .free = owf_pool_magazine_free_cb
+};
+
+void owf_pool_init(owf_pool_t *pool, owf_alloc_t *parent, size_t slab_size) {
+    const size_t min_slab_size = OWF_POOL_SLAB_HEADER_SIZE + OWF_POOL_HEADER_SIZE + OWF_POOL_MAX_CLASS_SIZE;
+    const size_t max_alloc = parent->max_alloc > OWF_POOL_HEADER_SIZE ? parent->max_alloc - OWF_POOL_HEADER_SIZE : 0;
+
+    owf_alloc_init_vtable(&pool->alloc, &owf_pool_vtable, pool, max_alloc);
+    owf_mutex_init(&pool->lock);
+    pool->parent = parent;
+    pool->slabs = NULL;
+    pool->slab_size = slab_size > 0 ? slab_size : OWF_POOL_DEFAULT_SLAB_SIZE;
+    pool->slab_size = OWF_MAX(pool->slab_size, min_slab_size);
+    pool->slab_count = 0;
+    memset(pool->free, 0, sizeof(pool->free));
+    memset(pool->carve, 0, sizeof(pool->carve));
+}
+
+void owf_pool_destroy(owf_pool_t *pool) {
+    while (pool->slabs != NULL) {
+        void *next;
+        memcpy(&next, pool->slabs, sizeof(void *));
+        owf_free_sized(pool->parent, pool->slabs, pool->slab_size);
+        pool->slabs = next;
+    }
+    pool->slab_count = 0;
+    memset(pool->free, 0, sizeof(pool->free));
+    memset(pool->carve, 0, sizeof(pool->carve));
+    owf_mutex_destroy(&pool->lock);
+}
+
+void owf_pool_magazine_init(owf_pool_magazine_t *magazine, owf_pool_t *pool) {
+    owf_alloc_init_vtable(&magazine->alloc, &owf_pool_magazine_vtable, magazine, pool->alloc.max_alloc);
+    magazine->pool = pool;
+    memset(magazine->free, 0, sizeof(magazine->free));
+}
+
+void owf_pool_magazine_flush(owf_pool_magazine_t *magazine) {
+    for (uint32_t cls = 0; cls < OWF_POOL_CLASSES; cls++) {
+        if (magazine->free[cls].head != NULL) {
+            owf_pool_move(magazine->pool, &magazine->free[cls], &magazine->pool->free[cls], cls, magazine->free[cls].count);
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#include <owf/projection.h>
+
+void owf_projection_init(owf_projection_t *projection) {
+    owf_projection_set_init(&projection->channels, NULL, 0, false);
+    owf_projection_set_init(&projection->namespaces, NULL, 0, false);
+    owf_projection_set_init(&projection->signals, NULL, 0, false);
+    projection->flags = 0;
+}
+
+void owf_projection_set_init(owf_projection_set_t *set, const char *const *ids, uint32_t count, bool prefix) {
+    set->ids = ids;
+    set->count = count;
+    set->prefix = prefix;
+}
+
+bool owf_projection_set_match(const owf_projection_set_t *set, const char *id, size_t length) {
+    if (set == NULL || set->count == 0) {
+        return true;
+    }
+
+    length = strnlen(id, length);
+    for (uint32_t i = 0; i < set->count; i++) {
+        const size_t wanted = strlen(set->ids[i]);
+        if ((set->prefix ? wanted <= length : wanted == length) && memcmp(set->ids[i], id, wanted) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -5,6 +5,7 @@ void owf_reader_init(owf_reader_t *reader, owf_alloc_t *alloc, owf_error_t *erro
     reader->alloc = alloc;
     reader->error = error;
     reader->read = read;
+    reader->seek = NULL;
     reader->visit = visitor;
     reader->data = data;
 }
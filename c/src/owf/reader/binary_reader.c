@@ -1,7 +1,18 @@
 #include <owf/reader/binary.h>
 #include <owf/platform.h>
+#include <owf/byteswap.h>
+#include <owf/thread.h>
+
+#include <errno.h>
+
+#if OWF_PLATFORM_IS_GNU
+    #include <sys/stat.h>
+#endif
 
 /* Performs a safe read. Returns false from the caller on error.
+ *
+ * Buffer sources take an inline fast path: the current segment was already checked
+ * against the bytes left in the buffer, so only the segment length needs checking.
  *
  * @_binary The reader
  * @_ptr A pointer to a buffer to store the data
@@ -9,8 +20,16 @@
  */
 #define OWF_BINARY_SAFE_READ(_binary, _ptr, _length) \
     do { \
-        /* Length of zero is a no-op */ \
-        if (OWF_NOEXPECT(_length > 0 && !_binary->reader.read(_ptr, _length, _binary->reader.data))) { \
+        if (OWF_EXPECT(_binary->buffer != NULL)) { \
+            if (OWF_NOEXPECT((uint32_t)(_length) > _binary->segment_length)) { \
+                OWF_ERROR_SETF(_binary->reader.error, "read past end of segment (" OWF_PRINT_U32 " bytes, " OWF_PRINT_U32 " left)", (uint32_t)(_length), _binary->segment_length); \
+                return false; \
+            } \
+            memcpy(_ptr, (uint8_t *)_binary->buffer->ptr + _binary->buffer->position, _length); \
+            _binary->buffer->position += (_length); \
+            _binary->segment_length -= (uint32_t)(_length); \
+        } else if (OWF_NOEXPECT(_length > 0 && !_binary->reader.read(_ptr, _length, _binary->reader.data))) { \
+            /* Length of zero is a no-op */ \
             OWF_ERROR_SETF(_binary->reader.error, "read error (" OWF_PRINT_U32 " bytes)", (uint32_t)_length); \
             return false; \
         } else { \
@@ -33,24 +52,49 @@
         \
         /* Length of zero is a no-op */ \
         if (OWF_EXPECT(__effective_length > 0)) { \
-            if (!owf_array_reserve_exactly((&(_arr)), _binary->reader.alloc, _binary->reader.error, __effective_length, 1)) { \
+            if (OWF_NOEXPECT(_binary->buffer != NULL && (_len) > _binary->segment_length)) { \
+                /* Check before allocating, so bogus lengths never reach the allocator */ \
+                OWF_ERROR_SETF(_binary->reader.error, "variable read past end of segment (" OWF_PRINT_U32 " bytes, " OWF_PRINT_U32 " left)", (uint32_t)(_len), _binary->segment_length); \
+                return false; \
+            } else if ((&(_arr))->capacity < __effective_length / (_elem_size) && \
+                       !owf_array_reserve_exactly((&(_arr)), _binary->reader.alloc, _binary->reader.error, __effective_length / (_elem_size), _elem_size)) { \
                 return false; \
             } \
             (&(_arr))->length = __effective_length / (_elem_size); \
             \
-            if (OWF_NOEXPECT(!_binary->reader.read((&(_arr))->ptr, _len, _binary->reader.data))) { \
+            if (OWF_EXPECT(_binary->buffer != NULL)) { \
+                memcpy((&(_arr))->ptr, (uint8_t *)_binary->buffer->ptr + _binary->buffer->position, _len); \
+                _binary->buffer->position += (_len); \
+                _binary->segment_length -= (_len); \
+            } else if (OWF_NOEXPECT(!_binary->reader.read((&(_arr))->ptr, _len, _binary->reader.data))) { \
                 OWF_ERROR_SETF(_binary->reader.error, "variable read error (" OWF_PRINT_U32 " bytes into buffer of length " OWF_PRINT_U32 ")", (uint32_t)_len, (uint32_t)__effective_length); \
                 owf_array_destroy((&(_arr)), _binary->reader.alloc); \
+                owf_array_init((&(_arr))); \
                 return false; \
             } else { \
                 if (OWF_NOEXPECT(!owf_arith_safe_sub32(_binary->segment_length, _len, &_binary->segment_length, _binary->reader.error))) { \
                     owf_array_destroy((&(_arr)), _binary->reader.alloc); \
+                    owf_array_init((&(_arr))); \
                     return false; \
                 } \
             } \
         } \
     } while (0)
 
+/* Ensures that the current segment fits in the rest of the buffer, for buffer sources.
+ * Returns false from the caller on error.
+ *
+ * @_binary The reader
+ */
+#define OWF_BINARY_READER_BOUND(_binary) \
+    do { \
+        if (OWF_NOEXPECT(_binary->buffer != NULL && _binary->segment_length > _binary->buffer->length - _binary->buffer->position)) { \
+            OWF_ERROR_SETF(_binary->reader.error, "segment length (" OWF_PRINT_U32 " bytes) is longer than the rest of the buffer (" OWF_PRINT_SIZE " bytes)", \
+                _binary->segment_length, _binary->buffer->length - _binary->buffer->position); \
+            return false; \
+        } \
+    } while (0)
+
 /* Calls the visitor callback. Returns from the caller if we should skip.
  *
  * @_binary The reader
@@ -68,6 +112,15 @@
 void owf_binary_reader_init(owf_binary_reader_t *binary, owf_alloc_t *alloc, owf_error_t *error, owf_read_cb_t read, owf_visit_cb_t visitor, void *data) {
     owf_reader_init(&binary->reader, alloc, error, read, visitor, data);
     binary->segment_length = binary->skip_length = 0;
+    binary->buffer = binary->borrow = NULL;
+    binary->feed.state = OWF_BINARY_FEED_PACKAGE;
+    binary->feed.want = binary->feed.package_left = binary->feed.channel_left = 0;
+    owf_array_init(&binary->feed.scratch);
+    binary->projection = NULL;
+    binary->intern = NULL;
+    binary->block = NULL;
+    binary->reuse.enabled = false;
+    binary->reuse.open = 0;
 }
 
 static bool owf_binary_reader_file_read_cb(void *dest, const size_t size, void *data) {
@@ -75,10 +128,74 @@ static bool owf_binary_reader_file_read_cb(void *dest, const size_t size, void *
     return fread(dest, sizeof(uint8_t), size, ptr) == size;
 }
 
+static bool owf_binary_reader_file_seek_cb(const size_t size, void *data) {
+    FILE *ptr = (FILE *)data;
+    if (size == 0) {
+        return true;
+    } else if (size > LONG_MAX || fseek(ptr, (long)(size - 1), SEEK_CUR) != 0) {
+        return false;
+    } else if (fgetc(ptr) == EOF) {
+        /* Seeking past the end of a file succeeds, so make sure the last skipped byte is there, and let the read fail if it isn't */
+        clearerr(ptr);
+        fseek(ptr, -(long)(size - 1), SEEK_CUR);
+        return false;
+    }
+    return true;
+}
+
 void owf_binary_reader_init_file(owf_binary_reader_t *binary, FILE *file, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor) {
-    owf_reader_init(&binary->reader, alloc, error, owf_binary_reader_file_read_cb, visitor, file);
+    owf_binary_reader_init(binary, alloc, error, owf_binary_reader_file_read_cb, visitor, file);
+    binary->reader.seek = owf_binary_reader_file_seek_cb;
+}
+
+#if OWF_PLATFORM_IS_GNU
+static bool owf_binary_reader_fd_read_cb(void *dest, const size_t size, void *data) {
+    owf_binary_fd_t *src = (owf_binary_fd_t *)data;
+    uint8_t *ptr = (uint8_t *)dest;
+    size_t left = size;
+    ssize_t ret;
+
+    while (left > 0) {
+        ret = src->seekable ? pread(src->fd, ptr, left, (off_t)src->offset) : read(src->fd, ptr, left);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        } else if (ret <= 0) {
+            /* Error or premature EOF */
+            return false;
+        }
+
+        ptr += ret;
+        left -= (size_t)ret;
+        if (src->seekable) {
+            src->offset += ret;
+        }
+    }
+    return true;
+}
+
+static bool owf_binary_reader_fd_seek_cb(const size_t size, void *data) {
+    owf_binary_fd_t *src = (owf_binary_fd_t *)data;
+    if (!src->seekable || (src->size >= 0 && (int64_t)size > src->size - src->offset)) {
+        /* Let the read fail instead of seeking past the end of the file */
+        return false;
+    }
+    src->offset += (int64_t)size;
+    return true;
 }
 
+void owf_binary_reader_init_fd(owf_binary_reader_t *binary, int fd, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor) {
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+    struct stat st;
+
+    owf_binary_reader_init(binary, alloc, error, owf_binary_reader_fd_read_cb, visitor, &binary->fd);
+    binary->reader.seek = owf_binary_reader_fd_seek_cb;
+    binary->fd.fd = fd;
+    binary->fd.seekable = offset >= 0;
+    binary->fd.offset = offset >= 0 ? (int64_t)offset : 0;
+    binary->fd.size = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) ? (int64_t)st.st_size : -1;
+}
+#endif
+
 static bool owf_binary_reader_buffer_read_cb(void *dest, const size_t size, void *data) {
     owf_buffer_t *ptr = (owf_buffer_t *)data;
     size_t new_position = ptr->position + size;
@@ -94,18 +211,549 @@ static bool owf_binary_reader_buffer_read_cb(void *dest, const size_t size, void
 }
 
 void owf_binary_reader_init_buffer(owf_binary_reader_t *binary, owf_buffer_t *buf, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor) {
-    owf_reader_init(&binary->reader, alloc, error, owf_binary_reader_buffer_read_cb, visitor, buf);
+    owf_binary_reader_init(binary, alloc, error, owf_binary_reader_buffer_read_cb, visitor, buf);
+    binary->buffer = buf;
 }
 
-bool owf_binary_read(owf_binary_reader_t *binary) {
+void owf_binary_reader_init_buffer_borrowed(owf_binary_reader_t *binary, owf_buffer_t *buf, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor) {
+    owf_binary_reader_init_buffer(binary, buf, alloc, error, visitor);
+    binary->borrow = buf;
+}
+
+/* Points an array at the next `length` bytes of the borrowed buffer and consumes them.
+ * @binary The reader
+ * @arr The array
+ * @length The number of bytes to borrow
+ * @width The element width
+ *
+ * @return Whether the borrow was successful
+ */
+static bool owf_binary_reader_borrow(owf_binary_reader_t *binary, owf_array_t *arr, uint32_t length, uint32_t width) {
+    owf_buffer_t *buf = binary->borrow;
+
+    /* The segment was bounded by the buffer when it was unwrapped */
+    OWF_ARITH_SAFE_SUB32(binary->reader.error, binary->segment_length, length);
+    owf_array_borrow(arr, (uint8_t *)buf->ptr + buf->position, length / width);
+    buf->position += length;
+    return true;
+}
+
+/* Empties an array before it's read into, keeping its allocation if the reader is reusing its package.
+ * @binary The reader
+ * @arr The array
+ */
+static void owf_binary_reader_recycle(owf_binary_reader_t *binary, owf_array_t *arr) {
+    if (OWF_EXPECT(!binary->reuse.enabled)) {
+        owf_array_init(arr);
+    } else if (binary->borrow != NULL || binary->block != NULL || OWF_ARRAY_BORROWED(*arr)) {
+        /* It's about to be pointed somewhere else, or it's pointing somewhere we can't write to */
+        owf_array_destroy(arr, binary->reader.alloc);
+        owf_array_init(arr);
+    } else {
+        arr->length = 0;
+    }
+}
+
+/* Empties a string before it's read into, keeping its allocation if the reader is reusing its package.
+ * @binary The reader
+ * @str The string
+ */
+static void owf_binary_reader_recycle_str(owf_binary_reader_t *binary, owf_str_t *str) {
+    owf_memoize_init(&str->string_size);
+    owf_memoize_init(&str->total_size);
+    if (OWF_STR_INLINE(*str)) {
+        /* Nothing to free or keep */
+        owf_array_init(&str->bytes);
+    } else {
+        owf_binary_reader_recycle(binary, &str->bytes);
+    }
+}
+
+/* Destroys the nodes of an array past a count, keeping the array itself.
+ * @_arr The array
+ * @_count The number of nodes to keep
+ * @_type The node type
+ * @_destroy The node destructor
+ * @_alloc The allocator
+ */
+#define OWF_BINARY_REUSE_TRIM(_arr, _count, _type, _destroy, _alloc) \
+    do { \
+        while (OWF_ARRAY_LEN(_arr) > (_count)) { \
+            OWF_ARRAY_LEN(_arr)--; \
+            _destroy(OWF_ARRAY_PTR(_arr, _type, OWF_ARRAY_LEN(_arr)), _alloc); \
+        } \
+    } while (0)
+
+/* Takes the node at an index out of an array, leaving an empty node in its place, or initializes
+ * a new node if the array isn't that long.
+ * @_arr The array
+ * @_idx The index
+ * @_node A pointer to the node to fill
+ * @_type The node type
+ * @_init The node initializer
+ */
+#define OWF_BINARY_REUSE_TAKE(_arr, _idx, _node, _type, _init) \
+    do { \
+        if ((_idx) < OWF_ARRAY_LEN(_arr)) { \
+            *(_node) = *OWF_ARRAY_PTR(_arr, _type, _idx); \
+            _init(OWF_ARRAY_PTR(_arr, _type, _idx)); \
+            owf_memoize_init(&(_node)->memoize); \
+        } else { \
+            _init(_node); \
+        } \
+    } while (0)
+
+/* Puts a node back at an index of an array, appending it if the array isn't that long.
+ * Returns false from the caller if the append fails.
+ * @_binary The reader
+ * @_arr The array
+ * @_idx The index
+ * @_node A pointer to the node
+ * @_type The node type
+ */
+#define OWF_BINARY_REUSE_PUT(_binary, _arr, _idx, _node, _type) \
+    do { \
+        if ((_idx) < OWF_ARRAY_LEN(_arr)) { \
+            *OWF_ARRAY_PTR(_arr, _type, _idx) = *(_node); \
+        } else if (OWF_NOEXPECT(!owf_array_push(&(_arr), (_binary)->reader.alloc, (_binary)->reader.error, _node, sizeof(_type)))) { \
+            return false; \
+        } \
+    } while (0)
+
+/* Returns the channel being written to a reused package.
+ * @_binary The reader
+ */
+#define OWF_BINARY_REUSE_CHANNEL(_binary) \
+    OWF_ARRAY_PTR((_binary)->reader.ctx.owf.channels, owf_channel_t, (_binary)->reuse.channels - 1)
+
+/* Returns the namespace being written to a reused package.
+ * @_binary The reader
+ */
+#define OWF_BINARY_REUSE_NAMESPACE(_binary) \
+    OWF_ARRAY_PTR(OWF_BINARY_REUSE_CHANNEL(_binary)->namespaces, owf_namespace_t, (_binary)->reuse.namespaces - 1)
+
+/* Destroys the leftover children of the namespace being written to a reused package.
+ * @binary The reader
+ */
+static void owf_binary_reader_reuse_trim_namespace(owf_binary_reader_t *binary) {
+    owf_namespace_t *ns = OWF_BINARY_REUSE_NAMESPACE(binary);
+    OWF_BINARY_REUSE_TRIM(ns->signals, binary->reuse.signals, owf_signal_t, owf_signal_destroy, binary->reader.alloc);
+    OWF_BINARY_REUSE_TRIM(ns->events, binary->reuse.events, owf_event_t, owf_event_destroy, binary->reader.alloc);
+    OWF_BINARY_REUSE_TRIM(ns->alarms, binary->reuse.alarms, owf_alarm_t, owf_alarm_destroy, binary->reader.alloc);
+}
+
+/* Destroys the leftover children of the channel being written to a reused package.
+ * @binary The reader
+ */
+static void owf_binary_reader_reuse_trim_channel(owf_binary_reader_t *binary) {
+    owf_channel_t *channel = OWF_BINARY_REUSE_CHANNEL(binary);
+    if (binary->reuse.namespaces > 0) {
+        owf_binary_reader_reuse_trim_namespace(binary);
+    }
+    OWF_BINARY_REUSE_TRIM(channel->namespaces, binary->reuse.namespaces, owf_namespace_t, owf_namespace_destroy, binary->reader.alloc);
+}
+
+/* Starts reading a package, resetting the reused one if the reader has one.
+ * @binary The reader
+ */
+static void owf_binary_reader_begin(owf_binary_reader_t *binary) {
+    if (OWF_EXPECT(!binary->reuse.enabled)) {
+        owf_package_init(&binary->reader.ctx.owf);
+        return;
+    }
+
+    owf_package_reset(&binary->reader.ctx.owf);
+    binary->reuse.open = 0;
+    binary->reuse.channels = binary->reuse.namespaces = 0;
+    binary->reuse.signals = binary->reuse.events = binary->reuse.alarms = 0;
+}
+
+/* Finishes reading a package into a reused one, destroying nodes left over from the last packet.
+ * @binary The reader
+ */
+static void owf_binary_reader_finish(owf_binary_reader_t *binary) {
+    if (binary->reuse.enabled) {
+        if (binary->reuse.channels > 0) {
+            owf_binary_reader_reuse_trim_channel(binary);
+        }
+        OWF_BINARY_REUSE_TRIM(binary->reader.ctx.owf.channels, binary->reuse.channels, owf_channel_t, owf_channel_destroy, binary->reader.alloc);
+    }
+}
+
+/* Cleans up after a failed read into a reused package, which is destroyed, along with any nodes taken out of it.
+ * @binary The reader
+ */
+static void owf_binary_reader_abort(owf_binary_reader_t *binary) {
+    owf_reader_ctx_t *ctx = &binary->reader.ctx;
+
+    if (OWF_EXPECT(!binary->reuse.enabled)) {
+        return;
+    }
+
+    if (binary->reuse.open & (1 << OWF_READ_CHANNEL)) {
+        owf_channel_destroy(&ctx->channel, binary->reader.alloc);
+    }
+    if (binary->reuse.open & (1 << OWF_READ_NAMESPACE)) {
+        owf_namespace_destroy(&ctx->ns, binary->reader.alloc);
+    }
+    if (binary->reuse.open & (1 << OWF_READ_SIGNAL)) {
+        owf_signal_destroy(&ctx->signal, binary->reader.alloc);
+    }
+    if (binary->reuse.open & (1 << OWF_READ_EVENT)) {
+        owf_event_destroy(&ctx->event, binary->reader.alloc);
+    }
+    if (binary->reuse.open & (1 << OWF_READ_ALARM)) {
+        owf_alarm_destroy(&ctx->alarm, binary->reader.alloc);
+    }
+    owf_package_destroy(&ctx->owf, binary->reader.alloc);
+    owf_binary_reader_begin(binary);
+    owf_package_init(&ctx->owf);
+}
+
+/* Gets a node ready to be read. Readers reusing their package take the node that's about to be
+ * overwritten out of the package, along with everything it has allocated.
+ * @binary The reader
+ * @type The type of node
+ * @ptr A pointer to the node
+ */
+static void owf_binary_reader_prime(owf_binary_reader_t *binary, owf_reader_cb_type_t type, void *ptr) {
     owf_package_t *owf = &binary->reader.ctx.owf;
-    uint32_t magic = 0, length;
 
-    /* Initialize the owf_package_t */
-    owf_package_init(owf);
+    if (OWF_EXPECT(!binary->reuse.enabled)) {
+        switch (type) {
+            case OWF_READ_CHANNEL: owf_channel_init((owf_channel_t *)ptr); break;
+            case OWF_READ_NAMESPACE: owf_namespace_init((owf_namespace_t *)ptr); break;
+            case OWF_READ_SIGNAL: owf_signal_init((owf_signal_t *)ptr); break;
+            case OWF_READ_EVENT: owf_event_init((owf_event_t *)ptr); break;
+            case OWF_READ_ALARM: owf_alarm_init((owf_alarm_t *)ptr); break;
+        }
+        return;
+    }
+
+    binary->reuse.open |= 1 << type;
+    switch (type) {
+        case OWF_READ_CHANNEL:
+            if (binary->reuse.channels > 0) {
+                owf_binary_reader_reuse_trim_channel(binary);
+            }
+            OWF_BINARY_REUSE_TAKE(owf->channels, binary->reuse.channels, (owf_channel_t *)ptr, owf_channel_t, owf_channel_init);
+            break;
+        case OWF_READ_NAMESPACE:
+            if (binary->reuse.namespaces > 0) {
+                owf_binary_reader_reuse_trim_namespace(binary);
+            }
+            OWF_BINARY_REUSE_TAKE(OWF_BINARY_REUSE_CHANNEL(binary)->namespaces, binary->reuse.namespaces, (owf_namespace_t *)ptr, owf_namespace_t, owf_namespace_init);
+            break;
+        case OWF_READ_SIGNAL:
+            OWF_BINARY_REUSE_TAKE(OWF_BINARY_REUSE_NAMESPACE(binary)->signals, binary->reuse.signals, (owf_signal_t *)ptr, owf_signal_t, owf_signal_init);
+            break;
+        case OWF_READ_EVENT:
+            OWF_BINARY_REUSE_TAKE(OWF_BINARY_REUSE_NAMESPACE(binary)->events, binary->reuse.events, (owf_event_t *)ptr, owf_event_t, owf_event_init);
+            break;
+        case OWF_READ_ALARM:
+            OWF_BINARY_REUSE_TAKE(OWF_BINARY_REUSE_NAMESPACE(binary)->alarms, binary->reuse.alarms, (owf_alarm_t *)ptr, owf_alarm_t, owf_alarm_init);
+            break;
+    }
+}
+
+/* Puts a node back into a reused package.
+ * @binary The reader
+ * @type The type of node
+ * @ptr A pointer to the node
+ * @keep Whether the node was read; skipped nodes go back where they came from so that they can be reused later
+ *
+ * @return Whether the node could be put back
+ */
+static bool owf_binary_reader_reuse_put(owf_binary_reader_t *binary, owf_reader_cb_type_t type, void *ptr, bool keep) {
+    owf_package_t *owf = &binary->reader.ctx.owf;
+
+    switch (type) {
+        case OWF_READ_CHANNEL:
+            if (keep || binary->reuse.channels < OWF_ARRAY_LEN(owf->channels)) {
+                OWF_BINARY_REUSE_PUT(binary, owf->channels, binary->reuse.channels, (owf_channel_t *)ptr, owf_channel_t);
+            } else {
+                owf_channel_destroy((owf_channel_t *)ptr, binary->reader.alloc);
+            }
+            if (keep) {
+                binary->reuse.channels++;
+                binary->reuse.namespaces = 0;
+            }
+            break;
+        case OWF_READ_NAMESPACE: {
+            owf_channel_t *channel = OWF_BINARY_REUSE_CHANNEL(binary);
+            if (keep || binary->reuse.namespaces < OWF_ARRAY_LEN(channel->namespaces)) {
+                OWF_BINARY_REUSE_PUT(binary, channel->namespaces, binary->reuse.namespaces, (owf_namespace_t *)ptr, owf_namespace_t);
+            } else {
+                owf_namespace_destroy((owf_namespace_t *)ptr, binary->reader.alloc);
+            }
+            if (keep) {
+                binary->reuse.namespaces++;
+                binary->reuse.signals = binary->reuse.events = binary->reuse.alarms = 0;
+            }
+            break;
+        }
+        case OWF_READ_SIGNAL: {
+            owf_namespace_t *ns = OWF_BINARY_REUSE_NAMESPACE(binary);
+            if (keep || binary->reuse.signals < OWF_ARRAY_LEN(ns->signals)) {
+                OWF_BINARY_REUSE_PUT(binary, ns->signals, binary->reuse.signals, (owf_signal_t *)ptr, owf_signal_t);
+            } else {
+                owf_signal_destroy((owf_signal_t *)ptr, binary->reader.alloc);
+            }
+            binary->reuse.signals += keep;
+            break;
+        }
+        case OWF_READ_EVENT:
+            OWF_BINARY_REUSE_PUT(binary, OWF_BINARY_REUSE_NAMESPACE(binary)->events, binary->reuse.events, (owf_event_t *)ptr, owf_event_t);
+            binary->reuse.events++;
+            break;
+        case OWF_READ_ALARM:
+            OWF_BINARY_REUSE_PUT(binary, OWF_BINARY_REUSE_NAMESPACE(binary)->alarms, binary->reuse.alarms, (owf_alarm_t *)ptr, owf_alarm_t);
+            binary->reuse.alarms++;
+            break;
+    }
+    binary->reuse.open &= ~(uint32_t)(1 << type);
+    return true;
+}
+
+/* Gives up on a node that isn't being read, putting it back into a reused package.
+ * @binary The reader
+ * @type The type of node
+ * @ptr A pointer to the node
+ *
+ * @return Whether the node could be put back
+ */
+static bool owf_binary_reader_unprime(owf_binary_reader_t *binary, owf_reader_cb_type_t type, void *ptr) {
+    return OWF_EXPECT(!binary->reuse.enabled) || owf_binary_reader_reuse_put(binary, type, ptr, false);
+}
+
+/* A visitor callback that materializes nodes into a reused package.
+ * @reader The reader, which is the first member of an <owf_binary_reader_t>
+ * @ctx The context
+ * @type The type currently being read
+ * @ptr Unused
+ *
+ * @return Whether to recurse
+ */
+static bool owf_binary_reader_reuse_cb(owf_reader_t *reader, owf_reader_ctx_t *ctx, owf_reader_cb_type_t type, void *ptr) {
+    void *node = NULL;
+
+    switch (type) {
+        case OWF_READ_CHANNEL: node = &ctx->channel; break;
+        case OWF_READ_NAMESPACE: node = &ctx->ns; break;
+        case OWF_READ_SIGNAL: node = &ctx->signal; break;
+        case OWF_READ_EVENT: node = &ctx->event; break;
+        case OWF_READ_ALARM: node = &ctx->alarm; break;
+    }
+    return owf_binary_reader_reuse_put((owf_binary_reader_t *)reader, type, node, true);
+}
+
+void owf_binary_reader_reuse(owf_binary_reader_t *binary) {
+    if (!binary->reuse.enabled) {
+        binary->reuse.enabled = true;
+        owf_package_init(&binary->reader.ctx.owf);
+        owf_binary_reader_begin(binary);
+    }
+    binary->reader.visit = owf_binary_reader_reuse_cb;
+}
+
+/* Starts a package over without reusing it, for readers that build packages some other way.
+ * @binary The reader
+ */
+static void owf_binary_reader_drop(owf_binary_reader_t *binary) {
+    if (binary->reuse.enabled) {
+        owf_package_destroy(&binary->reader.ctx.owf, binary->reader.alloc);
+        owf_binary_reader_begin(binary);
+    }
+    owf_package_init(&binary->reader.ctx.owf);
+}
+
+void owf_binary_reader_set_projection(owf_binary_reader_t *binary, const owf_projection_t *projection) {
+    binary->projection = projection;
+}
+
+void owf_binary_reader_set_intern(owf_binary_reader_t *binary, owf_intern_t *intern) {
+    binary->intern = intern;
+}
+
+/* Points a string at its canonical copy in the reader's intern table.
+ * @binary The reader
+ * @str The string
+ * @bytes The bytes read for the string, which must be NUL-terminated and not empty
+ * @length The number of bytes
+ *
+ * @return Whether the string was interned
+ */
+static bool owf_binary_reader_intern(owf_binary_reader_t *binary, owf_str_t *str, const char *bytes, uint32_t length) {
+    const owf_str_t *canonical = owf_intern_get(binary->intern, binary->reader.error, bytes, (uint32_t)strnlen(bytes, length));
+    if (OWF_NOEXPECT(canonical == NULL)) {
+        return false;
+    }
+
+    owf_binary_reader_recycle_str(binary, str);
+    owf_str_destroy(str, binary->reader.alloc);
+    *str = *canonical;
+    return true;
+}
+
+/* Returns a projection set from the reader's projection, or NULL if it has none.
+ * @_binary The reader
+ * @_set The set's field name
+ */
+#define OWF_BINARY_READER_PROJECTION_SET(_binary, _set) \
+    ((_binary)->projection != NULL ? &(_binary)->projection->_set : NULL)
+
+/* A node ID being checked against a projection set. */
+typedef struct owf_binary_reader_id {
+    /* Where to store the ID if it's kept */
+    owf_str_t *str;
+
+    /* The set to check against */
+    const owf_projection_set_t *set;
+
+    /* Whether the ID was kept */
+    bool keep;
+} owf_binary_reader_id_t;
+
+/* Reads a node ID if it's in a projection set, and skips it otherwise, without allocating for skipped IDs.
+ * @binary The reader
+ * @ptr A pointer to an <owf_binary_reader_id_t>
+ *
+ * @return Whether the read was successful
+ */
+static bool owf_binary_reader_read_id(owf_binary_reader_t *binary, void *ptr) {
+    owf_binary_reader_id_t *id = (owf_binary_reader_id_t *)ptr;
+    const uint32_t length = binary->segment_length;
+    const char *bytes;
+
+    if (binary->buffer != NULL) {
+        /* Check it in place; the segment was bounded by the buffer when it was unwrapped */
+        bytes = (const char *)binary->buffer->ptr + binary->buffer->position;
+    } else if (length <= sizeof(binary->skip)) {
+        /* Stage it in the skip buffer */
+        OWF_BINARY_SAFE_READ(binary, binary->skip, length);
+        bytes = binary->skip;
+    } else {
+        /* Too long to stage, so check a copy */
+        if (OWF_NOEXPECT(!owf_binary_reader_read_str(binary, id->str))) {
+            return false;
+        } else if (!(id->keep = owf_projection_set_match(id->set, OWF_STR_PTR(*id->str), OWF_ARRAY_LEN(id->str->bytes)))) {
+            owf_str_destroy(id->str, binary->reader.alloc);
+            owf_str_init(id->str);
+        } else if (binary->intern != NULL && owf_str_length(id->str) > 0) {
+            /* Swap the copy for the canonical string */
+            const owf_str_t *canonical = owf_intern_get(binary->intern, binary->reader.error, OWF_STR_PTR(*id->str), owf_str_length(id->str));
+            owf_str_destroy(id->str, binary->reader.alloc);
+            if (OWF_NOEXPECT(canonical == NULL)) {
+                owf_str_init(id->str);
+                return false;
+            }
+            *id->str = *canonical;
+        }
+        return true;
+    }
+
+    if (OWF_NOEXPECT(length > 0 && bytes[length - 1] != 0)) {
+        OWF_ERROR_SET(binary->reader.error, "string was not NULL-terminated");
+        return false;
+    }
+
+    if (!(id->keep = owf_projection_set_match(id->set, bytes, length))) {
+        /* Step over it; staged IDs have already been consumed */
+        binary->skip_length = binary->segment_length;
+        return true;
+    } else if (binary->intern != NULL && length > 0 && bytes[0] != 0) {
+        /* Use the canonical copy, stepping over IDs checked in place */
+        if (binary->buffer != NULL) {
+            binary->skip_length = binary->segment_length;
+        }
+        return owf_binary_reader_intern(binary, id->str, bytes, length);
+    } else if (binary->buffer != NULL) {
+        return owf_binary_reader_read_str(binary, id->str);
+    }
+
+    /* Copy the staged ID */
+    owf_binary_reader_recycle_str(binary, id->str);
+    if (length > 0) {
+        if (id->str->bytes.ptr == NULL && length <= OWF_STR_INLINE_SIZE) {
+            memcpy(id->str->small.bytes, bytes, length);
+            id->str->small.tag = OWF_STR_INLINE_TAG;
+        } else if (OWF_NOEXPECT(id->str->bytes.capacity < length && !owf_array_reserve_exactly(&id->str->bytes, binary->reader.alloc, binary->reader.error, length, sizeof(uint8_t)))) {
+            return false;
+        } else {
+            memcpy(id->str->bytes.ptr, bytes, length);
+            OWF_ARRAY_LEN(id->str->bytes) = length;
+        }
+    }
+    return true;
+}
+
+/* Reads a string, using its canonical copy if the reader has an intern table.
+ * @binary The reader
+ * @ptr A pointer to an <owf_str_t>
+ *
+ * @return Whether the read was successful
+ */
+static bool owf_binary_reader_read_interned(owf_binary_reader_t *binary, void *ptr) {
+    owf_binary_reader_id_t id;
+
+    if (OWF_EXPECT(binary->intern == NULL)) {
+        return owf_binary_reader_read_str(binary, ptr);
+    }
+
+    id.str = (owf_str_t *)ptr;
+    id.set = NULL;
+    id.keep = false;
+    return owf_binary_reader_read_id(binary, &id);
+}
+
+/* Unwraps a node ID, checking it against a projection set if the reader has a projection.
+ * @binary The reader
+ * @str Where to store the ID
+ * @set The projection set, or NULL
+ * @keep A pointer to a bool to store whether the node should be read
+ *
+ * @return Whether the read was successful
+ */
+static bool owf_binary_reader_unwrap_id(owf_binary_reader_t *binary, owf_str_t *str, const owf_projection_set_t *set, bool *keep) {
+    owf_binary_reader_id_t id;
+
+    if (OWF_EXPECT(binary->projection == NULL)) {
+        *keep = true;
+        return owf_binary_reader_unwrap(binary, owf_binary_reader_read_interned, str);
+    }
+
+    id.str = str;
+    id.set = set;
+    id.keep = false;
+    if (OWF_NOEXPECT(!owf_binary_reader_unwrap(binary, owf_binary_reader_read_id, &id))) {
+        return false;
+    }
+    *keep = id.keep;
+    return true;
+}
+
+/* Skips a whole segment.
+ * @binary The reader
+ * @ptr Unused
+ *
+ * @return Always true
+ */
+static bool owf_binary_reader_skip_segment(owf_binary_reader_t *binary, void *ptr) {
+    binary->skip_length = binary->segment_length;
+    return true;
+}
+
+/* Reads a package after its context has been set up.
+ * @binary The reader
+ *
+ * @return Whether the read was successful
+ */
+static bool owf_binary_reader_read_package(owf_binary_reader_t *binary) {
+    uint32_t magic = 0, length;
 
     /* Read the implicitly-sized header */
     binary->segment_length = sizeof(magic);
+    OWF_BINARY_READER_BOUND(binary);
     OWF_BINARY_SAFE_READ(binary, &magic, sizeof(magic));
     OWF_HOST32(magic);
 
@@ -117,12 +765,24 @@ bool owf_binary_read(owf_binary_reader_t *binary) {
 
     /* Reset the segment length again, and start walking the tree */
     binary->segment_length = sizeof(length);
+    OWF_BINARY_READER_BOUND(binary);
     return owf_binary_reader_unwrap_top(binary, owf_binary_reader_read_channels, &length, &binary->reader.ctx.channel);
 }
 
+bool owf_binary_read(owf_binary_reader_t *binary) {
+    /* Initialize the owf_package_t, or get ready to overwrite it */
+    owf_binary_reader_begin(binary);
+    if (OWF_NOEXPECT(!owf_binary_reader_read_package(binary))) {
+        owf_binary_reader_abort(binary);
+        return false;
+    }
+    owf_binary_reader_finish(binary);
+    return true;
+}
+
 owf_package_t *owf_binary_materialize(owf_binary_reader_t *binary) {
     owf_visit_cb_t old_cb = binary->reader.visit;
-    binary->reader.visit = owf_reader_materialize_cb;
+    binary->reader.visit = binary->reuse.enabled ? owf_binary_reader_reuse_cb : owf_reader_materialize_cb;
     if (OWF_NOEXPECT(!owf_binary_read(binary))) {
         return NULL;
     }
@@ -130,13 +790,945 @@ owf_package_t *owf_binary_materialize(owf_binary_reader_t *binary) {
     return &binary->reader.ctx.owf;
 }
 
+/* State for <owf_binary_validate>. */
+typedef struct owf_binary_reader_validation {
+    /* The stats being collected */
+    owf_binary_stats_t *stats;
+
+    /* The bounds of the current namespace */
+    owf_time_t t0;
+    owf_duration_t dt;
+} owf_binary_reader_validation_t;
+
+/* Checks a string without copying it.
+ * @binary The reader
+ * @ptr A pointer to an <owf_binary_reader_validation_t>
+ *
+ * @return Whether the string was valid
+ */
+static bool owf_binary_reader_validate_str(owf_binary_reader_t *binary, void *ptr) {
+    owf_binary_reader_validation_t *validation = (owf_binary_reader_validation_t *)ptr;
+    const uint32_t length = binary->segment_length;
+    char last = 0;
+
+    if (length == 0) {
+        return true;
+    } else if (binary->buffer != NULL) {
+        /* Check it in place; the segment was bounded by the buffer when it was unwrapped */
+        last = ((const char *)binary->buffer->ptr)[binary->buffer->position + length - 1];
+        binary->skip_length = length;
+    } else {
+        /* Stream it through the skip buffer, keeping the last byte */
+        while (binary->segment_length > 0) {
+            const uint32_t to_read = OWF_MIN(binary->segment_length, sizeof(binary->skip));
+            OWF_BINARY_SAFE_READ(binary, binary->skip, to_read);
+            last = binary->skip[to_read - 1];
+        }
+    }
+
+    if (OWF_NOEXPECT(last != 0)) {
+        OWF_ERROR_SET(binary->reader.error, "string was not NULL-terminated");
+        return false;
+    }
+    validation->stats->string_bytes += length;
+    if (length <= OWF_STR_INLINE_SIZE) {
+        validation->stats->inline_string_bytes += length;
+    }
+    return true;
+}
+
+/* Checks a sample array without copying it.
+ * @binary The reader
+ * @ptr A pointer to an <owf_binary_reader_validation_t>
+ *
+ * @return Whether the samples were valid
+ */
+static bool owf_binary_reader_validate_samples(owf_binary_reader_t *binary, void *ptr) {
+    owf_binary_reader_validation_t *validation = (owf_binary_reader_validation_t *)ptr;
+    const uint32_t length = binary->segment_length;
+
+    if (OWF_NOEXPECT(length % sizeof(double) != 0)) {
+        OWF_ERROR_SETF(binary->reader.error, "length of sample array is not " OWF_PRINT_SIZE "-byte aligned (got " OWF_PRINT_U32 " bytes)", sizeof(double), length);
+        return false;
+    }
+    validation->stats->samples += length / sizeof(double);
+    binary->skip_length = length;
+    return true;
+}
+
+/* Checks that a timestamp falls inside the current namespace.
+ * @binary The reader
+ * @validation The validation state
+ * @kind The kind of node, for the error message
+ * @t0 The timestamp
+ *
+ * @return Whether the timestamp was covered
+ */
+static bool owf_binary_reader_validate_covers(owf_binary_reader_t *binary, owf_binary_reader_validation_t *validation, const char *kind, owf_time_t t0) {
+    owf_namespace_t ns;
+
+    ns.t0 = validation->t0;
+    ns.dt = validation->dt;
+    if (OWF_NOEXPECT(!owf_namespace_covers(&ns, t0))) {
+        OWF_ERROR_SETF(binary->reader.error, "time interval for namespace [" OWF_PRINT_TIME ", " OWF_PRINT_TIME "):" OWF_PRINT_DURATION " did not cover %s at " OWF_PRINT_TIME,
+            ns.t0, ns.t0 + ns.dt, ns.dt, kind, t0);
+        return false;
+    }
+    return true;
+}
+
+/* Checks a signal.
+ * @binary The reader
+ * @ptr A pointer to an <owf_binary_reader_validation_t>
+ *
+ * @return Whether the signal was valid
+ */
+static bool owf_binary_reader_validate_signal(owf_binary_reader_t *binary, void *ptr) {
+    owf_binary_reader_validation_t *validation = (owf_binary_reader_validation_t *)ptr;
+    validation->stats->signals++;
+    return OWF_EXPECT(
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_str, ptr) &&
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_str, ptr) &&
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_samples, ptr));
+}
+
+/* Checks an event.
+ * @binary The reader
+ * @ptr A pointer to an <owf_binary_reader_validation_t>
+ *
+ * @return Whether the event was valid
+ */
+static bool owf_binary_reader_validate_event(owf_binary_reader_t *binary, void *ptr) {
+    owf_binary_reader_validation_t *validation = (owf_binary_reader_validation_t *)ptr;
+    owf_time_t t0;
+
+    OWF_BINARY_SAFE_READ(binary, &t0, sizeof(t0));
+    OWF_HOST64(t0);
+    if (OWF_NOEXPECT(!owf_binary_reader_validate_covers(binary, validation, "event", t0))) {
+        return false;
+    }
+    validation->stats->events++;
+    return owf_binary_reader_unwrap(binary, owf_binary_reader_validate_str, ptr);
+}
+
+/* Checks an alarm.
+ * @binary The reader
+ * @ptr A pointer to an <owf_binary_reader_validation_t>
+ *
+ * @return Whether the alarm was valid
+ */
+static bool owf_binary_reader_validate_alarm(owf_binary_reader_t *binary, void *ptr) {
+    owf_binary_reader_validation_t *validation = (owf_binary_reader_validation_t *)ptr;
+    owf_time_t t0;
+    uint8_t rest[sizeof(owf_duration_t) + sizeof(uint32_t)];
+
+    OWF_BINARY_SAFE_READ(binary, &t0, sizeof(t0));
+    OWF_HOST64(t0);
+    if (OWF_NOEXPECT(!owf_binary_reader_validate_covers(binary, validation, "alarm", t0))) {
+        return false;
+    }
+
+    /* The duration and details can't be invalid */
+    OWF_BINARY_SAFE_READ(binary, rest, sizeof(rest));
+    validation->stats->alarms++;
+    return OWF_EXPECT(
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_str, ptr) &&
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_str, ptr));
+}
+
+/* Checks each child in a run of signals, events, or alarms.
+ * @_name The name of the callback to define
+ * @_cb The callback for each child
+ */
+#define OWF_BINARY_READER_VALIDATE_MULTI(_name, _cb) \
+    static bool _name(owf_binary_reader_t *binary, void *ptr) { \
+        return owf_binary_reader_unwrap_multi(binary, _cb, ptr); \
+    }
+
+OWF_BINARY_READER_VALIDATE_MULTI(owf_binary_reader_validate_signals, owf_binary_reader_validate_signal)
+OWF_BINARY_READER_VALIDATE_MULTI(owf_binary_reader_validate_events, owf_binary_reader_validate_event)
+OWF_BINARY_READER_VALIDATE_MULTI(owf_binary_reader_validate_alarms, owf_binary_reader_validate_alarm)
+
+/* Checks a namespace.
+ * @binary The reader
+ * @ptr A pointer to an <owf_binary_reader_validation_t>
+ *
+ * @return Whether the namespace was valid
+ */
+static bool owf_binary_reader_validate_namespace(owf_binary_reader_t *binary, void *ptr) {
+    owf_binary_reader_validation_t *validation = (owf_binary_reader_validation_t *)ptr;
+
+    OWF_BINARY_SAFE_READ(binary, &validation->t0, sizeof(validation->t0));
+    OWF_HOST64(validation->t0);
+    OWF_BINARY_SAFE_READ(binary, &validation->dt, sizeof(validation->dt));
+    OWF_HOST64(validation->dt);
+    validation->stats->namespaces++;
+    return OWF_EXPECT(
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_str, ptr) &&
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_signals, ptr) &&
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_events, ptr) &&
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_alarms, ptr));
+}
+
+/* Checks a channel.
+ * @binary The reader
+ * @ptr A pointer to an <owf_binary_reader_validation_t>
+ *
+ * @return Whether the channel was valid
+ */
+static bool owf_binary_reader_validate_channel(owf_binary_reader_t *binary, void *ptr) {
+    owf_binary_reader_validation_t *validation = (owf_binary_reader_validation_t *)ptr;
+    validation->stats->channels++;
+    return OWF_EXPECT(
+        owf_binary_reader_unwrap(binary, owf_binary_reader_validate_str, ptr) &&
+        owf_binary_reader_unwrap_nested_multi(binary, owf_binary_reader_validate_namespace, ptr));
+}
+
+/* Checks each channel in a package.
+ * @binary The reader
+ * @ptr A pointer to an <owf_binary_reader_validation_t>
+ *
+ * @return Whether the channels were valid
+ */
+static bool owf_binary_reader_validate_channels(owf_binary_reader_t *binary, void *ptr) {
+    return owf_binary_reader_unwrap_nested_multi(binary, owf_binary_reader_validate_channel, ptr);
+}
+
+bool owf_binary_validate(owf_binary_reader_t *binary, owf_binary_stats_t *stats) {
+    owf_binary_stats_t local;
+    owf_binary_reader_validation_t validation;
+    uint32_t magic = 0, length;
+
+    validation.stats = stats != NULL ? stats : &local;
+    validation.t0 = validation.dt = 0;
+    memset(validation.stats, 0, sizeof(*validation.stats));
+
+    /* Read the implicitly-sized header, as in owf_binary_read */
+    binary->segment_length = sizeof(magic);
+    OWF_BINARY_READER_BOUND(binary);
+    OWF_BINARY_SAFE_READ(binary, &magic, sizeof(magic));
+    OWF_HOST32(magic);
+    if (OWF_NOEXPECT(magic != OWF_MAGIC)) {
+        OWF_ERROR_SETF(binary->reader.error, "invalid magic header: %#08x", magic);
+        return false;
+    }
+
+    binary->segment_length = sizeof(length);
+    OWF_BINARY_READER_BOUND(binary);
+    if (OWF_NOEXPECT(!owf_binary_reader_unwrap_top(binary, owf_binary_reader_validate_channels, &length, &validation))) {
+        return false;
+    }
+    validation.stats->length = (uint64_t)length + sizeof(magic);
+    return true;
+}
+
+/* The size of the header at the start of each block, which links to the next one. Keeps regions double-aligned. */
+#define OWF_BINARY_BLOCK_HEADER_SIZE OWF_MAX(sizeof(void *), sizeof(double))
+
+/* Rounds a region size up so that the next region stays double-aligned.
+ * @_size The size
+ */
+#define OWF_BINARY_BLOCK_ROUND(_size) (((uint64_t)(_size) + sizeof(double) - 1) & ~(uint64_t)(sizeof(double) - 1))
+
+/* Takes bytes from a region of the reader's block.
+ * @binary The reader
+ * @region The region
+ * @size The number of bytes
+ *
+ * @return A pointer to the bytes, or NULL if the region was exhausted
+ */
+static void *owf_binary_reader_block_take(owf_binary_reader_t *binary, owf_binary_block_region_t region, size_t size) {
+    uint8_t *ptr = binary->block->regions[region].next;
+    if (OWF_NOEXPECT(size > (size_t)(binary->block->regions[region].end - ptr))) {
+        OWF_ERROR_SETF(binary->reader.error, "block region exhausted (" OWF_PRINT_SIZE " bytes)", size);
+        return NULL;
+    }
+    binary->block->regions[region].next += size;
+    return ptr;
+}
+
+/* Copies the next `length` bytes of the buffer into the reader's block, and points an array at them.
+ * @binary The reader
+ * @arr The array
+ * @region The region to copy into
+ * @length The number of bytes
+ * @width The element width
+ *
+ * @return Whether the copy was successful
+ */
+static bool owf_binary_reader_block_read(owf_binary_reader_t *binary, owf_array_t *arr, owf_binary_block_region_t region, uint32_t length, uint32_t width) {
+    void *ptr;
+
+    if (length == 0) {
+        return true;
+    } else if (OWF_NOEXPECT(length > binary->segment_length)) {
+        OWF_ERROR_SETF(binary->reader.error, "variable read past end of segment (" OWF_PRINT_U32 " bytes, " OWF_PRINT_U32 " left)", length, binary->segment_length);
+        return false;
+    } else if (OWF_NOEXPECT((ptr = owf_binary_reader_block_take(binary, region, length)) == NULL)) {
+        return false;
+    }
+
+    /* Block reads are only done from buffers, which bound each segment */
+    memcpy(ptr, (uint8_t *)binary->buffer->ptr + binary->buffer->position, length);
+    binary->buffer->position += length;
+    binary->segment_length -= length;
+    owf_array_borrow(arr, ptr, length / width);
+    return true;
+}
+
+/* Appends a node to an array carved from a region of the reader's block. Returns false from the caller on error.
+ * @_binary The reader
+ * @_arr The array, which is always the last one carved from the region
+ * @_region The region
+ * @_node A pointer to the node to copy
+ * @_type The type of the node
+ */
+#define OWF_BINARY_BLOCK_APPEND(_binary, _arr, _region, _node, _type) \
+    do { \
+        _type *__slot = (_type *)owf_binary_reader_block_take(_binary, _region, sizeof(_type)); \
+        if (OWF_NOEXPECT(__slot == NULL)) { \
+            return false; \
+        } \
+        *__slot = *(_node); \
+        if (OWF_ARRAY_LEN(_arr) == 0) { \
+            owf_array_borrow(&(_arr), __slot, 0); \
+        } \
+        OWF_ARRAY_LEN(_arr)++; \
+    } while (0)
+
+/* A visitor callback that materializes nodes into the reader's block.
+ * @reader The reader, which is the first member of an <owf_binary_reader_t>
+ * @ctx The context
+ * @type The type currently being read
+ * @ptr Unused
+ *
+ * @return Whether to recurse
+ */
+static bool owf_binary_reader_materialize_block_cb(owf_reader_t *reader, owf_reader_ctx_t *ctx, owf_reader_cb_type_t type, void *ptr) {
+    owf_binary_reader_t *binary = (owf_binary_reader_t *)reader;
+    owf_package_t *owf = &ctx->owf;
+    owf_channel_t *channel;
+    owf_namespace_t *ns;
+
+    if (type == OWF_READ_CHANNEL) {
+        OWF_BINARY_BLOCK_APPEND(binary, owf->channels, OWF_BINARY_BLOCK_CHANNELS, &ctx->channel, owf_channel_t);
+        return true;
+    }
+
+    channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, OWF_ARRAY_LEN(owf->channels) - 1);
+    if (type == OWF_READ_NAMESPACE) {
+        OWF_BINARY_BLOCK_APPEND(binary, channel->namespaces, OWF_BINARY_BLOCK_NAMESPACES, &ctx->ns, owf_namespace_t);
+        return true;
+    }
+
+    ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, OWF_ARRAY_LEN(channel->namespaces) - 1);
+    switch (type) {
+        case OWF_READ_SIGNAL:
+            OWF_BINARY_BLOCK_APPEND(binary, ns->signals, OWF_BINARY_BLOCK_SIGNALS, &ctx->signal, owf_signal_t);
+            break;
+        case OWF_READ_EVENT:
+            OWF_BINARY_BLOCK_APPEND(binary, ns->events, OWF_BINARY_BLOCK_EVENTS, &ctx->event, owf_event_t);
+            break;
+        case OWF_READ_ALARM:
+            OWF_BINARY_BLOCK_APPEND(binary, ns->alarms, OWF_BINARY_BLOCK_ALARMS, &ctx->alarm, owf_alarm_t);
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+/* Allocates blocks for a package, packing as many regions into each one as the allocator allows.
+ * @binary The reader
+ * @block The block cursors to point at the regions
+ * @sizes The size of each region
+ * @head A pointer to store the first block in
+ *
+ * @return Whether the allocation was successful
+ */
+static bool owf_binary_reader_block_alloc(owf_binary_reader_t *binary, owf_binary_block_t *block, const uint64_t *sizes, void **head) {
+    void **tail = head;
+    uint32_t first = 0;
+
+    *head = NULL;
+    while (first < OWF_BINARY_BLOCK_REGIONS) {
+        uint64_t total = OWF_BINARY_BLOCK_HEADER_SIZE;
+        uint32_t last = first;
+        uint8_t *ptr;
+
+        /* Always take at least one region, then as many more as fit */
+        do {
+            total += sizes[last++];
+        } while (last < OWF_BINARY_BLOCK_REGIONS && total + sizes[last] <= binary->reader.alloc->max_alloc);
+
+        if (OWF_NOEXPECT(total > SIZE_MAX)) {
+            OWF_ERROR_SETF(binary->reader.error, "block too large (" OWF_PRINT_U64 " bytes)", total);
+            ptr = NULL;
+        } else {
+            ptr = (uint8_t *)owf_malloc(binary->reader.alloc, binary->reader.error, (size_t)total);
+        }
+        if (OWF_NOEXPECT(ptr == NULL)) {
+            while (*head != NULL) {
+                void *next = *(void **)*head;
+                owf_free(binary->reader.alloc, *head);
+                *head = next;
+            }
+            return false;
+        }
+
+        /* Link it in, and point the regions at it */
+        *(void **)ptr = NULL;
+        *tail = ptr;
+        tail = (void **)ptr;
+        ptr += OWF_BINARY_BLOCK_HEADER_SIZE;
+        for (; first < last; first++) {
+            block->regions[first].next = ptr;
+            ptr += sizes[first];
+            block->regions[first].end = ptr;
+        }
+    }
+    return true;
+}
+
+owf_package_t *owf_binary_materialize_block(owf_binary_reader_t *binary) {
+    owf_package_t *owf = &binary->reader.ctx.owf;
+    owf_visit_cb_t old_cb = binary->reader.visit;
+    owf_binary_stats_t stats;
+    owf_binary_block_t block;
+    uint64_t sizes[OWF_BINARY_BLOCK_REGIONS];
+    void *blocks;
+    size_t start;
+    bool ok, reuse;
+
+    if (binary->buffer == NULL) {
+        return owf_binary_materialize(binary);
+    }
+
+    /* Count everything, then rewind */
+    start = binary->buffer->position;
+    if (OWF_NOEXPECT(!owf_binary_validate(binary, &stats))) {
+        binary->buffer->position = start;
+        return NULL;
+    }
+    binary->buffer->position = start;
+
+    sizes[OWF_BINARY_BLOCK_CHANNELS] = OWF_BINARY_BLOCK_ROUND((uint64_t)stats.channels * sizeof(owf_channel_t));
+    sizes[OWF_BINARY_BLOCK_NAMESPACES] = OWF_BINARY_BLOCK_ROUND((uint64_t)stats.namespaces * sizeof(owf_namespace_t));
+    sizes[OWF_BINARY_BLOCK_SIGNALS] = OWF_BINARY_BLOCK_ROUND((uint64_t)stats.signals * sizeof(owf_signal_t));
+    sizes[OWF_BINARY_BLOCK_EVENTS] = OWF_BINARY_BLOCK_ROUND((uint64_t)stats.events * sizeof(owf_event_t));
+    sizes[OWF_BINARY_BLOCK_ALARMS] = OWF_BINARY_BLOCK_ROUND((uint64_t)stats.alarms * sizeof(owf_alarm_t));
+    sizes[OWF_BINARY_BLOCK_SAMPLES] = stats.samples * sizeof(double);
+    sizes[OWF_BINARY_BLOCK_STRINGS] = stats.string_bytes - stats.inline_string_bytes;
+    if (OWF_NOEXPECT(!owf_binary_reader_block_alloc(binary, &block, sizes, &blocks))) {
+        return NULL;
+    }
+
+    /* Decode into the blocks, starting over if the reader was reusing its package */
+    owf_binary_reader_drop(binary);
+    reuse = binary->reuse.enabled;
+    binary->reuse.enabled = false;
+    binary->block = &block;
+    binary->reader.visit = owf_binary_reader_materialize_block_cb;
+    ok = owf_binary_read(binary);
+    binary->reader.visit = old_cb;
+    binary->block = NULL;
+    binary->reuse.enabled = reuse;
+
+    owf->blocks = blocks;
+    if (OWF_NOEXPECT(!ok)) {
+        owf_package_destroy(owf, binary->reader.alloc);
+        owf_package_init(owf);
+        binary->buffer->position = start;
+        return NULL;
+    }
+    return owf;
+}
+
+/* A run of channels decoded by one thread of <owf_binary_materialize_parallel>. */
+typedef struct owf_binary_reader_worker {
+    /* The worker's reader, which materializes into its own package */
+    owf_binary_reader_t binary;
+
+    /* The part of the parent buffer holding the run */
+    owf_buffer_t buf;
+
+    /* The worker's error context */
+    owf_error_t error;
+
+    /* The thread, if one was started */
+    owf_thread_t thread;
+    bool started;
+
+    /* Whether the run was decoded */
+    bool ok;
+} owf_binary_reader_worker_t;
+
+static void owf_binary_reader_worker_run(void *ptr) {
+    owf_binary_reader_worker_t *worker = (owf_binary_reader_worker_t *)ptr;
+    owf_binary_reader_t *binary = &worker->binary;
+
+    owf_package_init(&binary->reader.ctx.owf);
+    binary->segment_length = (uint32_t)worker->buf.length;
+    worker->ok = owf_binary_reader_read_channels(binary, &binary->reader.ctx.channel);
+}
+
+/* Finds the start of each channel in a package without decoding anything.
+ * @binary The reader
+ * @base The first channel
+ * @length The length of all channels
+ * @offsets An array to store the offset of each channel from `base` in, followed by `length`
+ *
+ * @return Whether the scan was successful
+ */
+static bool owf_binary_reader_scan_channels(owf_binary_reader_t *binary, const uint8_t *base, uint32_t length, owf_array_t *offsets) {
+    uint32_t position = 0, channel_length;
+
+    while (position < length) {
+        if (OWF_NOEXPECT(length - position < sizeof(channel_length))) {
+            OWF_ERROR_SETF(binary->reader.error, "trailing data when reading segment: " OWF_PRINT_U32 " bytes", length - position);
+            return false;
+        }
+
+        memcpy(&channel_length, base + position, sizeof(channel_length));
+        OWF_HOST32(channel_length);
+        if (OWF_NOEXPECT(channel_length % sizeof(uint32_t) != 0)) {
+            OWF_ERROR_SETF(binary->reader.error, "length was not " OWF_PRINT_SIZE "-byte aligned (got " OWF_PRINT_U32 " bytes)", sizeof(uint32_t), channel_length);
+            return false;
+        } else if (OWF_NOEXPECT(channel_length > length - position - sizeof(channel_length))) {
+            OWF_ERROR_SETF(binary->reader.error, "segment (" OWF_PRINT_U32 " bytes) is longer than its parent (" OWF_PRINT_U32 " bytes left)", channel_length, (uint32_t)(length - position - sizeof(channel_length)));
+            return false;
+        } else if (OWF_NOEXPECT(!owf_array_push(offsets, binary->reader.alloc, binary->reader.error, &position, sizeof(position)))) {
+            return false;
+        }
+        position += channel_length + sizeof(channel_length);
+    }
+
+    return owf_array_push(offsets, binary->reader.alloc, binary->reader.error, &position, sizeof(position));
+}
+
+owf_package_t *owf_binary_materialize_parallel(owf_binary_reader_t *binary, uint32_t nthreads, owf_alloc_t *const *allocs) {
+    owf_package_t *owf = &binary->reader.ctx.owf, *part;
+    owf_alloc_t *alloc = binary->reader.alloc;
+    owf_buffer_t *buf = binary->buffer;
+    owf_binary_reader_worker_t *workers = NULL;
+    owf_array_t offsets;
+    uint32_t header[2], nchannels, nworkers = 0, total = 0, first, last = 0;
+    const uint8_t *base;
+    bool ok = false;
+
+    if (OWF_NOEXPECT(nthreads == 0 && allocs != NULL)) {
+        OWF_ERROR_SET(binary->reader.error, "per-thread allocators need an explicit thread count");
+        return NULL;
+    } else if (nthreads == 0) {
+        nthreads = owf_thread_count();
+    }
+    if (buf == NULL || nthreads < 2) {
+        return owf_binary_materialize(binary);
+    }
+
+    owf_binary_reader_drop(binary);
+    owf_array_init(&offsets);
+
+    /* Read the magic and length in place; nothing is consumed until the whole package is read */
+    if (OWF_NOEXPECT(buf->length - buf->position < sizeof(header))) {
+        OWF_ERROR_SETF(binary->reader.error, "segment length (" OWF_PRINT_SIZE " bytes) is longer than the rest of the buffer (" OWF_PRINT_SIZE " bytes)",
+            sizeof(header), buf->length - buf->position);
+        return NULL;
+    }
+    memcpy(header, (uint8_t *)buf->ptr + buf->position, sizeof(header));
+    OWF_HOST32(header[0]);
+    OWF_HOST32(header[1]);
+
+    if (OWF_NOEXPECT(header[0] != OWF_MAGIC)) {
+        OWF_ERROR_SETF(binary->reader.error, "invalid magic header: %#08x", header[0]);
+        return NULL;
+    } else if (OWF_NOEXPECT(header[1] % sizeof(uint32_t) != 0)) {
+        OWF_ERROR_SETF(binary->reader.error, "length was not " OWF_PRINT_SIZE "-byte aligned (got " OWF_PRINT_U32 " bytes)", sizeof(uint32_t), header[1]);
+        return NULL;
+    } else if (OWF_NOEXPECT(header[1] > buf->length - buf->position - sizeof(header))) {
+        OWF_ERROR_SETF(binary->reader.error, "segment length (" OWF_PRINT_U32 " bytes) is longer than the rest of the buffer (" OWF_PRINT_SIZE " bytes)",
+            header[1], buf->length - buf->position - sizeof(header));
+        return NULL;
+    }
+
+    base = (const uint8_t *)buf->ptr + buf->position + sizeof(header);
+    if (OWF_NOEXPECT(!owf_binary_reader_scan_channels(binary, base, header[1], &offsets))) {
+        goto out;
+    }
+
+    /* Not worth splitting; decode it serially */
+    nchannels = OWF_ARRAY_LEN(offsets) - 1;
+    nworkers = OWF_MIN(nthreads, nchannels);
+    if (nworkers < 2) {
+        owf_array_destroy(&offsets, alloc);
+        return owf_binary_materialize(binary);
+    }
+
+    if ((workers = owf_malloc(alloc, binary->reader.error, nworkers * sizeof(owf_binary_reader_worker_t))) == NULL) {
+        goto out;
+    }
+
+    /* Give each worker a contiguous run of channels ending near its share of the bytes, leaving at least one channel for each later worker */
+    for (uint32_t i = 0; i < nworkers; i++) {
+        owf_binary_reader_worker_t *worker = &workers[i];
+        owf_alloc_t *worker_alloc = allocs != NULL ? allocs[i] : alloc;
+        const uint32_t target = (uint32_t)(((uint64_t)header[1] * (i + 1)) / nworkers);
+
+        first = last++;
+        while (last < nchannels - (nworkers - i - 1) && OWF_ARRAY_GET(offsets, uint32_t, last + 1) <= target) {
+            last++;
+        }
+
+        owf_error_init(&worker->error);
+        owf_buffer_init(&worker->buf, (void *)(base + OWF_ARRAY_GET(offsets, uint32_t, first)),
+            OWF_ARRAY_GET(offsets, uint32_t, last) - OWF_ARRAY_GET(offsets, uint32_t, first));
+        if (binary->borrow != NULL) {
+            owf_binary_reader_init_buffer_borrowed(&worker->binary, &worker->buf, worker_alloc, &worker->error, owf_reader_materialize_cb);
+        } else {
+            owf_binary_reader_init_buffer(&worker->binary, &worker->buf, worker_alloc, &worker->error, owf_reader_materialize_cb);
+        }
+        owf_binary_reader_set_projection(&worker->binary, binary->projection);
+        owf_binary_reader_set_intern(&worker->binary, binary->intern);
+        worker->started = worker->ok = false;
+    }
+
+    /* Start the others, and decode the first run here. If a thread can't be started, decode its run here too. */
+    for (uint32_t i = 1; i < nworkers; i++) {
+        if (!(workers[i].started = owf_thread_create(&workers[i].thread, &workers[i].error, owf_binary_reader_worker_run, &workers[i]))) {
+            owf_error_init(&workers[i].error);
+        }
+    }
+    owf_binary_reader_worker_run(&workers[0]);
+    for (uint32_t i = 1; i < nworkers; i++) {
+        if (workers[i].started) {
+            owf_thread_join(&workers[i].thread);
+        } else {
+            owf_binary_reader_worker_run(&workers[i]);
+        }
+    }
+
+    /* Report the first error */
+    ok = true;
+    for (uint32_t i = 0; i < nworkers && ok; i++) {
+        if (OWF_NOEXPECT(!workers[i].ok)) {
+            *binary->reader.error = workers[i].error;
+            ok = false;
+        } else {
+            total += OWF_ARRAY_LEN(workers[i].binary.reader.ctx.owf.channels);
+        }
+    }
+
+    /* Stitch the channels together, in order */
+    if (ok && total > 0 && OWF_NOEXPECT(!owf_array_reserve_exactly(&owf->channels, alloc, binary->reader.error, total, sizeof(owf_channel_t)))) {
+        ok = false;
+    }
+    for (uint32_t i = 0; i < nworkers; i++) {
+        part = &workers[i].binary.reader.ctx.owf;
+        if (ok) {
+            if (OWF_ARRAY_LEN(part->channels) > 0) {
+                memcpy(OWF_ARRAY_PTR(owf->channels, owf_channel_t, OWF_ARRAY_LEN(owf->channels)), part->channels.ptr, OWF_ARRAY_LEN(part->channels) * sizeof(owf_channel_t));
+                OWF_ARRAY_LEN(owf->channels) += OWF_ARRAY_LEN(part->channels);
+            }
+            owf_array_destroy(&part->channels, workers[i].binary.reader.alloc);
+        } else {
+            owf_package_destroy(part, workers[i].binary.reader.alloc);
+        }
+    }
+
+    if (ok) {
+        buf->position += sizeof(header) + header[1];
+        binary->segment_length = 0;
+    }
+
+out:
+    owf_free_sized(alloc, workers, nworkers * sizeof(owf_binary_reader_worker_t));
+    owf_array_destroy(&offsets, alloc);
+    return ok ? owf : NULL;
+}
+
+void owf_binary_reader_init_feed(owf_binary_reader_t *binary, owf_alloc_t *alloc, owf_error_t *error, owf_visit_cb_t visitor) {
+    owf_binary_reader_init(binary, alloc, error, NULL, visitor, NULL);
+    owf_package_init(&binary->reader.ctx.owf);
+}
+
+void owf_binary_reader_destroy(owf_binary_reader_t *binary) {
+    owf_array_destroy(&binary->feed.scratch, binary->reader.alloc);
+    owf_array_init(&binary->feed.scratch);
+    if (binary->reuse.enabled) {
+        owf_package_destroy(&binary->reader.ctx.owf, binary->reader.alloc);
+        owf_package_init(&binary->reader.ctx.owf);
+    }
+}
+
+/* Marks an incremental reader as failed and jumps to `out`.
+ *
+ * @_binary The reader
+ */
+#define OWF_BINARY_FEED_FAIL(_binary) \
+    do { \
+        owf_binary_reader_abort(_binary); \
+        (_binary)->feed.state = OWF_BINARY_FEED_FAILED; \
+        goto out; \
+    } while (0)
+
+/* Gathers the `want` bytes the current state needs.
+ * @binary The reader
+ * @ptr A pointer to the input pointer, which is advanced past consumed bytes
+ * @length A pointer to the input length, which is reduced by consumed bytes
+ * If the bytes arrived in one piece, they are used in place; otherwise, they are
+ * accumulated in the scratch buffer, which the caller must clear once it's done with them.
+ *
+ * @return A pointer to the bytes, or NULL if more input is needed or an error occurred
+ */
+static const uint8_t *owf_binary_reader_feed_take(owf_binary_reader_t *binary, const uint8_t **ptr, size_t *length) {
+    owf_binary_feed_t *feed = &binary->feed;
+    owf_array_t *scratch = &feed->scratch;
+    size_t needed;
+
+    /* Fast path: the whole segment is here */
+    if (OWF_EXPECT(scratch->length == 0 && *length >= feed->want)) {
+        const uint8_t *ret = *ptr;
+        *ptr += feed->want;
+        *length -= feed->want;
+        return ret;
+    }
+
+    if (*length == 0) {
+        return NULL;
+    }
+
+    /* Make room for the rest of the segment */
+    if (scratch->capacity < feed->want && OWF_NOEXPECT(!owf_array_reserve(scratch, binary->reader.alloc, binary->reader.error, feed->want, sizeof(uint8_t)))) {
+        feed->state = OWF_BINARY_FEED_FAILED;
+        return NULL;
+    }
+
+    /* Copy in as much as we can */
+    needed = OWF_MIN((size_t)(feed->want - scratch->length), *length);
+    if (needed > 0) {
+        memcpy((uint8_t *)scratch->ptr + scratch->length, *ptr, needed);
+        scratch->length += (uint32_t)needed;
+        *ptr += needed;
+        *length -= needed;
+    }
+
+    return scratch->length == feed->want ? (const uint8_t *)scratch->ptr : NULL;
+}
+
+/* Reads a length prefix without consuming it, so the whole segment can be taken afterwards.
+ * @binary The reader
+ * @ptr A pointer to the input pointer
+ * @length A pointer to the input length
+ * @value A pointer to a uint32_t to store the length in
+ *
+ * @return True if the length was read, false if more input is needed or an error occurred
+ */
+static bool owf_binary_reader_feed_peek(owf_binary_reader_t *binary, const uint8_t **ptr, size_t *length, uint32_t *value) {
+    const uint8_t *src = *ptr;
+
+    binary->feed.want = sizeof(uint32_t);
+    if (binary->feed.scratch.length > 0 || *length < sizeof(uint32_t)) {
+        /* Split across feeds; this leaves the prefix in the scratch buffer */
+        if ((src = owf_binary_reader_feed_take(binary, ptr, length)) == NULL) {
+            return false;
+        }
+    }
+
+    memcpy(value, src, sizeof(*value));
+    OWF_HOST32(*value);
+    if (OWF_NOEXPECT(*value % sizeof(uint32_t) != 0)) {
+        OWF_ERROR_SETF(binary->reader.error, "length was not " OWF_PRINT_SIZE "-byte aligned (got " OWF_PRINT_U32 " bytes)", sizeof(uint32_t), *value);
+        binary->feed.state = OWF_BINARY_FEED_FAILED;
+        return false;
+    }
+    return true;
+}
+
+/* Decodes a whole length-prefixed segment that's in memory, using the buffer reader.
+ * @binary The reader
+ * @ptr The segment, including its length prefix
+ * @length The length of the segment
+ * @cb The callback
+ * @data Data to pass to the callback
+ *
+ * @return Whether the decode was successful
+ */
+static bool owf_binary_reader_feed_unwrap(owf_binary_reader_t *binary, const uint8_t *ptr, uint32_t length, owf_binary_reader_cb_t cb, void *data) {
+    owf_buffer_t buf;
+    bool ret;
+
+    owf_buffer_init(&buf, (void *)ptr, length);
+    binary->buffer = &buf;
+    binary->segment_length = length;
+    ret = owf_binary_reader_unwrap(binary, cb, data);
+    binary->buffer = NULL;
+    binary->feed.scratch.length = 0;
+    return ret;
+}
+
+/* Checks a child segment against the bytes left in its parent, and subtracts it.
+ * @binary The reader
+ * @left A pointer to the bytes left in the parent
+ * @length The length of the child
+ *
+ * @return True if the child fits
+ */
+static bool owf_binary_reader_feed_fit(owf_binary_reader_t *binary, uint32_t *left, uint32_t length) {
+    if (OWF_NOEXPECT(length > *left)) {
+        OWF_ERROR_SETF(binary->reader.error, "segment (" OWF_PRINT_U32 " bytes) is longer than its parent (" OWF_PRINT_U32 " bytes left)", length, *left);
+        return false;
+    }
+    *left -= length;
+    return true;
+}
+
+owf_binary_feed_status_t owf_binary_reader_feed(owf_binary_reader_t *binary, const void *ptr, size_t length, size_t *consumed) {
+    owf_binary_feed_t *feed = &binary->feed;
+    owf_binary_feed_status_t status = OWF_BINARY_FEED_MORE;
+    const uint8_t *src = (const uint8_t *)ptr, *segment;
+    owf_binary_reader_id_t id;
+    uint32_t header[2], value;
+    size_t skip;
+
+    while (status == OWF_BINARY_FEED_MORE) {
+        switch (feed->state) {
+            case OWF_BINARY_FEED_PACKAGE:
+                if (OWF_EXPECT(!binary->reuse.enabled)) {
+                    /* The last package belongs to the caller now, so a bad header mustn't leave it to be destroyed again */
+                    owf_package_init(&binary->reader.ctx.owf);
+                }
+
+                /* Magic and package length */
+                feed->want = sizeof(header);
+                if ((segment = owf_binary_reader_feed_take(binary, &src, &length)) == NULL) {
+                    goto out;
+                }
+                memcpy(header, segment, sizeof(header));
+                feed->scratch.length = 0;
+                OWF_HOST32(header[0]);
+                OWF_HOST32(header[1]);
+
+                if (OWF_NOEXPECT(header[0] != OWF_MAGIC)) {
+                    OWF_ERROR_SETF(binary->reader.error, "invalid magic header: %#08x", header[0]);
+                    OWF_BINARY_FEED_FAIL(binary);
+                } else if (OWF_NOEXPECT(header[1] % sizeof(uint32_t) != 0)) {
+                    OWF_ERROR_SETF(binary->reader.error, "length was not " OWF_PRINT_SIZE "-byte aligned (got " OWF_PRINT_U32 " bytes)", sizeof(uint32_t), header[1]);
+                    OWF_BINARY_FEED_FAIL(binary);
+                }
+
+                owf_binary_reader_begin(binary);
+                feed->package_left = header[1];
+                feed->state = OWF_BINARY_FEED_CHANNEL;
+                break;
+            case OWF_BINARY_FEED_CHANNEL:
+                if (feed->package_left == 0) {
+                    /* Done; get ready for the next package */
+                    owf_binary_reader_finish(binary);
+                    feed->state = OWF_BINARY_FEED_PACKAGE;
+                    status = OWF_BINARY_FEED_DONE;
+                    break;
+                }
+
+                /* Channel length */
+                feed->want = sizeof(uint32_t);
+                if ((segment = owf_binary_reader_feed_take(binary, &src, &length)) == NULL) {
+                    goto out;
+                }
+                memcpy(&value, segment, sizeof(value));
+                feed->scratch.length = 0;
+                OWF_HOST32(value);
+
+                if (OWF_NOEXPECT(value % sizeof(uint32_t) != 0)) {
+                    OWF_ERROR_SETF(binary->reader.error, "length was not " OWF_PRINT_SIZE "-byte aligned (got " OWF_PRINT_U32 " bytes)", sizeof(uint32_t), value);
+                    OWF_BINARY_FEED_FAIL(binary);
+                } else if (OWF_NOEXPECT(value > UINT32_MAX - sizeof(uint32_t) || !owf_binary_reader_feed_fit(binary, &feed->package_left, value + sizeof(uint32_t)))) {
+                    OWF_BINARY_FEED_FAIL(binary);
+                }
+
+                feed->channel_left = value;
+                feed->state = OWF_BINARY_FEED_CHANNEL_ID_LENGTH;
+                break;
+            case OWF_BINARY_FEED_CHANNEL_ID_LENGTH:
+            case OWF_BINARY_FEED_NAMESPACE_LENGTH:
+                if (feed->state == OWF_BINARY_FEED_NAMESPACE_LENGTH && feed->channel_left == 0) {
+                    /* End of the channel */
+                    feed->state = OWF_BINARY_FEED_CHANNEL;
+                    break;
+                } else if (!owf_binary_reader_feed_peek(binary, &src, &length, &value)) {
+                    goto out;
+                } else if (OWF_NOEXPECT(value > UINT32_MAX - sizeof(uint32_t))) {
+                    OWF_ERROR_SETF(binary->reader.error, "segment length too large: " OWF_PRINT_U32, value);
+                    OWF_BINARY_FEED_FAIL(binary);
+                }
+
+                /* Take the prefix and the segment together, so it can be unwrapped normally */
+                feed->want = value + sizeof(uint32_t);
+                if (OWF_NOEXPECT(!owf_binary_reader_feed_fit(binary, &feed->channel_left, feed->want))) {
+                    OWF_BINARY_FEED_FAIL(binary);
+                }
+                feed->state = feed->state == OWF_BINARY_FEED_CHANNEL_ID_LENGTH ? OWF_BINARY_FEED_CHANNEL_ID : OWF_BINARY_FEED_NAMESPACE;
+                break;
+            case OWF_BINARY_FEED_CHANNEL_ID:
+                if ((segment = owf_binary_reader_feed_take(binary, &src, &length)) == NULL) {
+                    goto out;
+                }
+
+                owf_binary_reader_prime(binary, OWF_READ_CHANNEL, &binary->reader.ctx.channel);
+                id.str = &binary->reader.ctx.channel.id;
+                id.set = OWF_BINARY_READER_PROJECTION_SET(binary, channels);
+                id.keep = false;
+                if (OWF_NOEXPECT(!owf_binary_reader_feed_unwrap(binary, segment, feed->want, owf_binary_reader_read_id, &id))) {
+                    OWF_BINARY_FEED_FAIL(binary);
+                }
+
+                /* Call the visitor, skipping the channel if it isn't projected or the visitor declines */
+                if (id.keep && OWF_READER_VISIT(binary->reader, OWF_READ_CHANNEL)) {
+                    feed->state = OWF_BINARY_FEED_NAMESPACE_LENGTH;
+                } else if (OWF_NOEXPECT(owf_error_test(binary->reader.error) || !owf_binary_reader_unprime(binary, OWF_READ_CHANNEL, &binary->reader.ctx.channel))) {
+                    OWF_BINARY_FEED_FAIL(binary);
+                } else {
+                    feed->state = OWF_BINARY_FEED_SKIP;
+                }
+                break;
+            case OWF_BINARY_FEED_NAMESPACE:
+                if ((segment = owf_binary_reader_feed_take(binary, &src, &length)) == NULL) {
+                    goto out;
+                } else if (OWF_NOEXPECT(!owf_binary_reader_feed_unwrap(binary, segment, feed->want, owf_binary_reader_read_namespace, &binary->reader.ctx.ns))) {
+                    OWF_BINARY_FEED_FAIL(binary);
+                }
+                feed->state = OWF_BINARY_FEED_NAMESPACE_LENGTH;
+                break;
+            case OWF_BINARY_FEED_SKIP:
+                skip = OWF_MIN((size_t)feed->channel_left, length);
+                src += skip;
+                length -= skip;
+                feed->channel_left -= (uint32_t)skip;
+                if (feed->channel_left > 0) {
+                    goto out;
+                }
+                feed->state = OWF_BINARY_FEED_CHANNEL;
+                break;
+            case OWF_BINARY_FEED_FAILED:
+                goto out;
+        }
+    }
+
+out:
+    *consumed = (size_t)(src - (const uint8_t *)ptr);
+    return feed->state == OWF_BINARY_FEED_FAILED ? OWF_BINARY_FEED_ERROR : status;
+}
+
 bool owf_binary_reader_read_channel(owf_binary_reader_t *binary, void *ptr) {
     owf_channel_t *channel = (owf_channel_t *)ptr;
-    owf_channel_init(channel);
+    bool keep;
+    owf_binary_reader_prime(binary, OWF_READ_CHANNEL, channel);
 
-    /* Read the channel id */
-    if (OWF_NOEXPECT(!owf_binary_reader_unwrap(binary, owf_binary_reader_read_str, &channel->id))) {
+    /* Read the channel id, skipping the channel if it isn't projected */
+    if (OWF_NOEXPECT(!owf_binary_reader_unwrap_id(binary, &channel->id, OWF_BINARY_READER_PROJECTION_SET(binary, channels), &keep))) {
         return false;
+    } else if (!keep) {
+        binary->skip_length = binary->segment_length;
+        return owf_binary_reader_unprime(binary, OWF_READ_CHANNEL, channel);
     }
 
     /* Call the visitor */
@@ -152,7 +1744,9 @@ bool owf_binary_reader_read_channels(owf_binary_reader_t *binary, void *ptr) {
 
 bool owf_binary_reader_read_namespace(owf_binary_reader_t *binary, void *ptr) {
     owf_namespace_t *ns = (owf_namespace_t *)ptr;
-    owf_namespace_init(ns);
+    const uint32_t flags = binary->projection != NULL ? binary->projection->flags : 0;
+    bool keep;
+    owf_binary_reader_prime(binary, OWF_READ_NAMESPACE, ns);
 
     /* Read timestamps */
     OWF_BINARY_SAFE_READ(binary, &ns->t0, sizeof(ns->t0));
@@ -160,29 +1754,44 @@ bool owf_binary_reader_read_namespace(owf_binary_reader_t *binary, void *ptr) {
     OWF_BINARY_SAFE_READ(binary, &ns->dt, sizeof(ns->dt));
     OWF_HOST64(ns->dt);
 
-    /* Read the ID */
-    if (OWF_NOEXPECT(!owf_binary_reader_unwrap(binary, owf_binary_reader_read_str, &ns->id))) {
+    /* Read the ID, skipping the namespace if it isn't projected */
+    if (OWF_NOEXPECT(!owf_binary_reader_unwrap_id(binary, &ns->id, OWF_BINARY_READER_PROJECTION_SET(binary, namespaces), &keep))) {
         return false;
+    } else if (!keep) {
+        binary->skip_length = binary->segment_length;
+        return owf_binary_reader_unprime(binary, OWF_READ_NAMESPACE, ns);
     }
 
     /* Call the visitor */
     OWF_BINARY_READER_VISIT(binary, OWF_READ_NAMESPACE);
 
-    /* Read children */
+    /* Read children, skipping kinds the projection excludes */
     return OWF_EXPECT(
-        owf_binary_reader_unwrap(binary, owf_binary_reader_read_signals, &binary->reader.ctx.signal) &&
-        owf_binary_reader_unwrap(binary, owf_binary_reader_read_events, &binary->reader.ctx.event) &&
-        owf_binary_reader_unwrap(binary, owf_binary_reader_read_alarms, &binary->reader.ctx.alarm));
+        owf_binary_reader_unwrap(binary, (flags & OWF_PROJECTION_NO_SIGNALS) ? owf_binary_reader_skip_segment : owf_binary_reader_read_signals, &binary->reader.ctx.signal) &&
+        owf_binary_reader_unwrap(binary, (flags & OWF_PROJECTION_NO_EVENTS) ? owf_binary_reader_skip_segment : owf_binary_reader_read_events, &binary->reader.ctx.event) &&
+        owf_binary_reader_unwrap(binary, (flags & OWF_PROJECTION_NO_ALARMS) ? owf_binary_reader_skip_segment : owf_binary_reader_read_alarms, &binary->reader.ctx.alarm));
 }
 
 bool owf_binary_reader_read_signal(owf_binary_reader_t *binary, void *ptr) {
     owf_signal_t *signal = &binary->reader.ctx.signal;
-    owf_signal_init(signal);
+    bool keep;
+    owf_binary_reader_prime(binary, OWF_READ_SIGNAL, signal);
+
+    /* Read the ID, stepping over the unit and samples if it isn't projected */
+    if (OWF_NOEXPECT(!owf_binary_reader_unwrap_id(binary, &signal->id, OWF_BINARY_READER_PROJECTION_SET(binary, signals), &keep))) {
+        return false;
+    } else if (!keep) {
+        return OWF_EXPECT(
+            owf_binary_reader_unprime(binary, OWF_READ_SIGNAL, signal) &&
+            owf_binary_reader_unwrap(binary, owf_binary_reader_skip_segment, NULL) &&
+            owf_binary_reader_unwrap(binary, owf_binary_reader_skip_segment, NULL));
+    }
 
     if (OWF_NOEXPECT(
-        !owf_binary_reader_unwrap(binary, owf_binary_reader_read_str, &signal->id) ||
-        !owf_binary_reader_unwrap(binary, owf_binary_reader_read_str, &signal->unit) ||
+        !owf_binary_reader_unwrap(binary, owf_binary_reader_read_interned, &signal->unit) ||
         !owf_binary_reader_unwrap(binary, owf_binary_reader_read_samples, &signal->samples))) {
+        owf_signal_destroy(signal, binary->reader.alloc);
+        owf_signal_init(signal);
         return false;
     }
 
@@ -197,7 +1806,7 @@ bool owf_binary_reader_read_signals(owf_binary_reader_t *binary, void *ptr) {
 
 bool owf_binary_reader_read_event(owf_binary_reader_t *binary, void *ptr) {
     owf_event_t *event = &binary->reader.ctx.event;
-    owf_event_init(event);
+    owf_binary_reader_prime(binary, OWF_READ_EVENT, event);
 
     /* Read the timestamp */
     OWF_BINARY_SAFE_READ(binary, &event->t0, sizeof(event->t0));
@@ -227,7 +1836,7 @@ bool owf_binary_reader_read_events(owf_binary_reader_t *binary, void *ptr) {
 
 bool owf_binary_reader_read_alarm(owf_binary_reader_t *binary, void *ptr) {
     owf_alarm_t *alarm = &binary->reader.ctx.alarm;
-    owf_alarm_init(alarm);
+    owf_binary_reader_prime(binary, OWF_READ_ALARM, alarm);
 
     /* Read the timestamp */
     OWF_BINARY_SAFE_READ(binary, &alarm->t0, sizeof(alarm->t0));
@@ -255,6 +1864,8 @@ bool owf_binary_reader_read_alarm(owf_binary_reader_t *binary, void *ptr) {
 
     /* Read the data */
     if (OWF_NOEXPECT(!owf_binary_reader_unwrap(binary, owf_binary_reader_read_str, &alarm->message))) {
+        owf_alarm_destroy(alarm, binary->reader.alloc);
+        owf_alarm_init(alarm);
         return false;
     }
 
@@ -277,33 +1888,57 @@ bool owf_binary_reader_read_samples(owf_binary_reader_t *binary, void *ptr) {
         return false;
     }
 
-    /* Read the double array */
-    owf_array_init(samples);
-    OWF_BINARY_SAFE_VARIABLE_READ(binary, *samples, length, sizeof(double), 0);
-
-    /* Treat this memory as a union between a double and a uint64_t to protect strict-aliasing */
-    owf_double_union_t val;
-
-    /* Byteswap the samples */
-    for (uint32_t i = 0; i < OWF_ARRAY_LEN(*samples); i++) {
-        val.u64 = OWF_ARRAY_GET(*samples, uint64_t, i);
-        OWF_HOST64(val.u64);
-        OWF_ARRAY_PUT(*samples, double, i, val.f64);
+    /* Read the double array, borrowing it if it's aligned well enough to be used in place */
+    owf_binary_reader_recycle(binary, samples);
+    if (binary->borrow != NULL && length > 0 &&
+        ((uintptr_t)((uint8_t *)binary->borrow->ptr + binary->borrow->position)) % sizeof(double) == 0) {
+        if (OWF_NOEXPECT(!owf_binary_reader_borrow(binary, samples, length, sizeof(double)))) {
+            return false;
+        }
+    } else if (binary->block != NULL) {
+        if (OWF_NOEXPECT(!owf_binary_reader_block_read(binary, samples, OWF_BINARY_BLOCK_SAMPLES, length, sizeof(double)))) {
+            return false;
+        }
+    } else {
+        OWF_BINARY_SAFE_VARIABLE_READ(binary, *samples, length, sizeof(double), 0);
     }
 
+    /* Byteswap the samples in place */
+    OWF_HOST64_ARRAY(samples->ptr, samples->ptr, OWF_ARRAY_LEN(*samples));
+
     return true;
 }
 
 bool owf_binary_reader_read_str(owf_binary_reader_t *binary, void *ptr) {
     owf_str_t *str = (owf_str_t *)ptr;
-    owf_str_init(str);
+    owf_binary_reader_recycle_str(binary, str);
 
     /*
      * Read the actual string.
      * The string's length is currently saved in binary->segment_length if this call is wrapped.
      */
-    if (OWF_NOEXPECT(!owf_str_reserve(str, binary->reader.alloc, binary->reader.error, binary->segment_length))) {
-        return false;
+    if (binary->borrow != NULL) {
+        if (OWF_NOEXPECT(binary->segment_length > 0 && !owf_binary_reader_borrow(binary, &str->bytes, binary->segment_length, sizeof(uint8_t)))) {
+            return false;
+        }
+    } else if (str->bytes.ptr == NULL && binary->segment_length <= OWF_STR_INLINE_SIZE) {
+        /* Short enough to keep inline. Stage it first, since the inline bytes overlay the array. */
+        const uint32_t length = binary->segment_length;
+        char small[OWF_STR_INLINE_SIZE];
+        OWF_BINARY_SAFE_READ(binary, small, length);
+
+        if (OWF_NOEXPECT(length > 0 && small[length - 1] != 0)) {
+            OWF_ERROR_SET(binary->reader.error, "string was not NULL-terminated");
+            return false;
+        } else if (length > 0) {
+            memcpy(str->small.bytes, small, length);
+            str->small.tag = OWF_STR_INLINE_TAG;
+        }
+        return true;
+    } else if (binary->block != NULL) {
+        if (OWF_NOEXPECT(!owf_binary_reader_block_read(binary, &str->bytes, OWF_BINARY_BLOCK_STRINGS, binary->segment_length, sizeof(uint8_t)))) {
+            return false;
+        }
     } else {
         OWF_BINARY_SAFE_VARIABLE_READ(binary, str->bytes, binary->segment_length, sizeof(uint8_t), 0);
     }
@@ -312,9 +1947,10 @@ bool owf_binary_reader_read_str(owf_binary_reader_t *binary, void *ptr) {
      * If we got here, the variable read succeeded and we have a buffer of size
      * str->length with the string in it. Make sure it's NULL-terminated.
      */
-    if (OWF_NOEXPECT(OWF_ARRAY_LEN(str->bytes) > 0 && OWF_ARRAY_GET(str->bytes, uint8_t, OWF_ARRAY_LEN(str->bytes) - 1) != 0)) {
+    if (OWF_NOEXPECT(OWF_ARRAY_LEN(str->bytes) > 0 && OWF_STR_PTR(*str)[OWF_ARRAY_LEN(str->bytes) - 1] != 0)) {
         OWF_ERROR_SET(binary->reader.error, "string was not NULL-terminated");
         owf_str_destroy(str, binary->reader.alloc);
+        owf_str_init(str);
         return false;
     }
     return true;
@@ -352,11 +1988,19 @@ bool owf_binary_reader_unwrap_top(owf_binary_reader_t *binary, owf_binary_reader
     /* Yield to the callback, and ensure that we have no data left to read after the callback executes */
     binary->segment_length = length;
     binary->skip_length = 0;
+    OWF_BINARY_READER_BOUND(binary);
     if (OWF_NOEXPECT(!cb(binary, ptr))) {
         return false;
     }
 
-    /* Read skipped bytes */
+    /* Step over skipped bytes: buffer sources just move their position, seekable sources seek, and anything else reads them */
+    if (binary->skip_length > 0 && (binary->buffer != NULL || (binary->reader.seek != NULL && binary->reader.seek(binary->skip_length, binary->reader.data)))) {
+        if (binary->buffer != NULL) {
+            binary->buffer->position += binary->skip_length;
+        }
+        OWF_ARITH_SAFE_SUB32(binary->reader.error, binary->segment_length, binary->skip_length);
+        binary->skip_length = 0;
+    }
     while (binary->skip_length > 0) {
         const uint32_t to_skip = OWF_MIN(binary->skip_length, sizeof(binary->skip));
         OWF_BINARY_SAFE_READ(binary, binary->skip, to_skip);
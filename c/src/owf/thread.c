@@ -0,0 +1,89 @@
+#include <owf/thread.h>
+
+#if OWF_PLATFORM_IS_GNU
+static void *owf_thread_start(void *ptr) {
+    owf_thread_t *thread = (owf_thread_t *)ptr;
+    thread->cb(thread->data);
+    return NULL;
+}
+
+bool owf_thread_create(owf_thread_t *thread, owf_error_t *error, owf_thread_cb_t cb, void *data) {
+    int err;
+
+    thread->cb = cb;
+    thread->data = data;
+    if (OWF_NOEXPECT((err = pthread_create(&thread->handle, NULL, owf_thread_start, thread)) != 0)) {
+        OWF_ERROR_SETF(error, "couldn't start thread: %s", strerror(err));
+        return false;
+    }
+    return true;
+}
+
+void owf_thread_join(owf_thread_t *thread) {
+    pthread_join(thread->handle, NULL);
+}
+
+uint32_t owf_thread_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : (uint32_t)OWF_MIN(count, (long)UINT32_MAX);
+}
+
+void owf_mutex_init(owf_mutex_t *mutex) {
+    pthread_mutex_init(mutex, NULL);
+}
+
+void owf_mutex_lock(owf_mutex_t *mutex) {
+    pthread_mutex_lock(mutex);
+}
+
+void owf_mutex_unlock(owf_mutex_t *mutex) {
+    pthread_mutex_unlock(mutex);
+}
+
+void owf_mutex_destroy(owf_mutex_t *mutex) {
+    pthread_mutex_destroy(mutex);
+}
+#elif OWF_PLATFORM == OWF_PLATFORM_WINDOWS
+static DWORD WINAPI owf_thread_start(LPVOID ptr) {
+    owf_thread_t *thread = (owf_thread_t *)ptr;
+    thread->cb(thread->data);
+    return 0;
+}
+
+bool owf_thread_create(owf_thread_t *thread, owf_error_t *error, owf_thread_cb_t cb, void *data) {
+    thread->cb = cb;
+    thread->data = data;
+    if (OWF_NOEXPECT((thread->handle = CreateThread(NULL, 0, owf_thread_start, thread, 0, NULL)) == NULL)) {
+        OWF_ERROR_SETF(error, "couldn't start thread: %lu", (unsigned long)GetLastError());
+        return false;
+    }
+    return true;
+}
+
+void owf_thread_join(owf_thread_t *thread) {
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+uint32_t owf_thread_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors < 1 ? 1 : (uint32_t)info.dwNumberOfProcessors;
+}
+
+void owf_mutex_init(owf_mutex_t *mutex) {
+    InitializeCriticalSection(mutex);
+}
+
+void owf_mutex_lock(owf_mutex_t *mutex) {
+    EnterCriticalSection(mutex);
+}
+
+void owf_mutex_unlock(owf_mutex_t *mutex) {
+    LeaveCriticalSection(mutex);
+}
+
+void owf_mutex_destroy(owf_mutex_t *mutex) {
+    DeleteCriticalSection(mutex);
+}
+#endif
@@ -19,21 +19,82 @@ uint32_t owf_memoize_cache(owf_memoize_t *memoize, uint32_t value) {
     return value;
 }
 
+void owf_memoize_adjust(owf_memoize_t *memoize, uint32_t before, uint32_t after) {
+    uint64_t value;
+    if (owf_memoize_stale(memoize)) {
+        return;
+    }
+
+    /* Anything that underflows wraps far past UINT32_MAX, and goes stale too */
+    value = (uint64_t)memoize->length - before + after;
+    memoize->length = value < UINT32_MAX ? (uint32_t)value : UINT32_MAX;
+}
+
+/* Pushes a child node onto one of its parent's arrays, growing the parent's memoized size to match.
+ * The child is sized before it's copied, so the copy keeps its memoized size too.
+ * Returns from the calling function.
+ */
+#define OWF_MEMOIZE_PUSH(_parent, _arr, _alloc, _error, _child, _size_fn) do { \
+    uint32_t _child_size = 0; \
+    bool _sized = !owf_memoize_stale(&(_parent)->memoize) && _size_fn(_child, _error, &_child_size); \
+    if (OWF_NOEXPECT(!owf_array_push(&(_parent)->_arr, _alloc, _error, _child, sizeof(*(_child))))) { \
+        return false; \
+    } else if (OWF_EXPECT(_sized)) { \
+        owf_memoize_adjust(&(_parent)->memoize, 0, _child_size); \
+    } else { \
+        owf_memoize_init(&(_parent)->memoize); \
+    } \
+    return true; \
+} while (0)
+
+/* Sets one of a node's strings, adjusting the node's memoized size by the change.
+ * @memoize The node's <owf_memoize_t>
+ * @str The string
+ * @alloc The allocator
+ * @error The error context
+ * @value The new value
+ *
+ * @return True if the operation was successful
+ */
+static bool owf_memoize_set_str(owf_memoize_t *memoize, owf_str_t *str, owf_alloc_t *alloc, owf_error_t *error, const char *value) {
+    uint32_t before = 0, after = 0;
+    bool sized = !owf_memoize_stale(memoize) && owf_str_size(str, error, &before);
+
+    if (OWF_NOEXPECT(!owf_str_set(str, alloc, error, value))) {
+        /* The old value is gone either way */
+        owf_memoize_init(memoize);
+        return false;
+    } else if (OWF_EXPECT(sized && owf_str_size(str, error, &after))) {
+        owf_memoize_adjust(memoize, before, after);
+    } else {
+        owf_memoize_init(memoize);
+    }
+    return true;
+}
+
 void owf_array_init(owf_array_t *arr) {
     arr->ptr = NULL;
     arr->length = 0;
     arr->capacity = 0;
 }
 
+void owf_array_borrow(owf_array_t *arr, void *ptr, uint32_t length) {
+    arr->ptr = ptr;
+    arr->length = length;
+    arr->capacity = 0;
+}
+
 void owf_array_destroy(owf_array_t *arr, owf_alloc_t *alloc) {
-    owf_free(alloc, arr->ptr);
+    if (OWF_EXPECT(!OWF_ARRAY_BORROWED(*arr))) {
+        owf_free(alloc, arr->ptr);
+    }
 }
 
 int owf_array_binary_compare(owf_array_t *lhs, owf_array_t *rhs, uint32_t width) {
     uint32_t lhs_len = OWF_ARRAY_LEN(*lhs), rhs_len = OWF_ARRAY_LEN(*rhs);
     if (OWF_EXPECT(lhs_len == rhs_len)) {
         uint32_t bytes = lhs_len * width;
-        return memcmp(lhs->ptr, rhs->ptr, bytes);
+        return bytes == 0 ? 0 : memcmp(lhs->ptr, rhs->ptr, bytes);
     } else {
         return lhs_len < rhs_len ? -1 : 1;
     }
@@ -62,8 +123,14 @@ bool owf_array_reserve_exactly(owf_array_t *arr, owf_alloc_t *alloc, owf_error_t
         return false;
     }
 
-    /* Reallocate */
-    if (OWF_NOEXPECT(!owf_realloc(alloc, error, &ptr, new_size))) {
+    if (OWF_NOEXPECT(OWF_ARRAY_BORROWED(*arr))) {
+        /* Copy borrowed memory onto the heap, since we don't own it */
+        if (OWF_NOEXPECT((ptr = owf_malloc(alloc, error, new_size)) == NULL)) {
+            return false;
+        }
+        memcpy(ptr, arr->ptr, (size_t)OWF_MIN(arr->length, capacity) * width);
+    } else if (OWF_NOEXPECT(!owf_realloc_sized(alloc, error, &ptr, (size_t)arr->capacity * width, new_size))) {
+        /* Reallocation failed */
         return false;
     }
 
@@ -75,7 +142,7 @@ bool owf_array_reserve_exactly(owf_array_t *arr, owf_alloc_t *alloc, owf_error_t
 }
 
 bool owf_array_push(owf_array_t *arr, owf_alloc_t *alloc, owf_error_t *error, const void *obj, uint32_t width) {
-    if (OWF_NOEXPECT(arr->length == arr->capacity && !owf_array_reserve(arr, alloc, error, arr->capacity + 1, width))) {
+    if (OWF_NOEXPECT(arr->length >= arr->capacity && !owf_array_reserve(arr, alloc, error, arr->length + 1, width))) {
         return false;
     }
 
@@ -120,6 +187,11 @@ void owf_buffer_init(owf_buffer_t *buf, void *ptr, size_t length) {
 void owf_package_init(owf_package_t *owf) {
     owf_memoize_init(&owf->memoize);
     owf_array_init(&owf->channels);
+    owf->blocks = NULL;
+}
+
+void owf_package_reset(owf_package_t *owf) {
+    owf_memoize_init(&owf->memoize);
 }
 
 void owf_package_destroy(owf_package_t *owf, owf_alloc_t *alloc) {
@@ -128,6 +200,13 @@ void owf_package_destroy(owf_package_t *owf, owf_alloc_t *alloc) {
         owf_channel_destroy(OWF_ARRAY_PTR(owf->channels, owf_channel_t, i), alloc);
     }
     owf_array_destroy(&owf->channels, alloc);
+
+    /* Free blocks; nodes carved from them were borrowed, so destroying them above was a no-op */
+    while (owf->blocks != NULL) {
+        void *next = *(void **)owf->blocks;
+        owf_free(alloc, owf->blocks);
+        owf->blocks = next;
+    }
 }
 
 #define OWF_PACKAGE_PRINT_FMT "#<owf_package_t@%p: [" OWF_PRINT_U32 " %s]>"
@@ -167,7 +246,7 @@ bool owf_package_size(owf_package_t *owf, owf_error_t *error, uint32_t *output_s
 }
 
 bool owf_package_push_channel(owf_package_t *owf, owf_alloc_t *alloc, owf_error_t *error, owf_channel_t *channel) {
-    return owf_array_push(&owf->channels, alloc, error, channel, sizeof(owf_channel_t));
+    OWF_MEMOIZE_PUSH(owf, channels, alloc, error, channel, owf_channel_size);
 }
 
 void owf_channel_init(owf_channel_t *channel) {
@@ -241,11 +320,11 @@ bool owf_channel_size(owf_channel_t *channel, owf_error_t *error, uint32_t *outp
 }
 
 bool owf_channel_set_id(owf_channel_t *channel, owf_alloc_t *alloc, owf_error_t *error, const char *id) {
-    return owf_str_set(&channel->id, alloc, error, id);
+    return owf_memoize_set_str(&channel->memoize, &channel->id, alloc, error, id);
 }
 
 bool owf_channel_push_namespace(owf_channel_t *channel, owf_alloc_t *alloc, owf_error_t *error, owf_namespace_t *ns) {
-    return owf_array_push(&channel->namespaces, alloc, error, ns, sizeof(owf_namespace_t));
+    OWF_MEMOIZE_PUSH(channel, namespaces, alloc, error, ns, owf_namespace_size);
 }
 
 void owf_namespace_init(owf_namespace_t *ns) {
@@ -367,19 +446,19 @@ bool owf_namespace_size(owf_namespace_t *ns, owf_error_t *error, uint32_t *outpu
 }
 
 bool owf_namespace_set_id(owf_namespace_t *ns, owf_alloc_t *alloc, owf_error_t *error, const char *id) {
-    return owf_str_set(&ns->id, alloc, error, id);
+    return owf_memoize_set_str(&ns->memoize, &ns->id, alloc, error, id);
 }
 
 bool owf_namespace_push_signal(owf_namespace_t *ns, owf_alloc_t *alloc, owf_error_t *error, owf_signal_t *signal) {
-    return owf_array_push(&ns->signals, alloc, error, signal, sizeof(owf_signal_t));
+    OWF_MEMOIZE_PUSH(ns, signals, alloc, error, signal, owf_signal_size);
 }
 
 bool owf_namespace_push_event(owf_namespace_t *ns, owf_alloc_t *alloc, owf_error_t *error, owf_event_t *event) {
-    return owf_array_push(&ns->events, alloc, error, event, sizeof(owf_event_t));
+    OWF_MEMOIZE_PUSH(ns, events, alloc, error, event, owf_event_size);
 }
 
 bool owf_namespace_push_alarm(owf_namespace_t *ns, owf_alloc_t *alloc, owf_error_t *error, owf_alarm_t *alarm) {
-    return owf_array_push(&ns->alarms, alloc, error, alarm, sizeof(owf_alarm_t));
+    OWF_MEMOIZE_PUSH(ns, alarms, alloc, error, alarm, owf_alarm_size);
 }
 
 void owf_signal_init(owf_signal_t *signal) {
@@ -465,21 +544,30 @@ bool owf_signal_size(owf_signal_t *signal, owf_error_t *error, uint32_t *output_
 }
 
 bool owf_signal_set_id(owf_signal_t *signal, owf_alloc_t *alloc, owf_error_t *error, const char *id) {
-    return owf_str_set(&signal->id, alloc, error, id);
+    return owf_memoize_set_str(&signal->memoize, &signal->id, alloc, error, id);
 }
 
 bool owf_signal_set_unit(owf_signal_t *signal, owf_alloc_t *alloc, owf_error_t *error, const char *unit) {
-    return owf_str_set(&signal->unit, alloc, error, unit);
+    return owf_memoize_set_str(&signal->memoize, &signal->unit, alloc, error, unit);
 }
 
 bool owf_signal_push_samples(owf_signal_t *signal, owf_alloc_t *alloc, owf_error_t *error, const double *samples, uint32_t count) {
+    const uint32_t before = OWF_ARRAY_LEN(signal->samples);
+    uint64_t growth;
+    bool ret = true;
+
     for (uint32_t i = 0; i < count; i++) {
         if (OWF_NOEXPECT(!owf_array_push(&signal->samples, alloc, error, &samples[i], sizeof(samples[i])))) {
-            return false;
+            ret = false;
+            break;
         }
     }
 
-    return true;
+    /* Grow by however many made it in; anything too big to add just goes stale */
+    growth = (uint64_t)(OWF_ARRAY_LEN(signal->samples) - before) * sizeof(double);
+    owf_memoize_adjust(&signal->memoize, 0, (uint32_t)OWF_MIN(growth, UINT32_MAX));
+
+    return ret;
 }
 
 void owf_event_init(owf_event_t *event) {
@@ -634,6 +722,13 @@ bool owf_str_set(owf_str_t *str, owf_alloc_t *alloc, owf_error_t *error, const c
     } else if (OWF_EXPECT(size > 0)) {
         uint32_t truncated_size = (uint32_t)size;
 
+        if (truncated_size < OWF_STR_INLINE_SIZE) {
+            /* Short enough to keep inline */
+            memcpy(str->small.bytes, value, truncated_size + 1);
+            str->small.tag = OWF_STR_INLINE_TAG;
+            return true;
+        }
+
         /* Safely truncate the size and reserve that many bytes */
         if (OWF_NOEXPECT(!owf_str_reserve(str, alloc, error, truncated_size))) {
             return false;
@@ -652,33 +747,44 @@ bool owf_str_set(owf_str_t *str, owf_alloc_t *alloc, owf_error_t *error, const c
 bool owf_str_reserve(owf_str_t *str, owf_alloc_t *alloc, owf_error_t *error, uint32_t length) {
     uint32_t size;
 
-    /* Initialize the array */
-    owf_array_init(&str->bytes);
+    /* Make room for the null terminator */
     if (OWF_NOEXPECT(!owf_arith_safe_add32(length, 1, &size, error))) {
         return false;
+    } else if (OWF_NOEXPECT(size == OWF_STR_INLINE_TAG)) {
+        /* The capacity would look like an inline string's tag */
+        OWF_ERROR_SETF(error, "string length (" OWF_PRINT_U32 ") is too long", length);
+        return false;
     }
 
-    return owf_array_reserve_exactly(&str->bytes, alloc, error, sizeof(uint8_t), size);
+    if (OWF_STR_INLINE(*str)) {
+        owf_array_init(&str->bytes);
+    }
+    return owf_array_reserve_exactly(&str->bytes, alloc, error, size, sizeof(uint8_t));
 }
 
 void owf_str_destroy(owf_str_t *str, owf_alloc_t *alloc) {
-    owf_array_destroy(&str->bytes, alloc);
+    if (!OWF_STR_INLINE(*str)) {
+        owf_array_destroy(&str->bytes, alloc);
+    }
 }
 
 int owf_str_binary_compare(owf_str_t *lhs, owf_str_t *rhs) {
     uint32_t lhs_len = owf_str_length(lhs), rhs_len = owf_str_length(rhs);
     if (OWF_EXPECT(lhs_len == rhs_len)) {
         const char *p1 = OWF_STR_PTR(*lhs), *p2 = OWF_STR_PTR(*rhs);
-        return strncmp(p1, p2, lhs_len);
+        /* Interned strings with the same value share their bytes */
+        return lhs_len == 0 || p1 == p2 ? 0 : strncmp(p1, p2, lhs_len);
     } else {
         return lhs_len < rhs_len ? -1 : 1;
     }
 }
 
 uint32_t owf_str_length(owf_str_t *str) {
-    if (owf_memoize_stale(&str->string_size)) {
+    if (owf_memoize_stale(&str->string_size) && OWF_STR_INLINE(*str)) {
+        return owf_memoize_cache(&str->string_size, (uint32_t)strnlen(str->small.bytes, OWF_STR_INLINE_SIZE));
+    } else if (owf_memoize_stale(&str->string_size)) {
         /* OWF_ARRAY_LEN(str->bytes) returns a uint32_t, so we can truncate the return value of strnlen */
-        return owf_memoize_cache(&str->string_size, OWF_ARRAY_LEN(str->bytes) == 0 ? 0 : (uint32_t)strnlen(str->bytes.ptr, OWF_ARRAY_LEN(str->bytes)));
+        return owf_memoize_cache(&str->string_size, OWF_ARRAY_LEN(str->bytes) == 0 ? 0 : (uint32_t)strnlen(OWF_STR_PTR(*str), OWF_ARRAY_LEN(str->bytes)));
     } else {
         return owf_memoize_fetch(&str->string_size);
     }
@@ -716,3 +822,92 @@ bool owf_str_size(owf_str_t *str, owf_error_t *error, uint32_t *output_size) {
 
     return true;
 }
+
+void owf_path_init(owf_path_t *path, owf_package_t *owf, owf_channel_t *channel, owf_namespace_t *ns) {
+    path->owf = owf;
+    path->channel = channel;
+    path->ns = ns;
+}
+
+/* Carries a change in a node's memoized size up through the nodes above it on an <owf_path_t>.
+ * @path The path
+ * @levels The number of nodes above the changed node: 1 for a channel, up to 3 for a signal
+ * @memoize The changed node's <owf_memoize_t>
+ * @sized Whether the node's size was memoized before the change
+ * @before The node's memoized size before the change
+ * Every node above goes stale if the node's old or new size is unknown.
+ */
+static void owf_path_propagate(owf_path_t *path, int levels, owf_memoize_t *memoize, bool sized, uint32_t before) {
+    owf_memoize_t *ancestors[] = {
+        path->ns != NULL ? &path->ns->memoize : NULL,
+        path->channel != NULL ? &path->channel->memoize : NULL,
+        path->owf != NULL ? &path->owf->memoize : NULL
+    };
+
+    for (int i = 3 - levels; i < 3 && ancestors[i] != NULL; i++) {
+        if (OWF_EXPECT(sized && !owf_memoize_stale(memoize))) {
+            owf_memoize_adjust(ancestors[i], before, owf_memoize_fetch(memoize));
+        } else {
+            owf_memoize_init(ancestors[i]);
+        }
+    }
+}
+
+/* Pushes something onto the namespace at the end of an <owf_path_t>, then carries the change up the path.
+ * Returns from the calling function.
+ */
+#define OWF_PATH_PUSH(_path, _error, _push) do { \
+    uint32_t _before; \
+    bool _sized, _ret; \
+    if (OWF_NOEXPECT((_path)->ns == NULL)) { \
+        OWF_ERROR_SET(_error, "path has no namespace"); \
+        return false; \
+    } \
+    _sized = !owf_memoize_stale(&(_path)->ns->memoize); \
+    _before = owf_memoize_fetch(&(_path)->ns->memoize); \
+    _ret = (_push); \
+    owf_path_propagate(_path, 2, &(_path)->ns->memoize, _sized, _before); \
+    return _ret; \
+} while (0)
+
+bool owf_path_push_namespace(owf_path_t *path, owf_alloc_t *alloc, owf_error_t *error, owf_namespace_t *ns) {
+    uint32_t before;
+    bool sized, ret;
+
+    if (OWF_NOEXPECT(path->channel == NULL)) {
+        OWF_ERROR_SET(error, "path has no channel");
+        return false;
+    }
+
+    sized = !owf_memoize_stale(&path->channel->memoize);
+    before = owf_memoize_fetch(&path->channel->memoize);
+    ret = owf_channel_push_namespace(path->channel, alloc, error, ns);
+    owf_path_propagate(path, 1, &path->channel->memoize, sized, before);
+    return ret;
+}
+
+bool owf_path_push_signal(owf_path_t *path, owf_alloc_t *alloc, owf_error_t *error, owf_signal_t *signal) {
+    OWF_PATH_PUSH(path, error, owf_namespace_push_signal(path->ns, alloc, error, signal));
+}
+
+bool owf_path_push_event(owf_path_t *path, owf_alloc_t *alloc, owf_error_t *error, owf_event_t *event) {
+    OWF_PATH_PUSH(path, error, owf_namespace_push_event(path->ns, alloc, error, event));
+}
+
+bool owf_path_push_alarm(owf_path_t *path, owf_alloc_t *alloc, owf_error_t *error, owf_alarm_t *alarm) {
+    OWF_PATH_PUSH(path, error, owf_namespace_push_alarm(path->ns, alloc, error, alarm));
+}
+
+bool owf_path_push_samples(owf_path_t *path, owf_signal_t *signal, owf_alloc_t *alloc, owf_error_t *error, const double *samples, uint32_t count) {
+    bool sized = !owf_memoize_stale(&signal->memoize), ret;
+    uint32_t before = owf_memoize_fetch(&signal->memoize);
+
+    if (OWF_NOEXPECT(path->ns == NULL)) {
+        OWF_ERROR_SET(error, "path has no namespace");
+        return false;
+    }
+
+    ret = owf_signal_push_samples(signal, alloc, error, samples, count);
+    owf_path_propagate(path, 3, &signal->memoize, sized, before);
+    return ret;
+}
@@ -4,5 +4,6 @@ void owf_writer_init(owf_writer_t *writer, owf_alloc_t *alloc, owf_error_t *erro
     writer->alloc = alloc;
     writer->error = error;
     writer->write = write;
+    writer->patch = NULL;
     writer->data = data;
 }
@@ -1,8 +1,13 @@
 #include <owf/writer/binary.h>
 #include <owf/platform.h>
+#include <owf/byteswap.h>
+#include <owf/thread.h>
 
 #include <time.h>
 
+/* Zeros, for null terminators and padding. */
+static const uint8_t owf_binary_writer_zeros[16] = {0};
+
 /* Performs a safe write, returning from the caller on error.
  *
  * @_binary The writer
@@ -15,10 +20,16 @@
             OWF_ERROR_SETF(_binary->writer.error, "write error (" OWF_PRINT_U32 " bytes)", (uint32_t)_length); \
             return false; \
         } \
+        _binary->position += (_length); \
     } while (0)
 
 void owf_binary_writer_init(owf_binary_writer_t *binary, owf_alloc_t *alloc, owf_error_t *error, owf_write_cb_t write, void *data) {
     owf_writer_init(&binary->writer, alloc, error, write, data);
+    binary->buffer = NULL;
+    binary->growable = NULL;
+    binary->iovec = NULL;
+    binary->position = 0;
+    binary->stream.depth = OWF_BINARY_STREAM_NONE;
 }
 
 static bool owf_binary_writer_file_write_cb(const void *src, const size_t size, void *data) {
@@ -27,7 +38,7 @@ static bool owf_binary_writer_file_write_cb(const void *src, const size_t size,
 }
 
 void owf_binary_writer_init_file(owf_binary_writer_t *binary, FILE *file, owf_alloc_t *alloc, owf_error_t *error) {
-    owf_writer_init(&binary->writer, alloc, error, owf_binary_writer_file_write_cb, file);
+    owf_binary_writer_init(binary, alloc, error, owf_binary_writer_file_write_cb, file);
 }
 
 static bool owf_binary_writer_buffer_write_cb(const void *src, const size_t size, void *data) {
@@ -44,8 +55,101 @@ static bool owf_binary_writer_buffer_write_cb(const void *src, const size_t size
     return true;
 }
 
+static bool owf_binary_writer_buffer_patch_cb(const void *src, const size_t size, const size_t distance, void *data) {
+    owf_buffer_t *ptr = (owf_buffer_t *)data;
+    if (OWF_NOEXPECT(distance > ptr->position || size > distance)) {
+        return false;
+    }
+    memcpy((uint8_t *)ptr->ptr + ptr->position - distance, src, size);
+    return true;
+}
+
 void owf_binary_writer_init_buffer(owf_binary_writer_t *binary, owf_buffer_t *buf, owf_alloc_t *alloc, owf_error_t *error) {
-    owf_writer_init(&binary->writer, alloc, error, owf_binary_writer_buffer_write_cb, buf);
+    owf_binary_writer_init(binary, alloc, error, owf_binary_writer_buffer_write_cb, buf);
+    binary->writer.patch = owf_binary_writer_buffer_patch_cb;
+    binary->buffer = buf;
+}
+
+static bool owf_binary_writer_growable_write_cb(const void *src, const size_t size, void *data) {
+    return owf_growable_write((owf_growable_t *)data, src, size);
+}
+
+static bool owf_binary_writer_growable_patch_cb(const void *src, const size_t size, const size_t distance, void *data) {
+    return owf_binary_writer_buffer_patch_cb(src, size, distance, &((owf_growable_t *)data)->buffer);
+}
+
+void owf_binary_writer_init_growable(owf_binary_writer_t *binary, owf_growable_t *growable, owf_alloc_t *alloc, owf_error_t *error) {
+    owf_binary_writer_init(binary, alloc, error, owf_binary_writer_growable_write_cb, growable);
+    binary->writer.patch = owf_binary_writer_growable_patch_cb;
+    binary->buffer = &growable->buffer;
+    binary->growable = growable;
+}
+
+static bool owf_binary_writer_buffered_write_cb(const void *src, const size_t size, void *data) {
+    return owf_buffered_write((owf_buffered_t *)data, src, size);
+}
+
+static bool owf_binary_writer_buffered_patch_cb(const void *src, const size_t size, const size_t distance, void *data) {
+    return owf_buffered_patch((owf_buffered_t *)data, src, size, distance);
+}
+
+void owf_binary_writer_init_buffered(owf_binary_writer_t *binary, owf_buffered_t *buffered, owf_alloc_t *alloc, owf_error_t *error) {
+    owf_binary_writer_init(binary, alloc, error, owf_binary_writer_buffered_write_cb, buffered);
+    if (buffered->patch != NULL) {
+        binary->writer.patch = owf_binary_writer_buffered_patch_cb;
+    }
+}
+
+static bool owf_binary_writer_iovec_write_cb(const void *src, const size_t size, void *data) {
+    return owf_iovec_copy((owf_iovec_t *)data, src, size);
+}
+
+static bool owf_binary_writer_iovec_patch_cb(const void *src, const size_t size, const size_t distance, void *data) {
+    return owf_iovec_patch((owf_iovec_t *)data, src, size, distance);
+}
+
+void owf_binary_writer_init_iovec(owf_binary_writer_t *binary, owf_iovec_t *iovec, owf_alloc_t *alloc, owf_error_t *error) {
+    owf_binary_writer_init(binary, alloc, error, owf_binary_writer_iovec_write_cb, iovec);
+    binary->writer.patch = owf_binary_writer_iovec_patch_cb;
+    binary->iovec = iovec;
+}
+
+/* Writes a placeholder length prefix, to be filled in by <owf_binary_writer_backpatch>.
+ * @binary The writer
+ * @slot A pointer to store the position of the placeholder in
+ *
+ * @return True if the write was successful, false otherwise
+ */
+static bool owf_binary_writer_reserve(owf_binary_writer_t *binary, size_t *slot) {
+    *slot = binary->position;
+    return owf_binary_writer_write_u32(binary, 0);
+}
+
+/* Fills in a placeholder length prefix with the number of bytes written since it.
+ * @binary The writer
+ * @slot The position of the placeholder
+ *
+ * @return True if the patch was successful, false otherwise
+ */
+static bool owf_binary_writer_backpatch(owf_binary_writer_t *binary, size_t slot) {
+    const size_t distance = binary->position - slot;
+    uint32_t length;
+
+    if (OWF_NOEXPECT(distance - sizeof(uint32_t) > UINT32_MAX)) {
+        OWF_ERROR_SETF(binary->writer.error, "segment too long (" OWF_PRINT_SIZE " bytes)", distance - sizeof(uint32_t));
+        return false;
+    } else if (OWF_NOEXPECT((distance - sizeof(uint32_t)) % sizeof(uint32_t) != 0)) {
+        OWF_ERROR_SETF(binary->writer.error, "length `" OWF_PRINT_SIZE "` was not a multiple of " OWF_PRINT_SIZE " bytes", distance - sizeof(uint32_t), sizeof(uint32_t));
+        return false;
+    }
+
+    length = (uint32_t)(distance - sizeof(uint32_t));
+    OWF_NET32(length);
+    if (OWF_NOEXPECT(!binary->writer.patch(&length, sizeof(length), distance, binary->writer.data))) {
+        OWF_ERROR_SETF(binary->writer.error, "patch error (" OWF_PRINT_SIZE " bytes back)", distance);
+        return false;
+    }
+    return true;
 }
 
 bool owf_binary_write_header(owf_binary_writer_t *binary, owf_package_t *owf, uint32_t size) {
@@ -60,7 +164,16 @@ bool owf_binary_write_header(owf_binary_writer_t *binary, owf_package_t *owf, ui
 
 bool owf_binary_write(owf_binary_writer_t *binary, owf_package_t *owf) {
     uint32_t size;
-    if (OWF_NOEXPECT(
+    size_t slot;
+
+    if (binary->writer.patch != NULL) {
+        /* Write the magic and a placeholder, and fill it in at the end */
+        if (OWF_NOEXPECT(
+            !owf_binary_writer_write_u32(binary, OWF_MAGIC) ||
+            !owf_binary_writer_reserve(binary, &slot))) {
+            return false;
+        }
+    } else if (OWF_NOEXPECT(
         !owf_package_size(owf, binary->writer.error, &size) ||
         !owf_binary_write_header(binary, owf, size))) {
         return false;
@@ -73,7 +186,7 @@ bool owf_binary_write(owf_binary_writer_t *binary, owf_package_t *owf) {
         }
     }
 
-    return true;
+    return binary->writer.patch == NULL || owf_binary_writer_backpatch(binary, slot);
 }
 
 bool owf_binary_write_buffer(owf_binary_writer_t *binary, owf_package_t *owf, owf_buffer_t *buf, owf_alloc_t *alloc, owf_error_t *error) {
@@ -93,6 +206,135 @@ bool owf_binary_write_buffer(owf_binary_writer_t *binary, owf_package_t *owf, ow
     }
 }
 
+/* A run of channels encoded by one thread of <owf_binary_write_parallel>. */
+typedef struct owf_binary_writer_worker {
+    /* The worker's writer */
+    owf_binary_writer_t binary;
+
+    /* The part of the output buffer the run goes in */
+    owf_buffer_t buf;
+
+    /* The channels */
+    owf_channel_t *channels;
+    uint32_t count;
+
+    /* The worker's error context */
+    owf_error_t error;
+
+    /* The thread, if one was started */
+    owf_thread_t thread;
+    bool started;
+
+    /* Whether the run was encoded */
+    bool ok;
+} owf_binary_writer_worker_t;
+
+static void owf_binary_writer_worker_run(void *ptr) {
+    owf_binary_writer_worker_t *worker = (owf_binary_writer_worker_t *)ptr;
+
+    worker->ok = true;
+    for (uint32_t i = 0; i < worker->count && worker->ok; i++) {
+        worker->ok = owf_binary_writer_write_channel(&worker->binary, &worker->channels[i]);
+    }
+
+    /* The run has to fill its region exactly, or the sizes were wrong */
+    if (worker->ok && OWF_NOEXPECT(worker->buf.position != worker->buf.length)) {
+        OWF_ERROR_SETF(&worker->error, "channels took " OWF_PRINT_SIZE " bytes, not " OWF_PRINT_SIZE, worker->buf.position, worker->buf.length);
+        worker->ok = false;
+    }
+}
+
+bool owf_binary_write_parallel(owf_binary_writer_t *binary, owf_package_t *owf, uint32_t nthreads) {
+    owf_buffer_t *buf = binary->buffer;
+    owf_binary_writer_worker_t *workers = NULL;
+    const uint32_t nchannels = OWF_ARRAY_LEN(owf->channels);
+    uint32_t size = 0, nworkers, first, last = 0, offset = 0, end = 0, start;
+    uint8_t *base;
+    bool ok = false;
+
+    if (nthreads == 0) {
+        nthreads = owf_thread_count();
+    }
+
+    nworkers = OWF_MIN(nthreads, nchannels);
+    if (buf == NULL || nworkers < 2) {
+        return owf_binary_write(binary, owf);
+    }
+
+    /* Size everything now, so the workers only ever read memoized sizes */
+    if (OWF_NOEXPECT(!owf_package_size(owf, binary->writer.error, &size))) {
+        return false;
+    } else if (binary->growable != NULL && OWF_NOEXPECT(!owf_growable_reserve(binary->growable, size))) {
+        return false;
+    } else if (OWF_NOEXPECT(size > buf->length - buf->position)) {
+        OWF_ERROR_SETF(binary->writer.error, "write error (" OWF_PRINT_U32 " bytes)", size);
+        return false;
+    } else if (OWF_NOEXPECT(!owf_binary_write_header(binary, owf, size))) {
+        return false;
+    } else if ((workers = owf_malloc(binary->writer.alloc, binary->writer.error, nworkers * sizeof(owf_binary_writer_worker_t))) == NULL) {
+        return false;
+    }
+
+    /* Give each worker a contiguous run of channels ending near its share of the bytes, leaving at least one channel for each later worker */
+    base = (uint8_t *)buf->ptr + buf->position;
+    size -= sizeof(uint32_t) * 2;
+    for (uint32_t i = 0; i < nworkers; i++) {
+        owf_binary_writer_worker_t *worker = &workers[i];
+        const uint32_t target = (uint32_t)(((uint64_t)size * (i + 1)) / nworkers);
+        uint32_t channel_size = 0;
+
+        first = last;
+        start = offset;
+        do {
+            /* Sizes are memoized, so this can't fail */
+            owf_channel_size(OWF_ARRAY_PTR(owf->channels, owf_channel_t, last++), binary->writer.error, &channel_size);
+            end = offset += channel_size;
+            if (last < nchannels) {
+                owf_channel_size(OWF_ARRAY_PTR(owf->channels, owf_channel_t, last), binary->writer.error, &channel_size);
+            }
+        } while (last < nchannels - (nworkers - i - 1) && offset + channel_size <= target);
+
+        owf_error_init(&worker->error);
+        owf_buffer_init(&worker->buf, base + start, end - start);
+        owf_binary_writer_init_buffer(&worker->binary, &worker->buf, binary->writer.alloc, &worker->error);
+        worker->channels = OWF_ARRAY_PTR(owf->channels, owf_channel_t, first);
+        worker->count = last - first;
+        worker->started = worker->ok = false;
+    }
+
+    /* Start the others, and encode the first run here. If a thread can't be started, encode its run here too. */
+    for (uint32_t i = 1; i < nworkers; i++) {
+        if (!(workers[i].started = owf_thread_create(&workers[i].thread, &workers[i].error, owf_binary_writer_worker_run, &workers[i]))) {
+            owf_error_init(&workers[i].error);
+        }
+    }
+    owf_binary_writer_worker_run(&workers[0]);
+    for (uint32_t i = 1; i < nworkers; i++) {
+        if (workers[i].started) {
+            owf_thread_join(&workers[i].thread);
+        } else {
+            owf_binary_writer_worker_run(&workers[i]);
+        }
+    }
+
+    /* Report the first error */
+    ok = true;
+    for (uint32_t i = 0; i < nworkers && ok; i++) {
+        if (OWF_NOEXPECT(!workers[i].ok)) {
+            *binary->writer.error = workers[i].error;
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        buf->position += size;
+        binary->position += size;
+    }
+
+    owf_free_sized(binary->writer.alloc, workers, nworkers * sizeof(owf_binary_writer_worker_t));
+    return ok;
+}
+
 bool owf_binary_writer_write_channel_header(owf_binary_writer_t *binary, owf_channel_t *channel, uint32_t size) {
     if (OWF_NOEXPECT(
         !owf_binary_writer_write_size(binary, size - sizeof(uint32_t)) ||
@@ -105,7 +347,15 @@ bool owf_binary_writer_write_channel_header(owf_binary_writer_t *binary, owf_cha
 
 bool owf_binary_writer_write_channel(owf_binary_writer_t *binary, owf_channel_t *channel) {
     uint32_t size;
-    if (OWF_NOEXPECT(
+    size_t slot;
+
+    if (binary->writer.patch != NULL) {
+        if (OWF_NOEXPECT(
+            !owf_binary_writer_reserve(binary, &slot) ||
+            !owf_binary_writer_write_str(binary, &channel->id))) {
+            return false;
+        }
+    } else if (OWF_NOEXPECT(
         !owf_channel_size(channel, binary->writer.error, &size) ||
         !owf_binary_writer_write_channel_header(binary, channel, size))) {
         return false;
@@ -118,7 +368,7 @@ bool owf_binary_writer_write_channel(owf_binary_writer_t *binary, owf_channel_t
         }
     }
 
-    return true;
+    return binary->writer.patch == NULL || owf_binary_writer_backpatch(binary, slot);
 }
 
 bool owf_binary_writer_write_namespace_header(owf_binary_writer_t *binary, owf_namespace_t *ns, uint32_t size) {
@@ -134,9 +384,61 @@ bool owf_binary_writer_write_namespace_header(owf_binary_writer_t *binary, owf_n
     return true;
 }
 
+/* Writes an <owf_namespace_t> in one pass, back-patching its length prefixes.
+ * @binary The binary writer
+ * @ns The namespace
+ *
+ * @return True if the write was successful, false otherwise
+ */
+static bool owf_binary_writer_write_namespace_patched(owf_binary_writer_t *binary, owf_namespace_t *ns) {
+    size_t slot, children;
+
+    if (OWF_NOEXPECT(
+        !owf_binary_writer_reserve(binary, &slot) ||
+        !owf_binary_writer_write_time(binary, ns->t0) ||
+        !owf_binary_writer_write_duration(binary, ns->dt) ||
+        !owf_binary_writer_write_str(binary, &ns->id))) {
+        return false;
+    }
+
+    /* Write the signals, events, and alarms */
+    if (OWF_NOEXPECT(!owf_binary_writer_reserve(binary, &children))) {
+        return false;
+    }
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(ns->signals); i++) {
+        if (OWF_NOEXPECT(!owf_binary_writer_write_signal(binary, OWF_ARRAY_PTR(ns->signals, owf_signal_t, i)))) {
+            return false;
+        }
+    }
+
+    if (OWF_NOEXPECT(!owf_binary_writer_backpatch(binary, children) || !owf_binary_writer_reserve(binary, &children))) {
+        return false;
+    }
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(ns->events); i++) {
+        if (OWF_NOEXPECT(!owf_binary_writer_write_event(binary, ns, OWF_ARRAY_PTR(ns->events, owf_event_t, i)))) {
+            return false;
+        }
+    }
+
+    if (OWF_NOEXPECT(!owf_binary_writer_backpatch(binary, children) || !owf_binary_writer_reserve(binary, &children))) {
+        return false;
+    }
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(ns->alarms); i++) {
+        if (OWF_NOEXPECT(!owf_binary_writer_write_alarm(binary, ns, OWF_ARRAY_PTR(ns->alarms, owf_alarm_t, i)))) {
+            return false;
+        }
+    }
+
+    return OWF_EXPECT(owf_binary_writer_backpatch(binary, children) && owf_binary_writer_backpatch(binary, slot));
+}
+
 bool owf_binary_writer_write_namespace(owf_binary_writer_t *binary, owf_namespace_t *ns) {
     uint32_t size = 0, signals_size = 0, events_size = 0, alarms_size = 0;
 
+    if (binary->writer.patch != NULL) {
+        return owf_binary_writer_write_namespace_patched(binary, ns);
+    }
+
     if (OWF_NOEXPECT(
         !owf_namespace_size(ns, binary->writer.error, &size) ||
         !owf_binary_writer_write_namespace_header(binary, ns, size))) {
@@ -274,13 +576,38 @@ bool owf_binary_writer_write_alarm(owf_binary_writer_t *binary, owf_namespace_t
     return owf_binary_writer_write_alarm_header(binary, ns, alarm);
 }
 
-bool owf_binary_writer_write_samples(owf_binary_writer_t *binary, const double *ptr, uint32_t count) {
-    /* Write the samples */
+/* Writes samples without a length prefix.
+ * @binary The writer
+ * @ptr A pointer to samples
+ * @count The number of samples
+ *
+ * @return True if the write was successful, false otherwise
+ */
+static bool owf_binary_writer_write_doubles(owf_binary_writer_t *binary, const double *ptr, uint32_t count) {
     owf_double_union_t buffer[OWF_BINARY_WRITER_BYTESWAP_BUFFER_LEN];
-    uint32_t i = count, j, stride;
+    uint32_t i = count, stride;
     OWF_ARITH_SAFE_MUL32(binary->writer.error, i, sizeof(double));
-    if (OWF_NOEXPECT(!owf_binary_writer_write_size(binary, i))) {
-        return false;
+
+    if (binary->iovec != NULL) {
+        /* Reference the samples, or swap them into scratch */
+        if (OWF_NOEXPECT(!owf_iovec_samples(binary->iovec, ptr, count))) {
+            return false;
+        }
+        binary->position += i;
+        return true;
+    } else if (binary->buffer != NULL) {
+        /* Byteswap straight into the output buffer */
+        owf_buffer_t *buf = binary->buffer;
+        if (binary->growable != NULL && OWF_NOEXPECT(!owf_growable_reserve(binary->growable, i))) {
+            return false;
+        } else if (OWF_NOEXPECT(i > buf->length - buf->position)) {
+            OWF_ERROR_SETF(binary->writer.error, "write error (" OWF_PRINT_U32 " bytes)", i);
+            return false;
+        }
+        OWF_NET64_ARRAY((uint8_t *)buf->ptr + buf->position, ptr, count);
+        buf->position += i;
+        binary->position += i;
+        return true;
     }
 
     for (i = 0; i < count; i += stride) {
@@ -288,10 +615,7 @@ bool owf_binary_writer_write_samples(owf_binary_writer_t *binary, const double *
         stride = OWF_MIN(count - i, OWF_BINARY_WRITER_BYTESWAP_BUFFER_LEN);
 
         /* Byteswap the chunk */
-        for (j = 0; j < stride; j++) {
-            buffer[j].f64 = ptr[i + j];
-            OWF_NET64(buffer[j].u64);
-        }
+        OWF_NET64_ARRAY(buffer, ptr + i, stride);
 
         /* Bulk write the chunk to the buffer */
         OWF_BINARY_SAFE_WRITE(binary, &buffer, stride * sizeof(double));
@@ -300,6 +624,62 @@ bool owf_binary_writer_write_samples(owf_binary_writer_t *binary, const double *
     return true;
 }
 
+bool owf_binary_writer_write_samples(owf_binary_writer_t *binary, const double *ptr, uint32_t count) {
+    uint32_t size = count;
+    OWF_ARITH_SAFE_MUL32(binary->writer.error, size, sizeof(double));
+    return OWF_EXPECT(owf_binary_writer_write_size(binary, size) && owf_binary_writer_write_doubles(binary, ptr, count));
+}
+
+/* Writes the bytes of a string, then its null terminator and padding.
+ * @binary The writer
+ * @ptr The bytes
+ * @length The number of bytes, not including a null terminator
+ * @full_size The size of the string without its length prefix
+ *
+ * @return True if the write was successful, false otherwise
+ */
+static bool owf_binary_writer_write_chars(owf_binary_writer_t *binary, const char *ptr, uint32_t length, uint32_t full_size) {
+    if (OWF_EXPECT(full_size > 0)) {
+        /* Write the string, referencing it if we're building a scatter-gather list */
+        if (binary->iovec != NULL) {
+            if (OWF_NOEXPECT(!owf_iovec_reference(binary->iovec, ptr, length))) {
+                return false;
+            }
+            binary->position += length;
+        } else {
+            OWF_BINARY_SAFE_WRITE(binary, ptr, length);
+        }
+
+        /* Subtract what we just wrote */
+        OWF_ARITH_SAFE_SUB32(binary->writer.error, full_size, length);
+    }
+
+    /* Write the null terminator and padding in as few writes as possible */
+    while (full_size > 0) {
+        uint32_t stride = OWF_MIN(full_size, (uint32_t)sizeof(owf_binary_writer_zeros));
+        OWF_BINARY_SAFE_WRITE(binary, owf_binary_writer_zeros, stride);
+        full_size -= stride;
+    }
+    return true;
+}
+
+bool owf_binary_writer_write_cstr(owf_binary_writer_t *binary, const char *str) {
+    size_t length = strlen(str);
+    uint32_t full_size = 0;
+
+    if (OWF_NOEXPECT(length >= UINT32_MAX - sizeof(uint32_t))) {
+        OWF_ERROR_SETF(binary->writer.error, "string too long (" OWF_PRINT_SIZE " bytes)", length);
+        return false;
+    } else if (length > 0) {
+        /* Count the null terminator, then pad to 4 bytes */
+        full_size = ((uint32_t)length + sizeof(uint32_t)) & ~(uint32_t)(sizeof(uint32_t) - 1);
+    }
+
+    return OWF_EXPECT(
+        owf_binary_writer_write_size(binary, full_size) &&
+        owf_binary_writer_write_chars(binary, str, (uint32_t)length, full_size));
+}
+
 bool owf_binary_writer_write_str(owf_binary_writer_t *binary, owf_str_t *str) {
     /* Figure out the string's size */
     uint32_t full_size = 0;
@@ -309,33 +689,212 @@ bool owf_binary_writer_write_str(owf_binary_writer_t *binary, owf_str_t *str) {
 
     /* Write it */
     full_size -= sizeof(uint32_t);
-    if (OWF_NOEXPECT(!owf_binary_writer_write_size(binary, full_size))) {
-        return false;
+    return OWF_EXPECT(
+        owf_binary_writer_write_size(binary, full_size) &&
+        owf_binary_writer_write_chars(binary, OWF_STR_PTR(*str), full_size > 0 ? owf_str_length(str) : 0, full_size));
+}
+
+bool owf_binary_writer_write_bytes(owf_binary_writer_t *binary, const void *ptr, size_t size) {
+    if (binary->iovec != NULL) {
+        /* Reference them instead of copying */
+        if (OWF_NOEXPECT(!owf_iovec_reference(binary->iovec, ptr, size))) {
+            return false;
+        }
+        binary->position += size;
+        return true;
     }
 
-    if (OWF_EXPECT(full_size > 0)) {
-        /* Calculate the number of null bytes to write after the string */
-        uint32_t length = owf_str_length(str);
+    OWF_BINARY_SAFE_WRITE(binary, ptr, size);
+    return true;
+}
 
-        /* Write the string and a null-terminator */
-        OWF_BINARY_SAFE_WRITE(binary, OWF_STR_PTR(*str), length);
-        owf_binary_writer_write_u8(binary, 0);
+/* Checks that a stream is at the expected depth.
+ * @binary The writer
+ * @depth The <owf_binary_stream_depth_t> the call needs
+ * @what What the caller is doing, for errors
+ *
+ * @return True if the stream is at that depth, false otherwise
+ */
+static bool owf_binary_writer_stream_at(owf_binary_writer_t *binary, uint8_t depth, const char *what) {
+    static const char *const names[OWF_BINARY_STREAM_DEPTHS] = {"outside a package", "in a package", "in a channel", "in a namespace", "in a signal"};
+    if (OWF_NOEXPECT(binary->stream.depth != depth)) {
+        OWF_ERROR_SETF(binary->writer.error, "can't %s %s, only %s", what, names[binary->stream.depth], names[depth]);
+        return false;
+    }
+    return true;
+}
 
-        /* Subtract what we just wrote */
-        OWF_ARITH_SAFE_ADD32(binary->writer.error, length, 1);
-        OWF_ARITH_SAFE_SUB32(binary->writer.error, full_size, length);
+/* Moves a streamed namespace on to one of its arrays, closing earlier arrays, empty or not.
+ * @binary The writer
+ * @section The <owf_binary_stream_section_t> to write
+ *
+ * @return True if the write was successful, false otherwise
+ */
+static bool owf_binary_writer_stream_section(owf_binary_writer_t *binary, uint8_t section) {
+    owf_binary_stream_t *stream = &binary->stream;
+
+    if (OWF_NOEXPECT(stream->section > section)) {
+        OWF_ERROR_SET(binary->writer.error, "signals, events, and alarms must be written in that order");
+        return false;
     }
 
-    /* Write the null padding */
-    while (full_size > 0) {
-        if (OWF_NOEXPECT(!owf_binary_writer_write_u8(binary, 0))) {
+    for (; stream->section < section; stream->section++) {
+        if (OWF_NOEXPECT(
+            (stream->section != OWF_BINARY_STREAM_HEADER && !owf_binary_writer_backpatch(binary, stream->slots[0])) ||
+            !owf_binary_writer_reserve(binary, &stream->slots[0]))) {
             return false;
         }
-        full_size--;
     }
     return true;
 }
 
+bool owf_binary_writer_begin_package(owf_binary_writer_t *binary) {
+    if (!owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_NONE, "begin a package")) {
+        return false;
+    } else if (OWF_NOEXPECT(binary->writer.patch == NULL)) {
+        OWF_ERROR_SET(binary->writer.error, "can't stream a package to a target that can't be patched");
+        return false;
+    } else if (OWF_NOEXPECT(
+        !owf_binary_writer_write_u32(binary, OWF_MAGIC) ||
+        !owf_binary_writer_reserve(binary, &binary->stream.slots[OWF_BINARY_STREAM_PACKAGE]))) {
+        return false;
+    }
+
+    binary->stream.depth = OWF_BINARY_STREAM_PACKAGE;
+    return true;
+}
+
+bool owf_binary_writer_end_package(owf_binary_writer_t *binary) {
+    if (!owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_PACKAGE, "end a package") ||
+        OWF_NOEXPECT(!owf_binary_writer_backpatch(binary, binary->stream.slots[OWF_BINARY_STREAM_PACKAGE]))) {
+        return false;
+    }
+
+    binary->stream.depth = OWF_BINARY_STREAM_NONE;
+    return true;
+}
+
+bool owf_binary_writer_begin_channel(owf_binary_writer_t *binary, const char *id) {
+    if (!owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_PACKAGE, "begin a channel") ||
+        OWF_NOEXPECT(
+            !owf_binary_writer_reserve(binary, &binary->stream.slots[OWF_BINARY_STREAM_CHANNEL]) ||
+            !owf_binary_writer_write_cstr(binary, id))) {
+        return false;
+    }
+
+    binary->stream.depth = OWF_BINARY_STREAM_CHANNEL;
+    return true;
+}
+
+bool owf_binary_writer_end_channel(owf_binary_writer_t *binary) {
+    if (!owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_CHANNEL, "end a channel") ||
+        OWF_NOEXPECT(!owf_binary_writer_backpatch(binary, binary->stream.slots[OWF_BINARY_STREAM_CHANNEL]))) {
+        return false;
+    }
+
+    binary->stream.depth = OWF_BINARY_STREAM_PACKAGE;
+    return true;
+}
+
+bool owf_binary_writer_begin_namespace(owf_binary_writer_t *binary, owf_time_t t0, owf_duration_t dt, const char *id) {
+    if (!owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_CHANNEL, "begin a namespace") ||
+        OWF_NOEXPECT(
+            !owf_binary_writer_reserve(binary, &binary->stream.slots[OWF_BINARY_STREAM_NAMESPACE]) ||
+            !owf_binary_writer_write_time(binary, t0) ||
+            !owf_binary_writer_write_duration(binary, dt) ||
+            !owf_binary_writer_write_cstr(binary, id))) {
+        return false;
+    }
+
+    binary->stream.depth = OWF_BINARY_STREAM_NAMESPACE;
+    binary->stream.section = OWF_BINARY_STREAM_HEADER;
+    binary->stream.t0 = t0;
+    binary->stream.dt = dt;
+    return true;
+}
+
+bool owf_binary_writer_end_namespace(owf_binary_writer_t *binary) {
+    if (!owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_NAMESPACE, "end a namespace") ||
+        OWF_NOEXPECT(
+            !owf_binary_writer_stream_section(binary, OWF_BINARY_STREAM_ALARMS) ||
+            !owf_binary_writer_backpatch(binary, binary->stream.slots[0]) ||
+            !owf_binary_writer_backpatch(binary, binary->stream.slots[OWF_BINARY_STREAM_NAMESPACE]))) {
+        return false;
+    }
+
+    binary->stream.depth = OWF_BINARY_STREAM_CHANNEL;
+    return true;
+}
+
+bool owf_binary_writer_begin_signal(owf_binary_writer_t *binary, const char *id, const char *unit) {
+    if (!owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_NAMESPACE, "begin a signal") ||
+        OWF_NOEXPECT(
+            !owf_binary_writer_stream_section(binary, OWF_BINARY_STREAM_SIGNALS) ||
+            !owf_binary_writer_write_cstr(binary, id) ||
+            !owf_binary_writer_write_cstr(binary, unit) ||
+            !owf_binary_writer_reserve(binary, &binary->stream.slots[OWF_BINARY_STREAM_SIGNAL]))) {
+        return false;
+    }
+
+    binary->stream.depth = OWF_BINARY_STREAM_SIGNAL;
+    return true;
+}
+
+bool owf_binary_writer_append_samples(owf_binary_writer_t *binary, const double *ptr, uint32_t count) {
+    return owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_SIGNAL, "append samples") &&
+        OWF_EXPECT(owf_binary_writer_write_doubles(binary, ptr, count));
+}
+
+bool owf_binary_writer_end_signal(owf_binary_writer_t *binary) {
+    if (!owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_SIGNAL, "end a signal") ||
+        OWF_NOEXPECT(!owf_binary_writer_backpatch(binary, binary->stream.slots[OWF_BINARY_STREAM_SIGNAL]))) {
+        return false;
+    }
+
+    binary->stream.depth = OWF_BINARY_STREAM_NAMESPACE;
+    return true;
+}
+
+/* Checks that the current streamed namespace covers a time.
+ * @binary The writer
+ * @t0 The time
+ * @what What is at that time, for errors
+ *
+ * @return True if the namespace covers the time, false otherwise
+ */
+static bool owf_binary_writer_stream_covers(owf_binary_writer_t *binary, owf_time_t t0, const char *what) {
+    const owf_time_t start = binary->stream.t0, end = start + binary->stream.dt;
+    if (OWF_NOEXPECT(t0 < start || t0 >= end)) {
+        OWF_ERROR_SETF(binary->writer.error, "time interval for namespace [" OWF_PRINT_TIME ", " OWF_PRINT_TIME "):" OWF_PRINT_TIME " did not cover %s at " OWF_PRINT_TIME,
+            start, end, binary->stream.dt, what, t0);
+        return false;
+    }
+    return true;
+}
+
+bool owf_binary_writer_append_event(owf_binary_writer_t *binary, owf_time_t t0, const char *message) {
+    return owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_NAMESPACE, "append an event") &&
+        owf_binary_writer_stream_covers(binary, t0, "event") &&
+        OWF_EXPECT(
+            owf_binary_writer_stream_section(binary, OWF_BINARY_STREAM_EVENTS) &&
+            owf_binary_writer_write_time(binary, t0) &&
+            owf_binary_writer_write_cstr(binary, message));
+}
+
+bool owf_binary_writer_append_alarm(owf_binary_writer_t *binary, owf_time_t t0, owf_duration_t dt, uint8_t level, uint8_t volume, const char *type, const char *message) {
+    return owf_binary_writer_stream_at(binary, OWF_BINARY_STREAM_NAMESPACE, "append an alarm") &&
+        owf_binary_writer_stream_covers(binary, t0, "alarm") &&
+        OWF_EXPECT(
+            owf_binary_writer_stream_section(binary, OWF_BINARY_STREAM_ALARMS) &&
+            owf_binary_writer_write_time(binary, t0) &&
+            owf_binary_writer_write_duration(binary, dt) &&
+            owf_binary_writer_write_u8(binary, level) &&
+            owf_binary_writer_write_u8(binary, volume) &&
+            owf_binary_writer_write_u16(binary, 0) &&
+            owf_binary_writer_write_cstr(binary, type) &&
+            owf_binary_writer_write_cstr(binary, message));
+}
+
 bool owf_binary_writer_write_double(owf_binary_writer_t *binary, double val) {
     owf_double_union_t network = {.f64 = val};
     OWF_NET64(network.u64);
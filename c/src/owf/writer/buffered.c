@@ -0,0 +1,97 @@
+#include <owf/writer/buffered.h>
+#include <owf/platform.h>
+
+void owf_buffered_init(owf_buffered_t *buffered, owf_alloc_t *alloc, owf_error_t *error, owf_write_cb_t write, owf_patch_cb_t patch, void *data, size_t block_size) {
+    buffered->alloc = alloc;
+    buffered->error = error;
+    buffered->write = write;
+    buffered->patch = patch;
+    buffered->data = data;
+    buffered->ptr = NULL;
+    buffered->length = 0;
+    buffered->block_size = block_size > 0 ? block_size : OWF_BUFFERED_DEFAULT_BLOCK_SIZE;
+    buffered->low = buffered->block_size;
+    buffered->high = buffered->block_size;
+}
+
+bool owf_buffered_set_watermarks(owf_buffered_t *buffered, size_t low, size_t high) {
+    if (OWF_NOEXPECT(low > high || high > buffered->block_size || high == 0)) {
+        OWF_ERROR_SETF(buffered->error, "invalid watermarks (" OWF_PRINT_SIZE " low, " OWF_PRINT_SIZE " high, " OWF_PRINT_SIZE " block size)", low, high, buffered->block_size);
+        return false;
+    }
+    buffered->low = low;
+    buffered->high = high;
+    return true;
+}
+
+/* Writes out the oldest buffered bytes until at most `keep` remain.
+ * @buffered The buffered writer
+ * @keep The number of bytes to keep
+ *
+ * @return True if successful, false otherwise
+ */
+static bool owf_buffered_drain(owf_buffered_t *buffered, size_t keep) {
+    size_t size;
+    if (buffered->length <= keep) {
+        return true;
+    }
+
+    size = buffered->length - keep;
+    if (OWF_NOEXPECT(!buffered->write(buffered->ptr, size, buffered->data))) {
+        OWF_ERROR_SETF(buffered->error, "write error (" OWF_PRINT_SIZE " bytes)", size);
+        return false;
+    }
+
+    memmove(buffered->ptr, buffered->ptr + size, keep);
+    buffered->length = keep;
+    return true;
+}
+
+bool owf_buffered_write(owf_buffered_t *buffered, const void *src, size_t size) {
+    if (size >= buffered->block_size) {
+        /* Too big to be worth copying; keep the output in order and write it straight through */
+        if (OWF_NOEXPECT(!owf_buffered_drain(buffered, 0))) {
+            return false;
+        } else if (OWF_NOEXPECT(!buffered->write(src, size, buffered->data))) {
+            OWF_ERROR_SETF(buffered->error, "write error (" OWF_PRINT_SIZE " bytes)", size);
+            return false;
+        }
+        return true;
+    } else if (OWF_NOEXPECT(buffered->ptr == NULL) &&
+        (buffered->ptr = owf_malloc(buffered->alloc, buffered->error, buffered->block_size)) == NULL) {
+        return false;
+    } else if (size > buffered->block_size - buffered->length && OWF_NOEXPECT(!owf_buffered_drain(buffered, 0))) {
+        return false;
+    }
+
+    memcpy(buffered->ptr + buffered->length, src, size);
+    buffered->length += size;
+    return buffered->length < buffered->high || owf_buffered_drain(buffered, buffered->low);
+}
+
+bool owf_buffered_patch(owf_buffered_t *buffered, const void *src, size_t size, size_t distance) {
+    if (OWF_NOEXPECT(size > distance)) {
+        return false;
+    } else if (distance <= buffered->length) {
+        /* Still buffered */
+        memcpy(buffered->ptr + buffered->length - distance, src, size);
+        return true;
+    }
+
+    /* Already written, or straddling the buffer; hand it downstream */
+    return buffered->patch != NULL &&
+        owf_buffered_drain(buffered, 0) &&
+        buffered->patch(src, size, distance, buffered->data);
+}
+
+bool owf_buffered_flush(owf_buffered_t *buffered) {
+    return owf_buffered_drain(buffered, 0);
+}
+
+void owf_buffered_destroy(owf_buffered_t *buffered) {
+    if (buffered->ptr != NULL) {
+        owf_free_sized(buffered->alloc, buffered->ptr, buffered->block_size);
+        buffered->ptr = NULL;
+    }
+    buffered->length = 0;
+}
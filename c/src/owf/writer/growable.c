@@ -0,0 +1,71 @@
+#include <owf/writer/growable.h>
+#include <owf/platform.h>
+
+void owf_growable_init(owf_growable_t *growable, owf_alloc_t *alloc, owf_error_t *error, size_t chunk_size) {
+    growable->alloc = alloc;
+    growable->error = error;
+    owf_buffer_init(&growable->buffer, NULL, 0);
+    growable->chunk_size = chunk_size;
+}
+
+bool owf_growable_reserve(owf_growable_t *growable, size_t size) {
+    owf_buffer_t *buf = &growable->buffer;
+    size_t needed, capacity;
+    void *ptr = buf->ptr;
+
+    if (OWF_EXPECT(size <= buf->length - buf->position)) {
+        return true;
+    } else if (OWF_NOEXPECT(size > SIZE_MAX - buf->position)) {
+        OWF_ERROR_SETF(growable->error, "buffer overflow (" OWF_PRINT_SIZE " bytes)", size);
+        return false;
+    }
+
+    needed = buf->position + size;
+    if (growable->chunk_size > 0) {
+        /* Round up to a whole number of chunks */
+        size_t rem = needed % growable->chunk_size;
+        capacity = rem > 0 && growable->chunk_size - rem <= SIZE_MAX - needed ? needed + (growable->chunk_size - rem) : needed;
+    } else {
+        capacity = buf->length <= SIZE_MAX / 2 ? buf->length * 2 : SIZE_MAX;
+        capacity = OWF_MAX(capacity, OWF_GROWABLE_MIN_CAPACITY);
+    }
+
+    /* Don't overshoot the allocator's limit unless we have to */
+    capacity = OWF_MIN(capacity, growable->alloc->max_alloc);
+    capacity = OWF_MAX(capacity, needed);
+
+    if (OWF_NOEXPECT(!owf_realloc_sized(growable->alloc, growable->error, &ptr, buf->length, capacity))) {
+        return false;
+    }
+
+    buf->ptr = ptr;
+    buf->length = capacity;
+    return true;
+}
+
+bool owf_growable_write(owf_growable_t *growable, const void *src, size_t size) {
+    owf_buffer_t *buf = &growable->buffer;
+    if (OWF_NOEXPECT(!owf_growable_reserve(growable, size))) {
+        return false;
+    } else if (size > 0) {
+        memcpy((uint8_t *)buf->ptr + buf->position, src, size);
+        buf->position += size;
+    }
+    return true;
+}
+
+void owf_growable_clear(owf_growable_t *growable) {
+    growable->buffer.position = 0;
+}
+
+void owf_growable_take(owf_growable_t *growable, owf_buffer_t *buf) {
+    owf_buffer_init(buf, growable->buffer.ptr, growable->buffer.position);
+    owf_buffer_init(&growable->buffer, NULL, 0);
+}
+
+void owf_growable_destroy(owf_growable_t *growable) {
+    if (growable->buffer.ptr != NULL) {
+        owf_free_sized(growable->alloc, growable->buffer.ptr, growable->buffer.length);
+    }
+    owf_buffer_init(&growable->buffer, NULL, 0);
+}
@@ -0,0 +1,275 @@
+#include <owf/writer/iovec.h>
+#include <owf/byteswap.h>
+
+#if OWF_PLATFORM_IS_GNU
+#include <errno.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#endif
+
+void owf_iovec_init(owf_iovec_t *iovec, owf_alloc_t *alloc, owf_error_t *error, uint32_t flags) {
+    iovec->alloc = alloc;
+    iovec->error = error;
+    owf_array_init(&iovec->segments);
+    owf_array_init(&iovec->scratch);
+    iovec->length = 0;
+    iovec->threshold = OWF_IOVEC_DEFAULT_THRESHOLD;
+    iovec->flags = flags;
+}
+
+/* Appends a segment to an <owf_iovec_t>.
+ * @iovec The list
+ * @segment The segment, whose position is filled in
+ *
+ * @return True if successful, false otherwise
+ */
+static bool owf_iovec_push(owf_iovec_t *iovec, owf_iovec_segment_t *segment) {
+    segment->position = iovec->length;
+    if (OWF_NOEXPECT(!owf_array_push(&iovec->segments, iovec->alloc, iovec->error, segment, sizeof(*segment)))) {
+        return false;
+    }
+    iovec->length += segment->length;
+    return true;
+}
+
+/* Grows the scratch area of an <owf_iovec_t>, extending the last segment if it ends there.
+ * @iovec The list
+ * @size The number of bytes
+ *
+ * @return A pointer to the new bytes, or NULL on error
+ */
+static uint8_t *owf_iovec_extend(owf_iovec_t *iovec, size_t size) {
+    owf_array_t *scratch = &iovec->scratch;
+    owf_iovec_segment_t *last = NULL;
+    uint32_t offset = scratch->length;
+
+    if (OWF_NOEXPECT(size > UINT32_MAX - offset)) {
+        OWF_ERROR_SETF(iovec->error, "scratch overflow (" OWF_PRINT_SIZE " bytes)", size);
+        return NULL;
+    } else if (offset + (uint32_t)size > scratch->capacity) {
+        /* Grow by half again, without overshooting the allocator's limit */
+        uint64_t capacity = OWF_MAX((uint64_t)offset + size, (uint64_t)scratch->capacity * 3 / 2);
+        capacity = OWF_MAX(OWF_MIN(capacity, (uint64_t)iovec->alloc->max_alloc), (uint64_t)offset + size);
+        if (OWF_NOEXPECT(!owf_array_reserve_exactly(scratch, iovec->alloc, iovec->error, (uint32_t)OWF_MIN(capacity, UINT32_MAX), sizeof(uint8_t)))) {
+            return NULL;
+        }
+    }
+
+    if (OWF_ARRAY_LEN(iovec->segments) > 0) {
+        last = OWF_ARRAY_PTR(iovec->segments, owf_iovec_segment_t, OWF_ARRAY_LEN(iovec->segments) - 1);
+    }
+
+    if (last != NULL && last->ptr == NULL && last->offset + last->length == offset) {
+        /* Coalesce with the previous scratch segment */
+        last->length += (uint32_t)size;
+        iovec->length += size;
+    } else {
+        owf_iovec_segment_t segment = {.ptr = NULL, .offset = offset, .length = (uint32_t)size, .swapped = false};
+        if (OWF_NOEXPECT(!owf_iovec_push(iovec, &segment))) {
+            return NULL;
+        }
+    }
+
+    scratch->length += (uint32_t)size;
+    return OWF_ARRAY_PTR(*scratch, uint8_t, offset);
+}
+
+bool owf_iovec_copy(owf_iovec_t *iovec, const void *src, size_t size) {
+    uint8_t *dst;
+    if (size == 0) {
+        return true;
+    } else if (OWF_NOEXPECT((dst = owf_iovec_extend(iovec, size)) == NULL)) {
+        return false;
+    }
+    memcpy(dst, src, size);
+    return true;
+}
+
+bool owf_iovec_reference(owf_iovec_t *iovec, const void *src, size_t size) {
+    owf_iovec_segment_t segment = {.ptr = src, .offset = 0, .length = (uint32_t)size, .swapped = false};
+    if (size < iovec->threshold || size > UINT32_MAX) {
+        return owf_iovec_copy(iovec, src, size);
+    }
+    return owf_iovec_push(iovec, &segment);
+}
+
+bool owf_iovec_samples(owf_iovec_t *iovec, const double *ptr, uint32_t count) {
+    const size_t size = (size_t)count * sizeof(double);
+    uint8_t *dst;
+
+#if OWF_ENDIAN == OWF_ENDIAN_BIG
+    /* Already in network byte order */
+    return owf_iovec_reference(iovec, ptr, size);
+#else
+    if (size >= iovec->threshold && (iovec->flags & OWF_IOVEC_SWAP_IN_PLACE)) {
+        owf_iovec_segment_t segment = {.ptr = ptr, .offset = 0, .length = (uint32_t)size, .swapped = true};
+        if (OWF_NOEXPECT(!owf_iovec_push(iovec, &segment))) {
+            return false;
+        }
+        OWF_NET64_ARRAY((void *)ptr, ptr, count);
+        return true;
+    } else if (size == 0) {
+        return true;
+    } else if (OWF_NOEXPECT((dst = owf_iovec_extend(iovec, size)) == NULL)) {
+        return false;
+    }
+
+    /* Swap straight into scratch */
+    OWF_NET64_ARRAY(dst, ptr, count);
+    return true;
+#endif
+}
+
+bool owf_iovec_patch(owf_iovec_t *iovec, const void *src, size_t size, size_t distance) {
+    owf_iovec_segment_t *segments = OWF_ARRAY_TYPED_PTR(iovec->segments, owf_iovec_segment_t);
+    uint32_t lo = 0, hi = OWF_ARRAY_LEN(iovec->segments);
+    size_t target;
+
+    if (OWF_NOEXPECT(distance > iovec->length || size > distance)) {
+        return false;
+    }
+
+    /* Find the last segment starting at or before the target */
+    target = iovec->length - distance;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (segments[mid].position <= target) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (OWF_NOEXPECT(hi == 0 || segments[lo].ptr != NULL || target + size > segments[lo].position + segments[lo].length)) {
+        return false;
+    }
+
+    memcpy(OWF_ARRAY_PTR(iovec->scratch, uint8_t, segments[lo].offset + (target - segments[lo].position)), src, size);
+    return true;
+}
+
+/* Returns the start of a segment's bytes.
+ * @iovec The list
+ * @segment The segment
+ *
+ * @return The pointer
+ */
+static const void *owf_iovec_base(owf_iovec_t *iovec, owf_iovec_segment_t *segment) {
+    return segment->ptr != NULL ? segment->ptr : (const void *)OWF_ARRAY_PTR(iovec->scratch, uint8_t, segment->offset);
+}
+
+bool owf_iovec_flush(owf_iovec_t *iovec, owf_write_cb_t write, void *data) {
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(iovec->segments); i++) {
+        owf_iovec_segment_t *segment = OWF_ARRAY_PTR(iovec->segments, owf_iovec_segment_t, i);
+        if (OWF_NOEXPECT(!write(owf_iovec_base(iovec, segment), segment->length, data))) {
+            OWF_ERROR_SETF(iovec->error, "write error (" OWF_PRINT_U32 " bytes)", segment->length);
+            return false;
+        }
+    }
+    return true;
+}
+
+#if OWF_PLATFORM_IS_GNU
+/* A gather write. Takes a descriptor, the vectors, their count, and flags. */
+typedef ssize_t (*owf_iovec_send_cb_t)(int, struct iovec *, int, int);
+
+static ssize_t owf_iovec_writev_cb(int fd, struct iovec *vec, int count, int flags) {
+    (void)flags;
+    return writev(fd, vec, count);
+}
+
+static ssize_t owf_iovec_sendmsg_cb(int fd, struct iovec *vec, int count, int flags) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = vec;
+    msg.msg_iovlen = count;
+    return sendmsg(fd, &msg, flags);
+}
+
+/* Writes an <owf_iovec_t> in batches of <OWF_IOVEC_BATCH_LEN> segments.
+ * @iovec The list
+ * @fd The descriptor
+ * @flags Flags for the send callback
+ * @send The send callback
+ * @name The name of the call, for errors
+ *
+ * @return True if successful, false otherwise
+ */
+static bool owf_iovec_send(owf_iovec_t *iovec, int fd, int flags, owf_iovec_send_cb_t send, const char *name) {
+    struct iovec batch[OWF_IOVEC_BATCH_LEN];
+    uint32_t next = 0;
+    int count = 0;
+
+    while (next < OWF_ARRAY_LEN(iovec->segments) || count > 0) {
+        ssize_t ret;
+        int done = 0;
+
+        /* Top up the batch */
+        while (count < OWF_IOVEC_BATCH_LEN && next < OWF_ARRAY_LEN(iovec->segments)) {
+            owf_iovec_segment_t *segment = OWF_ARRAY_PTR(iovec->segments, owf_iovec_segment_t, next++);
+            batch[count].iov_base = (void *)owf_iovec_base(iovec, segment);
+            batch[count].iov_len = segment->length;
+            count++;
+        }
+
+        if (OWF_NOEXPECT((ret = send(fd, batch, count, flags)) < 0)) {
+            if (errno == EINTR) {
+                continue;
+            }
+            OWF_ERROR_SETF(iovec->error, "%s error: %s", name, strerror(errno));
+            return false;
+        } else if (OWF_NOEXPECT(ret == 0)) {
+            OWF_ERROR_SETF(iovec->error, "%s wrote nothing", name);
+            return false;
+        }
+
+        /* Drop whatever was written, and advance into a partially written vector */
+        while (done < count && (size_t)ret >= batch[done].iov_len) {
+            ret -= (ssize_t)batch[done].iov_len;
+            done++;
+        }
+        if (done < count) {
+            batch[done].iov_base = (uint8_t *)batch[done].iov_base + ret;
+            batch[done].iov_len -= (size_t)ret;
+        }
+        memmove(batch, batch + done, (size_t)(count - done) * sizeof(batch[0]));
+        count -= done;
+    }
+
+    return true;
+}
+
+bool owf_iovec_writev(owf_iovec_t *iovec, int fd) {
+    return owf_iovec_send(iovec, fd, 0, owf_iovec_writev_cb, "writev");
+}
+
+bool owf_iovec_sendmsg(owf_iovec_t *iovec, int fd, int flags) {
+    return owf_iovec_send(iovec, fd, flags, owf_iovec_sendmsg_cb, "sendmsg");
+}
+#endif
+
+/* Swaps samples that were swapped in place back to host byte order.
+ * @iovec The list
+ */
+static void owf_iovec_unswap(owf_iovec_t *iovec) {
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(iovec->segments); i++) {
+        owf_iovec_segment_t *segment = OWF_ARRAY_PTR(iovec->segments, owf_iovec_segment_t, i);
+        if (segment->swapped) {
+            OWF_HOST64_ARRAY((void *)segment->ptr, segment->ptr, segment->length / sizeof(uint64_t));
+        }
+    }
+}
+
+void owf_iovec_clear(owf_iovec_t *iovec) {
+    owf_iovec_unswap(iovec);
+    iovec->segments.length = 0;
+    iovec->scratch.length = 0;
+    iovec->length = 0;
+}
+
+void owf_iovec_destroy(owf_iovec_t *iovec) {
+    owf_iovec_unswap(iovec);
+    owf_array_destroy(&iovec->segments, iovec->alloc);
+    owf_array_destroy(&iovec->scratch, iovec->alloc);
+    owf_iovec_init(iovec, iovec->alloc, iovec->error, iovec->flags);
+}
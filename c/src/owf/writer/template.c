@@ -0,0 +1,215 @@
+#include <owf/writer/template.h>
+#include <owf/platform.h>
+#include <owf/byteswap.h>
+
+/* Marks an empty ID, which has no bytes to point at. */
+#define OWF_TEMPLATE_EMPTY_ID UINT32_MAX
+
+/* Returns the offset of a string's bytes, given the offset just past its end.
+ * @tmpl The template
+ * @str The string
+ * @end The offset just past the string
+ *
+ * @return The offset of the string's bytes, or <OWF_TEMPLATE_EMPTY_ID>
+ */
+static uint32_t owf_template_id_offset(owf_template_t *tmpl, owf_str_t *str, size_t end) {
+    uint32_t size = 0;
+    if (owf_str_length(str) == 0 || !owf_str_size(str, tmpl->error, &size)) {
+        return OWF_TEMPLATE_EMPTY_ID;
+    }
+    return (uint32_t)(end - size + sizeof(uint32_t));
+}
+
+/* Returns an ID stored in an <owf_template_t>.
+ * @tmpl The template
+ * @offset The offset of the ID's bytes
+ *
+ * @return The ID
+ */
+static const char *owf_template_id(owf_template_t *tmpl, uint32_t offset) {
+    return offset == OWF_TEMPLATE_EMPTY_ID ? "" : (const char *)tmpl->buffer.ptr + offset;
+}
+
+/* Returns a string's bytes for the streaming writer, which wants "" rather than NULL for an empty string.
+ * @str The string
+ *
+ * @return The string's bytes
+ */
+static const char *owf_template_cstr(owf_str_t *str) {
+    const char *ptr = OWF_STR_PTR(*str);
+    return ptr == NULL ? "" : ptr;
+}
+
+/* Streams a namespace into a template, recording where its fields went.
+ * @tmpl The template
+ * @writer The writer
+ * @ns The namespace
+ * @channel_id The offset of the channel ID's bytes
+ *
+ * @return True if successful, false otherwise
+ */
+static bool owf_template_write_namespace(owf_template_t *tmpl, owf_binary_writer_t *writer, owf_namespace_t *ns, uint32_t channel_id) {
+    owf_template_namespace_t entry;
+    const uint32_t index = OWF_ARRAY_LEN(tmpl->namespaces);
+
+    /* The namespace's length prefix comes first, then its times and ID */
+    entry.channel_id = channel_id;
+    entry.t0 = (uint32_t)(writer->position + sizeof(uint32_t));
+    if (OWF_NOEXPECT(!owf_binary_writer_begin_namespace(writer, ns->t0, ns->dt, owf_template_cstr(&ns->id)))) {
+        return false;
+    }
+    entry.id = owf_template_id_offset(tmpl, &ns->id, writer->position);
+    if (OWF_NOEXPECT(!owf_array_push(&tmpl->namespaces, tmpl->alloc, tmpl->error, &entry, sizeof(entry)))) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(ns->signals); i++) {
+        owf_signal_t *signal = OWF_ARRAY_PTR(ns->signals, owf_signal_t, i);
+        owf_template_signal_t sig;
+        uint32_t unit_size = 0;
+
+        if (OWF_NOEXPECT(
+            !owf_str_size(&signal->unit, tmpl->error, &unit_size) ||
+            !owf_binary_writer_begin_signal(writer, owf_template_cstr(&signal->id), owf_template_cstr(&signal->unit)))) {
+            return false;
+        }
+
+        /* The samples follow the ID, the unit, and the samples' length prefix */
+        sig.ns = index;
+        sig.samples = (uint32_t)writer->position;
+        sig.count = OWF_ARRAY_LEN(signal->samples);
+        sig.id = owf_template_id_offset(tmpl, &signal->id, writer->position - sizeof(uint32_t) - unit_size);
+
+        if (OWF_NOEXPECT(
+            !owf_binary_writer_append_samples(writer, OWF_ARRAY_PTR(signal->samples, double, 0), sig.count) ||
+            !owf_binary_writer_end_signal(writer) ||
+            !owf_array_push(&tmpl->signals, tmpl->alloc, tmpl->error, &sig, sizeof(sig)))) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(ns->events); i++) {
+        owf_event_t *event = OWF_ARRAY_PTR(ns->events, owf_event_t, i);
+        if (OWF_NOEXPECT(!owf_binary_writer_append_event(writer, event->t0, owf_template_cstr(&event->message)))) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(ns->alarms); i++) {
+        owf_alarm_t *alarm = OWF_ARRAY_PTR(ns->alarms, owf_alarm_t, i);
+        if (OWF_NOEXPECT(!owf_binary_writer_append_alarm(writer, alarm->t0, alarm->dt, alarm->details.u8.level, alarm->details.u8.volume,
+            owf_template_cstr(&alarm->type), owf_template_cstr(&alarm->message)))) {
+            return false;
+        }
+    }
+
+    return owf_binary_writer_end_namespace(writer);
+}
+
+bool owf_template_init(owf_template_t *tmpl, owf_package_t *owf, owf_alloc_t *alloc, owf_error_t *error) {
+    owf_binary_writer_t writer;
+    owf_growable_t growable;
+
+    tmpl->alloc = alloc;
+    tmpl->error = error;
+    owf_buffer_init(&tmpl->buffer, NULL, 0);
+    owf_array_init(&tmpl->namespaces);
+    owf_array_init(&tmpl->signals);
+
+    /* Stream the package, noting where everything lands; offsets survive the buffer growing */
+    owf_growable_init(&growable, alloc, error, 0);
+    owf_binary_writer_init_growable(&writer, &growable, alloc, error);
+    if (OWF_NOEXPECT(!owf_binary_writer_begin_package(&writer))) {
+        goto fail;
+    }
+
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(owf->channels); i++) {
+        owf_channel_t *channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i);
+        uint32_t channel_id;
+
+        if (OWF_NOEXPECT(!owf_binary_writer_begin_channel(&writer, owf_template_cstr(&channel->id)))) {
+            goto fail;
+        }
+
+        channel_id = owf_template_id_offset(tmpl, &channel->id, writer.position);
+        for (uint32_t j = 0; j < OWF_ARRAY_LEN(channel->namespaces); j++) {
+            if (OWF_NOEXPECT(!owf_template_write_namespace(tmpl, &writer, OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, j), channel_id))) {
+                goto fail;
+            }
+        }
+
+        if (OWF_NOEXPECT(!owf_binary_writer_end_channel(&writer))) {
+            goto fail;
+        }
+    }
+
+    if (OWF_EXPECT(owf_binary_writer_end_package(&writer))) {
+        owf_growable_take(&growable, &tmpl->buffer);
+        return true;
+    }
+
+fail:
+    owf_growable_destroy(&growable);
+    owf_template_destroy(tmpl);
+    return false;
+}
+
+bool owf_template_find_signal(owf_template_t *tmpl, const char *channel_id, const char *ns_id, const char *signal_id, uint32_t *index) {
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(tmpl->signals); i++) {
+        owf_template_signal_t *sig = OWF_ARRAY_PTR(tmpl->signals, owf_template_signal_t, i);
+        owf_template_namespace_t *ns = OWF_ARRAY_PTR(tmpl->namespaces, owf_template_namespace_t, sig->ns);
+
+        if (strcmp(owf_template_id(tmpl, sig->id), signal_id) == 0 &&
+            strcmp(owf_template_id(tmpl, ns->id), ns_id) == 0 &&
+            strcmp(owf_template_id(tmpl, ns->channel_id), channel_id) == 0) {
+            *index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool owf_template_set_time(owf_template_t *tmpl, uint32_t ns, owf_time_t t0, owf_duration_t dt) {
+    uint8_t *ptr;
+
+    if (OWF_NOEXPECT(ns >= OWF_ARRAY_LEN(tmpl->namespaces))) {
+        OWF_ERROR_SETF(tmpl->error, "no namespace at index " OWF_PRINT_U32, ns);
+        return false;
+    }
+
+    ptr = (uint8_t *)tmpl->buffer.ptr + OWF_ARRAY_PTR(tmpl->namespaces, owf_template_namespace_t, ns)->t0;
+    OWF_NET64(t0);
+    OWF_NET64(dt);
+    memcpy(ptr, &t0, sizeof(t0));
+    memcpy(ptr + sizeof(t0), &dt, sizeof(dt));
+    return true;
+}
+
+bool owf_template_set_samples(owf_template_t *tmpl, uint32_t signal, const double *ptr, uint32_t count) {
+    owf_template_signal_t *sig;
+
+    if (OWF_NOEXPECT(signal >= OWF_ARRAY_LEN(tmpl->signals))) {
+        OWF_ERROR_SETF(tmpl->error, "no signal at index " OWF_PRINT_U32, signal);
+        return false;
+    }
+
+    sig = OWF_ARRAY_PTR(tmpl->signals, owf_template_signal_t, signal);
+    if (OWF_NOEXPECT(count != sig->count)) {
+        OWF_ERROR_SETF(tmpl->error, "signal `%s` has " OWF_PRINT_U32 " samples, not " OWF_PRINT_U32, owf_template_id(tmpl, sig->id), sig->count, count);
+        return false;
+    }
+
+    OWF_NET64_ARRAY((uint8_t *)tmpl->buffer.ptr + sig->samples, ptr, count);
+    return true;
+}
+
+void owf_template_destroy(owf_template_t *tmpl) {
+    if (tmpl->buffer.ptr != NULL) {
+        owf_free(tmpl->alloc, tmpl->buffer.ptr);
+        owf_buffer_init(&tmpl->buffer, NULL, 0);
+    }
+    owf_array_destroy(&tmpl->namespaces, tmpl->alloc);
+    owf_array_destroy(&tmpl->signals, tmpl->alloc);
+    owf_array_init(&tmpl->namespaces);
+    owf_array_init(&tmpl->signals);
+}
@@ -0,0 +1,584 @@
+#include <owf/writer/transform.h>
+#include <owf/platform.h>
+#include <owf/byteswap.h>
+
+void owf_transform_init(owf_transform_t *transform) {
+    owf_projection_init(&transform->projection);
+    owf_transform_set_renames(transform, NULL, 0, NULL, 0);
+}
+
+void owf_transform_set_renames(owf_transform_t *transform, const owf_transform_rename_t *channels, uint32_t channel_count,
+    const owf_transform_rename_t *namespaces, uint32_t namespace_count) {
+    transform->channels = channels;
+    transform->channel_count = channel_count;
+    transform->namespaces = namespaces;
+    transform->namespace_count = namespace_count;
+}
+
+/* A run of encoded bytes being parsed. */
+typedef struct owf_transform_cursor {
+    /* The next byte */
+    const uint8_t *ptr;
+
+    /* The number of bytes left */
+    uint32_t length;
+} owf_transform_cursor_t;
+
+/* The state of a transform. */
+typedef struct owf_transform_ctx {
+    /* The writer, which also has the error context */
+    owf_binary_writer_t *binary;
+
+    /* The transform */
+    const owf_transform_t *transform;
+} owf_transform_ctx_t;
+
+/* Takes a fixed number of bytes from a cursor.
+ * @ctx The transform context
+ * @cursor The cursor
+ * @size The number of bytes
+ * @ptr A pointer to store the start of the bytes in
+ *
+ * @return True if there were enough bytes, false otherwise
+ */
+static bool owf_transform_take(owf_transform_ctx_t *ctx, owf_transform_cursor_t *cursor, uint32_t size, const uint8_t **ptr) {
+    if (OWF_NOEXPECT(size > cursor->length)) {
+        OWF_ERROR_SETF(ctx->binary->writer.error, "unexpected end of segment (wanted " OWF_PRINT_U32 " bytes, " OWF_PRINT_U32 " left)", size, cursor->length);
+        return false;
+    }
+    *ptr = cursor->ptr;
+    cursor->ptr += size;
+    cursor->length -= size;
+    return true;
+}
+
+/* Takes a length-prefixed segment from a cursor.
+ * @ctx The transform context
+ * @cursor The cursor
+ * @segment A cursor to store the segment's contents in; its length prefix is just before them
+ *
+ * @return True if the segment was valid, false otherwise
+ */
+static bool owf_transform_segment(owf_transform_ctx_t *ctx, owf_transform_cursor_t *cursor, owf_transform_cursor_t *segment) {
+    const uint8_t *ptr;
+    uint32_t length;
+
+    if (OWF_NOEXPECT(!owf_transform_take(ctx, cursor, sizeof(length), &ptr))) {
+        return false;
+    }
+
+    memcpy(&length, ptr, sizeof(length));
+    OWF_HOST32(length);
+    if (OWF_NOEXPECT(length % sizeof(uint32_t) != 0)) {
+        OWF_ERROR_SETF(ctx->binary->writer.error, "length was not " OWF_PRINT_SIZE "-byte aligned (got " OWF_PRINT_U32 " bytes)", sizeof(uint32_t), length);
+        return false;
+    }
+
+    segment->ptr = cursor->ptr;
+    segment->length = length;
+    return owf_transform_take(ctx, cursor, length, &ptr);
+}
+
+/* Takes an ID from a cursor.
+ * @ctx The transform context
+ * @cursor The cursor
+ * @id A cursor to store the ID's bytes in
+ *
+ * @return True if the ID was valid, false otherwise
+ */
+static bool owf_transform_id(owf_transform_ctx_t *ctx, owf_transform_cursor_t *cursor, owf_transform_cursor_t *id) {
+    if (OWF_NOEXPECT(!owf_transform_segment(ctx, cursor, id))) {
+        return false;
+    } else if (OWF_NOEXPECT(id->length > 0 && id->ptr[id->length - 1] != 0)) {
+        OWF_ERROR_SET(ctx->binary->writer.error, "string was not NULL-terminated");
+        return false;
+    }
+    return true;
+}
+
+/* Finds the new name for an ID.
+ * @renames The renames
+ * @count The number of renames
+ * @id The ID's bytes
+ *
+ * @return The new name, or NULL if the ID isn't renamed
+ */
+static const char *owf_transform_find(const owf_transform_rename_t *renames, uint32_t count, const owf_transform_cursor_t *id) {
+    const size_t length = strnlen((const char *)id->ptr, id->length);
+    for (uint32_t i = 0; i < count; i++) {
+        if (strlen(renames[i].from) == length && memcmp(renames[i].from, id->ptr, length) == 0) {
+            return renames[i].to;
+        }
+    }
+    return NULL;
+}
+
+/* Works out the encoded size of an ID, renamed or not.
+ * @ctx The transform context
+ * @id The original ID's bytes
+ * @rename The new ID, or NULL
+ * @size A pointer to store the size in, including the length prefix
+ *
+ * @return True if successful, false if the new ID is too long
+ */
+static bool owf_transform_id_size(owf_transform_ctx_t *ctx, const owf_transform_cursor_t *id, const char *rename, uint32_t *size) {
+    size_t length;
+    if (rename == NULL) {
+        *size = id->length + sizeof(uint32_t);
+        return true;
+    } else if (OWF_NOEXPECT((length = strlen(rename)) >= UINT32_MAX - sizeof(uint32_t) * 2)) {
+        OWF_ERROR_SETF(ctx->binary->writer.error, "string too long (" OWF_PRINT_SIZE " bytes)", length);
+        return false;
+    }
+
+    /* Count the null terminator, then pad to 4 bytes */
+    *size = sizeof(uint32_t) + (length > 0 ? ((uint32_t)length + sizeof(uint32_t)) & ~(uint32_t)(sizeof(uint32_t) - 1) : 0);
+    return true;
+}
+
+/* Writes an ID, renamed or not.
+ * @ctx The transform context
+ * @id The original ID's bytes
+ * @rename The new ID, or NULL
+ *
+ * @return True if the write was successful, false otherwise
+ */
+static bool owf_transform_write_id(owf_transform_ctx_t *ctx, const owf_transform_cursor_t *id, const char *rename) {
+    return rename != NULL ?
+        owf_binary_writer_write_cstr(ctx->binary, rename) :
+        owf_binary_writer_write_bytes(ctx->binary, id->ptr - sizeof(uint32_t), id->length + sizeof(uint32_t));
+}
+
+/* Filters a namespace's signals, sizing or writing the ones that are kept.
+ * @ctx The transform context
+ * @signals The signals' bytes
+ * @write Whether to write the signals that are kept
+ * @size A pointer to store the size of the signals that are kept in
+ *
+ * @return True if successful, false otherwise
+ */
+static bool owf_transform_signals(owf_transform_ctx_t *ctx, const owf_transform_cursor_t *signals, bool write, uint32_t *size) {
+    owf_transform_cursor_t cursor = *signals, id, unit, samples;
+
+    *size = 0;
+    while (cursor.length > 0) {
+        const uint8_t *start = cursor.ptr;
+        uint32_t length;
+
+        if (OWF_NOEXPECT(
+            !owf_transform_id(ctx, &cursor, &id) ||
+            !owf_transform_segment(ctx, &cursor, &unit) ||
+            !owf_transform_segment(ctx, &cursor, &samples))) {
+            return false;
+        } else if (!owf_projection_set_match(&ctx->transform->projection.signals, (const char *)id.ptr, id.length)) {
+            continue;
+        }
+
+        length = (uint32_t)(cursor.ptr - start);
+        *size += length;
+        if (write && OWF_NOEXPECT(!owf_binary_writer_write_bytes(ctx->binary, start, length))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Works out what a transform does to a namespace, and writes the result if asked.
+ * @ctx The transform context
+ * @ns The namespace's bytes, just after its length prefix
+ * @write Whether to write the namespace
+ * @size A pointer to store the namespace's new size in, including its length prefix, or 0 if it's dropped
+ * @changed A pointer to store whether the namespace changed in
+ *
+ * @return True if successful, false otherwise
+ */
+static bool owf_transform_namespace(owf_transform_ctx_t *ctx, const owf_transform_cursor_t *ns, bool write, uint32_t *size, bool *changed) {
+    const owf_projection_t *projection = &ctx->transform->projection;
+    owf_transform_cursor_t cursor = *ns, id, signals, events, alarms;
+    uint32_t id_size = 0, signals_size = 0, events_size, alarms_size;
+    const uint8_t *times;
+    const char *rename;
+
+    if (OWF_NOEXPECT(
+        !owf_transform_take(ctx, &cursor, sizeof(owf_time_t) + sizeof(owf_duration_t), &times) ||
+        !owf_transform_id(ctx, &cursor, &id) ||
+        !owf_transform_segment(ctx, &cursor, &signals) ||
+        !owf_transform_segment(ctx, &cursor, &events) ||
+        !owf_transform_segment(ctx, &cursor, &alarms))) {
+        return false;
+    } else if (OWF_NOEXPECT(cursor.length > 0)) {
+        OWF_ERROR_SETF(ctx->binary->writer.error, "trailing data when reading segment: " OWF_PRINT_U32 " bytes", cursor.length);
+        return false;
+    } else if (!owf_projection_set_match(&projection->namespaces, (const char *)id.ptr, id.length)) {
+        *size = 0;
+        *changed = true;
+        return true;
+    }
+
+    /* Work out what's left of each part */
+    rename = owf_transform_find(ctx->transform->namespaces, ctx->transform->namespace_count, &id);
+    if (OWF_NOEXPECT(!owf_transform_id_size(ctx, &id, rename, &id_size))) {
+        return false;
+    } else if (projection->flags & OWF_PROJECTION_NO_SIGNALS) {
+        signals_size = 0;
+    } else if (projection->signals.count == 0) {
+        signals_size = signals.length;
+    } else if (OWF_NOEXPECT(!owf_transform_signals(ctx, &signals, false, &signals_size))) {
+        return false;
+    }
+    events_size = projection->flags & OWF_PROJECTION_NO_EVENTS ? 0 : events.length;
+    alarms_size = projection->flags & OWF_PROJECTION_NO_ALARMS ? 0 : alarms.length;
+
+    *changed = rename != NULL || signals_size != signals.length || events_size != events.length || alarms_size != alarms.length;
+    *size = sizeof(uint32_t) * 4 + sizeof(owf_time_t) + sizeof(owf_duration_t);
+    OWF_ARITH_SAFE_ADD32(ctx->binary->writer.error, *size, id_size);
+    OWF_ARITH_SAFE_ADD32(ctx->binary->writer.error, *size, signals_size);
+    OWF_ARITH_SAFE_ADD32(ctx->binary->writer.error, *size, events_size);
+    OWF_ARITH_SAFE_ADD32(ctx->binary->writer.error, *size, alarms_size);
+
+    if (!write) {
+        return true;
+    } else if (!*changed) {
+        /* Copy the whole namespace, length and all */
+        return owf_binary_writer_write_bytes(ctx->binary, ns->ptr - sizeof(uint32_t), ns->length + sizeof(uint32_t));
+    }
+
+    /* Re-encode the header, and copy whatever's left of the rest */
+    if (OWF_NOEXPECT(
+        !owf_binary_writer_write_size(ctx->binary, *size - sizeof(uint32_t)) ||
+        !owf_binary_writer_write_bytes(ctx->binary, times, sizeof(owf_time_t) + sizeof(owf_duration_t)) ||
+        !owf_transform_write_id(ctx, &id, rename) ||
+        !owf_binary_writer_write_size(ctx->binary, signals_size))) {
+        return false;
+    } else if (signals_size == signals.length) {
+        if (OWF_NOEXPECT(!owf_binary_writer_write_bytes(ctx->binary, signals.ptr, signals.length))) {
+            return false;
+        }
+    } else if (signals_size > 0 && OWF_NOEXPECT(!owf_transform_signals(ctx, &signals, true, &signals_size))) {
+        return false;
+    }
+
+    return OWF_EXPECT(
+        owf_binary_writer_write_size(ctx->binary, events_size) &&
+        owf_binary_writer_write_bytes(ctx->binary, events.ptr, events_size) &&
+        owf_binary_writer_write_size(ctx->binary, alarms_size) &&
+        owf_binary_writer_write_bytes(ctx->binary, alarms.ptr, alarms_size));
+}
+
+/* Works out what a transform does to a channel, and writes the result if asked.
+ * @ctx The transform context
+ * @channel The channel's bytes, just after its length prefix
+ * @write Whether to write the channel
+ * @size A pointer to store the channel's new size in, including its length prefix, or 0 if it's dropped
+ * @changed A pointer to store whether the channel changed in
+ *
+ * @return True if successful, false otherwise
+ */
+static bool owf_transform_channel(owf_transform_ctx_t *ctx, const owf_transform_cursor_t *channel, bool write, uint32_t *size, bool *changed) {
+    owf_transform_cursor_t cursor = *channel, id, ns;
+    uint32_t id_size = 0, ns_size;
+    const char *rename;
+    bool ns_changed;
+
+    if (OWF_NOEXPECT(!owf_transform_id(ctx, &cursor, &id))) {
+        return false;
+    } else if (!owf_projection_set_match(&ctx->transform->projection.channels, (const char *)id.ptr, id.length)) {
+        *size = 0;
+        *changed = true;
+        return true;
+    }
+
+    rename = owf_transform_find(ctx->transform->channels, ctx->transform->channel_count, &id);
+    if (OWF_NOEXPECT(!owf_transform_id_size(ctx, &id, rename, &id_size))) {
+        return false;
+    }
+
+    /* Size the namespaces */
+    *changed = rename != NULL;
+    *size = sizeof(uint32_t) + id_size;
+    while (cursor.length > 0) {
+        if (OWF_NOEXPECT(
+            !owf_transform_segment(ctx, &cursor, &ns) ||
+            !owf_transform_namespace(ctx, &ns, false, &ns_size, &ns_changed))) {
+            return false;
+        }
+        OWF_ARITH_SAFE_ADD32(ctx->binary->writer.error, *size, ns_size);
+        *changed = *changed || ns_changed;
+    }
+
+    if (!write) {
+        return true;
+    } else if (!*changed) {
+        return owf_binary_writer_write_bytes(ctx->binary, channel->ptr - sizeof(uint32_t), channel->length + sizeof(uint32_t));
+    } else if (OWF_NOEXPECT(
+        !owf_binary_writer_write_size(ctx->binary, *size - sizeof(uint32_t)) ||
+        !owf_transform_write_id(ctx, &id, rename))) {
+        return false;
+    }
+
+    /* Write the namespaces, which have all been parsed once already */
+    cursor = *channel;
+    (void)owf_transform_id(ctx, &cursor, &id);
+    while (cursor.length > 0) {
+        (void)owf_transform_segment(ctx, &cursor, &ns);
+        if (OWF_NOEXPECT(!owf_transform_namespace(ctx, &ns, true, &ns_size, &ns_changed))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Takes the channels of the package at a buffer's position.
+ * @ctx The transform context
+ * @input The buffer
+ * @channels A cursor to store the channels' bytes in; the package header is just before them
+ *
+ * @return True if the header was valid, false otherwise
+ */
+static bool owf_transform_package(owf_transform_ctx_t *ctx, owf_buffer_t *input, owf_transform_cursor_t *channels) {
+    owf_transform_cursor_t cursor;
+    const uint8_t *ptr;
+    uint32_t magic;
+
+    if (OWF_NOEXPECT(input->position > input->length || input->length - input->position > UINT32_MAX)) {
+        OWF_ERROR_SETF(ctx->binary->writer.error, "input is too long (" OWF_PRINT_SIZE " bytes)", input->length - input->position);
+        return false;
+    }
+
+    cursor.ptr = (const uint8_t *)input->ptr + input->position;
+    cursor.length = (uint32_t)(input->length - input->position);
+    if (OWF_NOEXPECT(!owf_transform_take(ctx, &cursor, sizeof(magic), &ptr))) {
+        return false;
+    }
+
+    memcpy(&magic, ptr, sizeof(magic));
+    OWF_HOST32(magic);
+    if (OWF_NOEXPECT(magic != OWF_MAGIC)) {
+        OWF_ERROR_SETF(ctx->binary->writer.error, "invalid magic header: %#08x", magic);
+        return false;
+    }
+    return owf_transform_segment(ctx, &cursor, channels);
+}
+
+bool owf_binary_transform(owf_binary_writer_t *binary, owf_buffer_t *input, const owf_transform_t *transform) {
+    owf_transform_ctx_t ctx = {.binary = binary, .transform = transform};
+    owf_transform_cursor_t cursor, channels, channel;
+    uint32_t size = sizeof(uint32_t) * 2, channel_size;
+    bool changed = false, channel_changed;
+
+    if (OWF_NOEXPECT(!owf_transform_package(&ctx, input, &channels))) {
+        return false;
+    }
+
+    /* Size the channels */
+    cursor = channels;
+    while (cursor.length > 0) {
+        if (OWF_NOEXPECT(
+            !owf_transform_segment(&ctx, &cursor, &channel) ||
+            !owf_transform_channel(&ctx, &channel, false, &channel_size, &channel_changed))) {
+            return false;
+        }
+        OWF_ARITH_SAFE_ADD32(binary->writer.error, size, channel_size);
+        changed = changed || channel_changed;
+    }
+
+    if (!changed) {
+        /* Forward the package as it is */
+        if (OWF_NOEXPECT(!owf_binary_writer_write_bytes(binary, channels.ptr - sizeof(uint32_t) * 2, channels.length + sizeof(uint32_t) * 2))) {
+            return false;
+        }
+    } else if (OWF_NOEXPECT(
+        !owf_binary_writer_write_u32(binary, OWF_MAGIC) ||
+        !owf_binary_writer_write_size(binary, size - sizeof(uint32_t) * 2))) {
+        return false;
+    } else {
+        cursor = channels;
+        while (cursor.length > 0) {
+            (void)owf_transform_segment(&ctx, &cursor, &channel);
+            if (OWF_NOEXPECT(!owf_transform_channel(&ctx, &channel, true, &channel_size, &channel_changed))) {
+                return false;
+            }
+        }
+    }
+
+    input->position += channels.length + sizeof(uint32_t) * 2;
+    return true;
+}
+
+/* A channel being spliced. */
+typedef struct owf_splice_channel {
+    /* The channel's bytes, just after its length prefix */
+    owf_transform_cursor_t channel;
+
+    /* The channel's ID */
+    owf_transform_cursor_t id;
+
+    /* The index of the first channel it's merged with, which is its own index if it's first */
+    uint32_t first;
+} owf_splice_channel_t;
+
+/* Compares two IDs.
+ * @lhs The first ID's bytes
+ * @rhs The second ID's bytes
+ *
+ * @return Whether they're the same
+ */
+static bool owf_splice_same_id(const owf_transform_cursor_t *lhs, const owf_transform_cursor_t *rhs) {
+    const size_t length = strnlen((const char *)lhs->ptr, lhs->length);
+    return strnlen((const char *)rhs->ptr, rhs->length) == length && memcmp(lhs->ptr, rhs->ptr, length) == 0;
+}
+
+/* Finds every channel in the packages being spliced, and which of them get merged.
+ * @ctx The transform context
+ * @inputs The buffers
+ * @count The number of buffers
+ * @merge Whether to merge channels with the same ID
+ * @entries The array of <owf_splice_channel_t> to fill
+ * @lengths An array to store the length of each package in
+ *
+ * @return True if every package was valid, false otherwise
+ */
+static bool owf_splice_scan(owf_transform_ctx_t *ctx, owf_buffer_t *inputs, uint32_t count, bool merge, owf_array_t *entries, uint32_t *lengths) {
+    owf_alloc_t *alloc = ctx->binary->writer.alloc;
+    owf_error_t *error = ctx->binary->writer.error;
+
+    for (uint32_t i = 0; i < count; i++) {
+        owf_transform_cursor_t channels;
+        if (OWF_NOEXPECT(!owf_transform_package(ctx, &inputs[i], &channels))) {
+            return false;
+        }
+        lengths[i] = channels.length + sizeof(uint32_t) * 2;
+
+        while (channels.length > 0) {
+            owf_splice_channel_t entry, *other;
+            owf_transform_cursor_t id;
+
+            if (OWF_NOEXPECT(!owf_transform_segment(ctx, &channels, &entry.channel))) {
+                return false;
+            }
+            id = entry.channel;
+            if (OWF_NOEXPECT(!owf_transform_id(ctx, &id, &entry.id))) {
+                return false;
+            }
+
+            /* Look for an earlier channel with the same ID */
+            entry.first = OWF_ARRAY_LEN(*entries);
+            for (uint32_t j = 0; merge && j < OWF_ARRAY_LEN(*entries); j++) {
+                other = OWF_ARRAY_PTR(*entries, owf_splice_channel_t, j);
+                if (other->first == j && owf_splice_same_id(&other->id, &entry.id)) {
+                    entry.first = j;
+                    break;
+                }
+            }
+
+            if (OWF_NOEXPECT(!owf_array_push(entries, alloc, error, &entry, sizeof(entry)))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* Writes the channels found by <owf_splice_scan>.
+ * @ctx The transform context
+ * @entries The array of <owf_splice_channel_t>
+ * @size The size of the package, including its header
+ *
+ * @return True if the write was successful, false otherwise
+ */
+static bool owf_splice_write(owf_transform_ctx_t *ctx, owf_array_t *entries, uint32_t size) {
+    owf_binary_writer_t *binary = ctx->binary;
+
+    if (OWF_NOEXPECT(
+        !owf_binary_writer_write_u32(binary, OWF_MAGIC) ||
+        !owf_binary_writer_write_size(binary, size - sizeof(uint32_t) * 2))) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(*entries); i++) {
+        owf_splice_channel_t *entry = OWF_ARRAY_PTR(*entries, owf_splice_channel_t, i);
+        uint32_t length = entry->channel.length, merged = 0;
+
+        if (entry->first != i) {
+            /* Already written with the first channel it was merged with */
+            continue;
+        }
+
+        for (uint32_t j = i + 1; j < OWF_ARRAY_LEN(*entries); j++) {
+            owf_splice_channel_t *other = OWF_ARRAY_PTR(*entries, owf_splice_channel_t, j);
+            if (other->first == i) {
+                /* Just its namespaces */
+                length += other->channel.length - other->id.length - sizeof(uint32_t);
+                merged++;
+            }
+        }
+
+        if (merged == 0) {
+            if (OWF_NOEXPECT(!owf_binary_writer_write_bytes(binary, entry->channel.ptr - sizeof(uint32_t), entry->channel.length + sizeof(uint32_t)))) {
+                return false;
+            }
+            continue;
+        } else if (OWF_NOEXPECT(
+            !owf_binary_writer_write_size(binary, length) ||
+            !owf_binary_writer_write_bytes(binary, entry->channel.ptr, entry->channel.length))) {
+            return false;
+        }
+
+        for (uint32_t j = i + 1; j < OWF_ARRAY_LEN(*entries); j++) {
+            owf_splice_channel_t *other = OWF_ARRAY_PTR(*entries, owf_splice_channel_t, j);
+            const uint32_t skip = other->id.length + sizeof(uint32_t);
+            if (other->first == i && OWF_NOEXPECT(!owf_binary_writer_write_bytes(binary, other->channel.ptr + skip, other->channel.length - skip))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool owf_binary_splice(owf_binary_writer_t *binary, owf_buffer_t *inputs, uint32_t count, uint32_t flags) {
+    owf_transform_ctx_t ctx = {.binary = binary, .transform = NULL};
+    owf_array_t entries;
+    uint32_t *lengths, size = sizeof(uint32_t) * 2;
+    bool ok = false;
+
+    if (count == 0) {
+        return owf_binary_writer_write_u32(binary, OWF_MAGIC) && owf_binary_writer_write_size(binary, 0);
+    } else if ((lengths = owf_malloc(binary->writer.alloc, binary->writer.error, count * sizeof(uint32_t))) == NULL) {
+        return false;
+    }
+
+    /* Check everything before writing anything */
+    owf_array_init(&entries);
+    if (OWF_NOEXPECT(!owf_splice_scan(&ctx, inputs, count, (flags & OWF_SPLICE_MERGE_CHANNELS) != 0, &entries, lengths))) {
+        goto done;
+    }
+
+    /* Merging only ever drops channel headers, so the total is just the channels plus a header */
+    for (uint32_t i = 0; i < count; i++) {
+        if (OWF_NOEXPECT(!owf_arith_safe_add32(size, lengths[i] - sizeof(uint32_t) * 2, &size, binary->writer.error))) {
+            goto done;
+        }
+    }
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(entries); i++) {
+        owf_splice_channel_t *entry = OWF_ARRAY_PTR(entries, owf_splice_channel_t, i);
+        if (entry->first != i) {
+            size -= entry->id.length + sizeof(uint32_t) * 2;
+        }
+    }
+
+    if (OWF_EXPECT(owf_splice_write(&ctx, &entries, size))) {
+        for (uint32_t i = 0; i < count; i++) {
+            inputs[i].position += lengths[i];
+        }
+        ok = true;
+    }
+
+done:
+    owf_array_destroy(&entries, binary->writer.alloc);
+    owf_free_sized(binary->writer.alloc, lengths, count * sizeof(uint32_t));
+    return ok;
+}
@@ -4,11 +4,18 @@
 #include <owf/reader/binary.h>
 #include <owf/writer.h>
 #include <owf/writer/binary.h>
+#include <owf/writer/template.h>
+#include <owf/writer/transform.h>
+#include <owf/arena.h>
+#include <owf/pool.h>
+#include <owf/intern.h>
 #include <owf/platform.h>
 #include <owf/version.h>
+#include <owf/byteswap.h>
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <math.h>
 
 #if OWF_PLATFORM == OWF_PLATFORM_WINDOWS
@@ -32,6 +39,7 @@
 #define OWF_TEST_VISITOR_BUFFER(str, result) owf_test_binary_reader_visitor_buffer_execute(OWF_TEST_PATH_TO(str), result)
 #define OWF_TEST_MATERIALIZE_FILE(str, result) owf_test_binary_reader_materialize_file_execute(OWF_TEST_PATH_TO(str), result)
 #define OWF_TEST_MATERIALIZE_BUFFER(str, result) owf_test_binary_reader_materialize_buffer_execute(OWF_TEST_PATH_TO(str), result)
+#define OWF_TEST_MATERIALIZE_BORROWED(str) owf_test_binary_reader_materialize_borrowed_execute(OWF_TEST_PATH_TO(str))
 #define OWF_TEST_WRITE_BUFFER(str, owf, alloc, error) owf_test_binary_writer_buffer_execute(OWF_TEST_PATH_TO(str), owf, alloc, error)
 
 static bool owf_test_verbose;
@@ -324,6 +332,44 @@ static int owf_test_binary_reader_materialize_buffer_execute(const char *filenam
     OWF_TEST_OK;
 }
 
+static int owf_test_binary_reader_materialize_borrowed_execute(const char *filename) {
+    owf_buffer_t buf, borrowed_buf;
+    owf_binary_reader_t reader, borrowed_reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf, *borrowed;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(filename, &reader, &alloc, &error, &buf, NULL) ||
+        !owf_test_binary_read_file(filename, &alloc, &error, &borrowed_buf)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+    owf_binary_reader_init_buffer_borrowed(&borrowed_reader, &borrowed_buf, &alloc, &error, NULL);
+
+    if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((borrowed = owf_binary_materialize(&borrowed_reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing borrowed: %s", owf_error_strerror(&error));
+    }
+
+    if (owf_package_compare(owf, borrowed) != 0) {
+        owf_test_fail("borrowed package did not match copied package");
+        ret = 2;
+    } else if (OWF_ARRAY_LEN(borrowed->channels) > 0) {
+        owf_channel_t *channel = OWF_ARRAY_PTR(borrowed->channels, owf_channel_t, 0);
+        const char *id = OWF_STR_PTR(channel->id);
+        if (id != NULL && (id < (const char *)borrowed_buf.ptr || id >= (const char *)borrowed_buf.ptr + borrowed_buf.length)) {
+            owf_test_fail("channel ID was not borrowed from the buffer");
+            ret = 2;
+        }
+    }
+
+    owf_package_destroy(owf, &alloc);
+    owf_package_destroy(borrowed, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    owf_free(&alloc, borrowed_buf.ptr);
+    return ret;
+}
+
 static void owf_test_binary_print_buffers(owf_buffer_t *a, owf_buffer_t *b) {
     uint8_t *p1 = (uint8_t *)a->ptr, *p2 = (uint8_t *)b->ptr;
     fprintf(stderr, "\n");
@@ -432,48 +478,2859 @@ static int owf_test_binary_reader_materialize_buffer_valid_empty(void) {
     return OWF_TEST_MATERIALIZE_BUFFER("binary_valid_empty", true);
 }
 
-static int owf_test_binary_writer_buffer_valid_empty(void) {
-    owf_package_t owf;
+static int owf_test_binary_reader_materialize_borrowed_valid_1(void) {
+    return OWF_TEST_MATERIALIZE_BORROWED("binary_valid_1");
+}
+
+static int owf_test_binary_reader_materialize_borrowed_valid_3(void) {
+    return OWF_TEST_MATERIALIZE_BORROWED("binary_valid_3");
+}
+
+static int owf_test_binary_reader_materialize_buffer_truncated(void) {
+    owf_buffer_t buf;
+    owf_binary_reader_t reader;
     owf_error_t error = OWF_ERROR_DEFAULT;
-    owf_package_init(&owf);
-    int ret = OWF_TEST_WRITE_BUFFER("binary_valid_empty", &owf, &alloc, &error);
-    owf_package_destroy(&owf, &alloc);
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_1"), &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* Chop off the last word; the segment bounds check should catch it */
+    buf.length -= sizeof(uint32_t);
+    if (owf_binary_materialize(&reader) != NULL) {
+        OWF_TEST_FAIL("materialized a truncated buffer");
+    }
+    owf_package_destroy(&reader.reader.ctx.owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_reader_materialize_parallel_execute(const char *filename, uint32_t nthreads) {
+    owf_buffer_t buf, parallel_buf;
+    owf_binary_reader_t reader, parallel_reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf, *parallel;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(filename, &reader, &alloc, &error, &buf, NULL) ||
+        !owf_test_binary_reader_read_file(filename, &parallel_reader, &alloc, &error, &parallel_buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((parallel = owf_binary_materialize_parallel(&parallel_reader, nthreads, NULL)) == NULL) {
+        OWF_TEST_FAILF("error materializing in parallel: %s", owf_error_strerror(&error));
+    }
+
+    if (owf_package_compare(owf, parallel) != 0) {
+        owf_test_fail("parallel package did not match serial package");
+        ret = 2;
+    } else if (parallel_buf.position != parallel_buf.length) {
+        owf_test_fail("parallel materialize did not consume the package");
+        ret = 2;
+    }
+
+    owf_package_destroy(owf, &alloc);
+    owf_package_destroy(parallel, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    owf_test_binary_reader_buffer_close(&parallel_reader);
     return ret;
 }
 
-static int owf_test_binary_writer_buffer_valid_empty_channel(void) {
+static int owf_test_binary_reader_materialize_parallel_valid_2(void) {
+    return owf_test_binary_reader_materialize_parallel_execute(OWF_TEST_PATH_TO("binary_valid_2"), 2);
+}
+
+static int owf_test_binary_reader_materialize_parallel_valid_3(void) {
+    return owf_test_binary_reader_materialize_parallel_execute(OWF_TEST_PATH_TO("binary_valid_3"), 4);
+}
+
+static int owf_test_binary_reader_materialize_parallel_corrupt(void) {
+    owf_buffer_t buf;
+    owf_binary_reader_t reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    size_t length;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* Clobber the last alarm message's terminator; the worker decoding it should fail the whole read */
+    length = buf.length;
+    ((uint8_t *)buf.ptr)[length - 1] = 0xff;
+    ((uint8_t *)buf.ptr)[length - 2] = 0xff;
+    ((uint8_t *)buf.ptr)[length - 3] = 0xff;
+    ((uint8_t *)buf.ptr)[length - 4] = 0xff;
+    if (owf_binary_materialize_parallel(&reader, 4, NULL) != NULL) {
+        OWF_TEST_FAIL("materialized a corrupt buffer");
+    } else if (!owf_error_test(&error)) {
+        OWF_TEST_FAIL("no error was set");
+    } else if (buf.position != 0) {
+        OWF_TEST_FAIL("buffer position moved after a failed read");
+    }
+    owf_test_binary_reader_buffer_close(&reader);
+    OWF_TEST_OK;
+}
+
+static const char *owf_test_wanted_channel;
+
+static bool owf_test_binary_reader_one_channel_visitor(owf_reader_t *reader, owf_reader_ctx_t *ctx, owf_reader_cb_type_t type, void *data) {
+    if (type == OWF_READ_CHANNEL && strcmp(OWF_STR_PTR(ctx->channel.id), owf_test_wanted_channel) != 0) {
+        owf_channel_destroy(&ctx->channel, reader->alloc);
+        return false;
+    }
+    return owf_reader_materialize_cb(reader, ctx, type, data);
+}
+
+static int owf_test_binary_reader_skip_execute(const char *filename, bool fd) {
+    owf_buffer_t buf;
+    owf_binary_reader_t reader, skipper;
+    owf_error_t error = OWF_ERROR_DEFAULT, skip_error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf, *skipped = &skipper.reader.ctx.owf;
+    owf_channel_t *wanted;
+    FILE *f;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(filename, &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if (OWF_ARRAY_LEN(owf->channels) < 3) {
+        OWF_TEST_FAIL("need at least 3 channels");
+    } else if ((f = owf_fopen(filename, "rb")) == NULL) {
+        OWF_TEST_FAIL("error opening file");
+    }
+
+    /* Keep only the second channel */
+    wanted = OWF_ARRAY_PTR(owf->channels, owf_channel_t, 1);
+    owf_test_wanted_channel = OWF_STR_PTR(wanted->id);
+#if OWF_PLATFORM_IS_GNU
+    if (fd) {
+        owf_binary_reader_init_fd(&skipper, fileno(f), &alloc, &skip_error, owf_test_binary_reader_one_channel_visitor);
+    } else
+#endif
+    owf_binary_reader_init_file(&skipper, f, &alloc, &skip_error, owf_test_binary_reader_one_channel_visitor);
+
+    /* Skipped channels should be seeked past; reading them would scribble on the skip buffer */
+    memset(skipper.skip, 0xa5, sizeof(skipper.skip));
+    if (!owf_binary_read(&skipper)) {
+        owf_test_fail("error reading: %s", owf_error_strerror(&skip_error));
+        ret = 2;
+    } else if (OWF_ARRAY_LEN(skipped->channels) != 1 || owf_channel_compare(OWF_ARRAY_PTR(skipped->channels, owf_channel_t, 0), wanted) != 0) {
+        owf_test_fail("skipping reader did not read exactly the wanted channel");
+        ret = 2;
+    } else {
+        for (size_t i = 0; i < sizeof(skipper.skip); i++) {
+            if ((uint8_t)skipper.skip[i] != 0xa5) {
+                owf_test_fail("skipped bytes were read instead of seeked past");
+                ret = 2;
+                break;
+            }
+        }
+    }
+
+    owf_package_destroy(skipped, &alloc);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    fclose(f);
+    return ret;
+}
+
+static int owf_test_binary_reader_skip_file_valid_3(void) {
+    return owf_test_binary_reader_skip_execute(OWF_TEST_PATH_TO("binary_valid_3"), false);
+}
+
+#if OWF_PLATFORM_IS_GNU
+static int owf_test_binary_reader_skip_fd_valid_3(void) {
+    return owf_test_binary_reader_skip_execute(OWF_TEST_PATH_TO("binary_valid_3"), true);
+}
+#endif
+
+static int owf_test_binary_reader_skip_truncated_execute(bool fd) {
+    owf_buffer_t buf;
+    owf_binary_reader_t skipper;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    FILE *f;
+    bool ok;
+
+    /* Cut the end off the last channel, which is skipped along with all the others */
+    if (!owf_test_binary_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &alloc, &error, &buf)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((f = tmpfile()) == NULL) {
+        owf_free(&alloc, buf.ptr);
+        OWF_TEST_FAIL("couldn't open temporary file");
+    } else if (fwrite(buf.ptr, 1, buf.length - 64, f) != buf.length - 64 || fflush(f) != 0) {
+        owf_free(&alloc, buf.ptr);
+        fclose(f);
+        OWF_TEST_FAIL("couldn't write temporary file");
+    }
+    owf_free(&alloc, buf.ptr);
+    rewind(f);
+
+    owf_test_wanted_channel = "";
+#if OWF_PLATFORM_IS_GNU
+    if (fd) {
+        owf_binary_reader_init_fd(&skipper, fileno(f), &alloc, &error, owf_test_binary_reader_one_channel_visitor);
+    } else
+#endif
+    owf_binary_reader_init_file(&skipper, f, &alloc, &error, owf_test_binary_reader_one_channel_visitor);
+
+    ok = owf_binary_read(&skipper);
+    owf_package_destroy(&skipper.reader.ctx.owf, &alloc);
+    fclose(f);
+    if (ok) {
+        OWF_TEST_FAIL("skipped past the end of a truncated file");
+    }
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_reader_skip_file_truncated(void) {
+    return owf_test_binary_reader_skip_truncated_execute(false);
+}
+
+#if OWF_PLATFORM_IS_GNU
+static int owf_test_binary_reader_skip_fd_truncated(void) {
+    return owf_test_binary_reader_skip_truncated_execute(true);
+}
+#endif
+
+static int owf_test_binary_reader_projection_execute(const char *filename, bool file) {
+    static const char *const channels[] = {"CHANNEL_1"}, *const namespaces[] = {"NS_1_0", "NS_1_2"}, *const signals[] = {"SIG_1_0_1"};
+    owf_buffer_t buf;
+    owf_binary_reader_t reader, projector;
+    owf_error_t error = OWF_ERROR_DEFAULT, projected_error = OWF_ERROR_DEFAULT;
+    owf_projection_t projection;
+    owf_package_t *owf, *projected;
+    owf_channel_t *expected_channel = NULL, *channel;
+    uint32_t kept = 0;
+
+    owf_projection_init(&projection);
+    owf_projection_set_init(&projection.channels, channels, 1, false);
+    owf_projection_set_init(&projection.namespaces, namespaces, 2, false);
+    owf_projection_set_init(&projection.signals, signals, 1, true);
+    projection.flags = OWF_PROJECTION_NO_ALARMS;
+
+    if (!owf_test_binary_reader_read_file(filename, &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(owf->channels); i++) {
+        if (strcmp(OWF_STR_PTR(OWF_ARRAY_PTR(owf->channels, owf_channel_t, i)->id), channels[0]) == 0) {
+            expected_channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i);
+        }
+    }
+    if (expected_channel == NULL) {
+        OWF_TEST_FAILF("no channel named %s", channels[0]);
+    }
+
+    if (file) {
+        if (!owf_test_binary_reader_open(&projector, filename, &alloc, &projected_error, NULL)) {
+            OWF_TEST_FAIL("error opening file");
+        }
+    } else {
+        owf_binary_reader_init_buffer(&projector, &buf, &alloc, &projected_error, NULL);
+        buf.position = 0;
+    }
+    owf_binary_reader_set_projection(&projector, &projection);
+    if ((projected = owf_binary_materialize(&projector)) == NULL) {
+        OWF_TEST_FAILF("error materializing with a projection: %s", owf_error_strerror(&projected_error));
+    } else if (OWF_ARRAY_LEN(projected->channels) != 1) {
+        OWF_TEST_FAILF("expected 1 channel, got " OWF_PRINT_U32, OWF_ARRAY_LEN(projected->channels));
+    }
+
+    /* Walk the full channel, keeping what the projection should have kept */
+    channel = OWF_ARRAY_PTR(projected->channels, owf_channel_t, 0);
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(expected_channel->namespaces); i++) {
+        owf_namespace_t *expected_ns = OWF_ARRAY_PTR(expected_channel->namespaces, owf_namespace_t, i), *ns;
+        uint32_t signal = 0;
+
+        if (strcmp(OWF_STR_PTR(expected_ns->id), namespaces[0]) != 0 && strcmp(OWF_STR_PTR(expected_ns->id), namespaces[1]) != 0) {
+            continue;
+        } else if (kept >= OWF_ARRAY_LEN(channel->namespaces)) {
+            OWF_TEST_FAIL("too few namespaces");
+        }
+
+        ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, kept++);
+        if (owf_str_binary_compare(&ns->id, &expected_ns->id) != 0 || OWF_ARRAY_LEN(ns->alarms) != 0 ||
+            OWF_ARRAY_LEN(ns->events) != OWF_ARRAY_LEN(expected_ns->events)) {
+            OWF_TEST_FAILF("namespace %s wasn't projected correctly", OWF_STR_PTR(expected_ns->id));
+        }
+        for (uint32_t j = 0; j < OWF_ARRAY_LEN(expected_ns->signals); j++) {
+            owf_signal_t *expected_signal = OWF_ARRAY_PTR(expected_ns->signals, owf_signal_t, j);
+            if (strncmp(OWF_STR_PTR(expected_signal->id), signals[0], strlen(signals[0])) != 0) {
+                continue;
+            } else if (signal >= OWF_ARRAY_LEN(ns->signals) || owf_signal_compare(OWF_ARRAY_PTR(ns->signals, owf_signal_t, signal++), expected_signal) != 0) {
+                OWF_TEST_FAILF("signal %s wasn't projected correctly", OWF_STR_PTR(expected_signal->id));
+            }
+        }
+        if (signal != OWF_ARRAY_LEN(ns->signals)) {
+            OWF_TEST_FAILF("namespace %s has extra signals", OWF_STR_PTR(ns->id));
+        }
+    }
+    if (kept != OWF_ARRAY_LEN(channel->namespaces)) {
+        OWF_TEST_FAIL("projection kept extra namespaces");
+    }
+
+    owf_package_destroy(projected, &alloc);
+    owf_package_destroy(owf, &alloc);
+    if (file) {
+        owf_test_binary_reader_file_close(&projector);
+    }
+    owf_test_binary_reader_buffer_close(&reader);
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_reader_projection_file_valid_3(void) {
+    return owf_test_binary_reader_projection_execute(OWF_TEST_PATH_TO("binary_valid_3"), true);
+}
+
+static int owf_test_binary_reader_projection_buffer_valid_3(void) {
+    return owf_test_binary_reader_projection_execute(OWF_TEST_PATH_TO("binary_valid_3"), false);
+}
+
+static size_t owf_test_malloc_count;
+
+static void *owf_test_counting_malloc(size_t size) {
+    owf_test_malloc_count++;
+    return malloc(size);
+}
+
+static void *owf_test_counting_realloc(void *ptr, size_t size) {
+    owf_test_malloc_count++;
+    return realloc(ptr, size);
+}
+
+static int owf_test_binary_reader_projection_no_alloc(void) {
+    static const char *const channels[] = {"NO_SUCH_CHANNEL"};
+    owf_alloc_t counting = {.malloc = owf_test_counting_malloc, .realloc = owf_test_counting_realloc, .free = free, .max_alloc = OWF_ALLOC_DEFAULT_MAX};
+    owf_buffer_t buf;
+    owf_binary_reader_t reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_projection_t projection;
+    owf_package_t *owf;
+
+    owf_projection_init(&projection);
+    owf_projection_set_init(&projection.channels, channels, 1, false);
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &counting, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* Nothing is kept, so nothing should be allocated */
+    owf_test_malloc_count = 0;
+    owf_binary_reader_set_projection(&reader, &projection);
+    if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if (OWF_ARRAY_LEN(owf->channels) != 0) {
+        OWF_TEST_FAIL("channels were not filtered out");
+    } else if (owf_test_malloc_count != 0) {
+        OWF_TEST_FAILF(OWF_PRINT_SIZE " allocations for skipped channels", owf_test_malloc_count);
+    }
+    owf_package_destroy(owf, &counting);
+    owf_test_binary_reader_buffer_close(&reader);
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_validate_execute(const char *filename) {
+    owf_alloc_t counting = {.malloc = owf_test_counting_malloc, .realloc = owf_test_counting_realloc, .free = free, .max_alloc = OWF_ALLOC_DEFAULT_MAX};
+    owf_buffer_t buf;
+    owf_binary_reader_t reader, validator;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_binary_stats_t stats, file_stats;
+    owf_package_t *owf;
+    uint32_t namespaces = 0, signals = 0, events = 0, alarms = 0;
+    uint64_t samples = 0;
+
+    if (!owf_test_binary_reader_read_file(filename, &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(owf->channels); i++) {
+        owf_channel_t *channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i);
+        namespaces += OWF_ARRAY_LEN(channel->namespaces);
+        for (uint32_t j = 0; j < OWF_ARRAY_LEN(channel->namespaces); j++) {
+            owf_namespace_t *ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, j);
+            signals += OWF_ARRAY_LEN(ns->signals);
+            events += OWF_ARRAY_LEN(ns->events);
+            alarms += OWF_ARRAY_LEN(ns->alarms);
+            for (uint32_t k = 0; k < OWF_ARRAY_LEN(ns->signals); k++) {
+                samples += OWF_ARRAY_LEN(OWF_ARRAY_PTR(ns->signals, owf_signal_t, k)->samples);
+            }
+        }
+    }
+
+    /* Validate from the buffer, then from the file, without allocating */
+    owf_test_malloc_count = 0;
+    buf.position = 0;
+    owf_binary_reader_init_buffer(&validator, &buf, &counting, &error, NULL);
+    if (!owf_binary_validate(&validator, &stats)) {
+        OWF_TEST_FAILF("error validating buffer: %s", owf_error_strerror(&error));
+    } else if (!owf_test_binary_reader_open(&validator, filename, &counting, &error, NULL)) {
+        OWF_TEST_FAIL("error opening file");
+    } else if (!owf_binary_validate(&validator, &file_stats)) {
+        OWF_TEST_FAILF("error validating file: %s", owf_error_strerror(&error));
+    }
+    owf_test_binary_reader_file_close(&validator);
+
+    if (owf_test_malloc_count != 0) {
+        OWF_TEST_FAILF("validation made " OWF_PRINT_SIZE " allocations", owf_test_malloc_count);
+    } else if (memcmp(&stats, &file_stats, sizeof(stats)) != 0) {
+        OWF_TEST_FAIL("buffer and file stats differ");
+    } else if (stats.length != buf.length) {
+        OWF_TEST_FAILF("expected length " OWF_PRINT_SIZE ", got " OWF_PRINT_U64, buf.length, stats.length);
+    } else if (stats.channels != OWF_ARRAY_LEN(owf->channels) || stats.namespaces != namespaces || stats.signals != signals ||
+               stats.events != events || stats.alarms != alarms || stats.samples != samples) {
+        OWF_TEST_FAIL("stats didn't match the materialized package");
+    }
+
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_validate_valid_1(void) {
+    return owf_test_binary_validate_execute(OWF_TEST_PATH_TO("binary_valid_1"));
+}
+
+static int owf_test_binary_validate_valid_3(void) {
+    return owf_test_binary_validate_execute(OWF_TEST_PATH_TO("binary_valid_3"));
+}
+
+static int owf_test_binary_validate_corrupt(void) {
+    owf_buffer_t buf;
+    owf_binary_reader_t reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* Clobber the last alarm message's terminator */
+    ((uint8_t *)buf.ptr)[buf.length - 1] = 0xff;
+    if (owf_binary_validate(&reader, NULL)) {
+        OWF_TEST_FAIL("validated a corrupt buffer");
+    } else if (!owf_error_test(&error)) {
+        OWF_TEST_FAIL("no error was set");
+    }
+    owf_test_binary_reader_buffer_close(&reader);
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_reader_materialize_block_execute(const char *filename, size_t max_alloc, size_t blocks) {
+    owf_alloc_t counting = {.malloc = owf_test_counting_malloc, .realloc = owf_test_counting_realloc, .free = free, .max_alloc = max_alloc};
+    owf_buffer_t buf;
+    owf_binary_reader_t reader, block_reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *expected, *actual;
+
+    if (!owf_test_binary_reader_read_file(filename, &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((expected = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+
+    owf_test_malloc_count = 0;
+    buf.position = 0;
+    owf_binary_reader_init_buffer(&block_reader, &buf, &counting, &error, NULL);
+    if ((actual = owf_binary_materialize_block(&block_reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing into a block: %s", owf_error_strerror(&error));
+    } else if (owf_test_malloc_count != blocks) {
+        OWF_TEST_FAILF("expected " OWF_PRINT_SIZE " allocations, got " OWF_PRINT_SIZE, blocks, owf_test_malloc_count);
+    } else if (owf_package_compare(expected, actual) != 0) {
+        OWF_TEST_FAIL("block package differed from the materialized one");
+    }
+
+    owf_package_destroy(actual, &counting);
+    owf_package_destroy(expected, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_reader_materialize_block_valid_2(void) {
+    return owf_test_binary_reader_materialize_block_execute(OWF_TEST_PATH_TO("binary_valid_2"), OWF_ALLOC_DEFAULT_MAX, 1);
+}
+
+static int owf_test_binary_reader_materialize_block_valid_3(void) {
+    return owf_test_binary_reader_materialize_block_execute(OWF_TEST_PATH_TO("binary_valid_3"), 16 * OWF_ALLOC_DEFAULT_MAX, 1);
+}
+
+static int owf_test_binary_reader_materialize_block_split_valid_3(void) {
+    /* Too big for one block at the default limit, but no region is over it */
+    return owf_test_binary_reader_materialize_block_execute(OWF_TEST_PATH_TO("binary_valid_3"), OWF_ALLOC_DEFAULT_MAX, 2);
+}
+
+static int owf_test_binary_reader_reuse_steady(void) {
+    owf_alloc_t counting = {.malloc = owf_test_counting_malloc, .realloc = owf_test_counting_realloc, .free = free, .max_alloc = OWF_ALLOC_DEFAULT_MAX};
+    owf_buffer_t buf;
+    owf_binary_reader_t reader, reuser;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *expected, *actual;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((expected = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+
+    owf_binary_reader_init_buffer(&reuser, &buf, &counting, &error, NULL);
+    owf_binary_reader_reuse(&reuser);
+    for (int i = 0; i < 3; i++) {
+        owf_test_malloc_count = 0;
+        buf.position = 0;
+        if ((actual = owf_binary_materialize(&reuser)) == NULL) {
+            OWF_TEST_FAILF("error materializing into a reused package: %s", owf_error_strerror(&error));
+        } else if (owf_package_compare(expected, actual) != 0) {
+            OWF_TEST_FAILF("reused package differed on pass %d", i);
+        } else if (i > 0 && owf_test_malloc_count != 0) {
+            OWF_TEST_FAILF(OWF_PRINT_SIZE " allocations on pass %d", owf_test_malloc_count, i);
+        }
+    }
+
+    owf_binary_reader_destroy(&reuser);
+    owf_package_destroy(expected, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_reader_reuse_reshape(void) {
+    static const char *const files[] = {
+        OWF_TEST_PATH_TO("binary_valid_3"), OWF_TEST_PATH_TO("binary_valid_1"), OWF_TEST_PATH_TO("binary_valid_empty_namespace"),
+        OWF_TEST_PATH_TO("binary_valid_2"), OWF_TEST_PATH_TO("binary_valid_3"), OWF_TEST_PATH_TO("binary_valid_empty")
+    };
+    owf_binary_reader_t reuser;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_buffer_t input;
+
+    /* Every packet overwrites a package left over from one with a different shape */
+    owf_buffer_init(&input, NULL, 0);
+    owf_binary_reader_init_buffer(&reuser, &input, &alloc, &error, NULL);
+    owf_binary_reader_reuse(&reuser);
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        owf_buffer_t buf;
+        owf_binary_reader_t reader;
+        owf_package_t *expected, *actual;
+
+        if (!owf_test_binary_reader_read_file(files[i], &reader, &alloc, &error, &buf, NULL)) {
+            OWF_TEST_FAIL("error reading file");
+        } else if ((expected = owf_binary_materialize(&reader)) == NULL) {
+            OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+        }
+
+        input = buf;
+        input.position = 0;
+        if ((actual = owf_binary_materialize(&reuser)) == NULL) {
+            OWF_TEST_FAILF("error materializing %s into a reused package: %s", files[i], owf_error_strerror(&error));
+        } else if (owf_package_compare(expected, actual) != 0) {
+            OWF_TEST_FAILF("reused package differed for %s", files[i]);
+        }
+        owf_package_destroy(expected, &alloc);
+        owf_test_binary_reader_buffer_close(&reader);
+    }
+
+    owf_binary_reader_destroy(&reuser);
+    OWF_TEST_OK;
+}
+
+/* Encodes a package holding a single event.
+ * @message The event's message
+ * @buf The buffer to encode it into
+ */
+static bool owf_test_binary_write_event_package(const char *message, owf_buffer_t *buf) {
     owf_package_t owf;
-    owf_channel_t c;
+    owf_channel_t channel;
+    owf_namespace_t ns;
+    owf_event_t event;
+    owf_binary_writer_t writer;
     owf_error_t error = OWF_ERROR_DEFAULT;
+    bool ret;
+
     owf_package_init(&owf);
-    if (!owf_channel_init_id(&c, &alloc, &error, "BED_42") ||
-        !owf_package_push_channel(&owf, &alloc, &error, &c)) {
-        OWF_TEST_FAIL("catastrophic failure");
+    if (!owf_channel_init_id(&channel, &alloc, &error, "CHANNEL") ||
+        !owf_namespace_init_id(&ns, &alloc, &error, "NS") ||
+        !owf_event_init_message(&event, &alloc, &error, message)) {
+        return false;
     }
-    int ret = OWF_TEST_WRITE_BUFFER("binary_valid_empty_channel", &owf, &alloc, &error);
+    ns.t0 = 0;
+    ns.dt = 10;
+    event.t0 = 1;
+    ret = owf_namespace_push_event(&ns, &alloc, &error, &event) &&
+        owf_channel_push_namespace(&channel, &alloc, &error, &ns) &&
+        owf_package_push_channel(&owf, &alloc, &error, &channel) &&
+        owf_binary_write_buffer(&writer, &owf, buf, &alloc, &error);
     owf_package_destroy(&owf, &alloc);
     return ret;
 }
 
-static owf_test_t tests[] = {
-    {"binary_reader_visitor_file_valid_1", owf_test_binary_reader_visitor_file_valid_1},
-    {"binary_reader_visitor_buffer_valid_1", owf_test_binary_reader_visitor_buffer_valid_1},
-    {"binary_reader_visitor_file_valid_2", owf_test_binary_reader_visitor_file_valid_2},
-    {"binary_reader_visitor_buffer_valid_2", owf_test_binary_reader_visitor_buffer_valid_2},
-    {"binary_reader_visitor_file_valid_3", owf_test_binary_reader_visitor_file_valid_3},
-    {"binary_reader_visitor_buffer_valid_3", owf_test_binary_reader_visitor_buffer_valid_3},
-    {"binary_reader_visitor_file_valid_empty", owf_test_binary_reader_visitor_file_valid_empty},
-    {"binary_reader_visitor_buffer_valid_empty", owf_test_binary_reader_visitor_buffer_valid_empty},
-    {"binary_reader_materialize_file_valid_1", owf_test_binary_reader_materialize_file_valid_1},
-    {"binary_reader_materialize_buffer_valid_1", owf_test_binary_reader_materialize_buffer_valid_1},
+static int owf_test_binary_reader_reuse_empty_str(void) {
+    owf_buffer_t full, empty, input;
+    owf_binary_reader_t reuser;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    owf_event_t *event;
+    int ret = 0;
+
+    if (!owf_test_binary_write_event_package("a message longer than sixteen bytes", &full)) {
+        OWF_TEST_FAIL("catastrophic failure");
+    } else if (!owf_test_binary_write_event_package("", &empty)) {
+        owf_free(&alloc, full.ptr);
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+
+    /* The empty message lands in the string that held the long one */
+    owf_binary_reader_init_buffer(&reuser, &input, &alloc, &error, NULL);
+    owf_binary_reader_reuse(&reuser);
+    input = full;
+    input.position = 0;
+    if (owf_binary_materialize(&reuser) == NULL) {
+        owf_test_fail("error materializing: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else {
+        input = empty;
+        input.position = 0;
+        if ((owf = owf_binary_materialize(&reuser)) == NULL) {
+            owf_test_fail("error materializing: %s", owf_error_strerror(&error));
+            ret = 2;
+        } else {
+            event = OWF_ARRAY_PTR(OWF_ARRAY_PTR(OWF_ARRAY_PTR(owf->channels, owf_channel_t, 0)->namespaces, owf_namespace_t, 0)->events, owf_event_t, 0);
+            if (owf_str_length(&event->message) != 0 || OWF_STR_PTR(event->message) != NULL) {
+                owf_test_fail("reused empty string kept its old contents");
+                ret = 2;
+            }
+        }
+    }
+
+    owf_binary_reader_destroy(&reuser);
+    owf_free(&alloc, full.ptr);
+    owf_free(&alloc, empty.ptr);
+    return ret;
+}
+
+static int owf_test_binary_reader_feed_error(void) {
+    static const uint8_t garbage[8] = {0xde, 0xad, 0xbe, 0xef, 0, 0, 0, 0};
+    owf_buffer_t buf;
+    owf_binary_reader_t feeder;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t fed;
+    size_t consumed;
+
+    if (!owf_test_binary_read_file(OWF_TEST_PATH_TO("binary_valid_1"), &alloc, &error, &buf)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* A bad first header fails before any package is started, so there's nothing but an empty package to destroy */
+    memset(&feeder, 0xa5, sizeof(feeder));
+    owf_binary_reader_init_feed(&feeder, &alloc, &error, owf_reader_materialize_cb);
+    if (owf_binary_reader_feed(&feeder, garbage, sizeof(garbage), &consumed) != OWF_BINARY_FEED_ERROR) {
+        owf_free(&alloc, buf.ptr);
+        OWF_TEST_FAIL("accepted a bad magic number");
+    }
+    owf_package_destroy(&feeder.reader.ctx.owf, &alloc);
+    owf_binary_reader_destroy(&feeder);
+
+    /* A bad header after a finished package mustn't hand the taken package back */
+    owf_error_init(&error);
+    owf_binary_reader_init_feed(&feeder, &alloc, &error, owf_reader_materialize_cb);
+    if (owf_binary_reader_feed(&feeder, buf.ptr, buf.length, &consumed) != OWF_BINARY_FEED_DONE) {
+        owf_free(&alloc, buf.ptr);
+        OWF_TEST_FAILF("error feeding: %s", owf_error_strerror(&error));
+    }
+    fed = feeder.reader.ctx.owf;
+    owf_package_destroy(&fed, &alloc);
+    owf_free(&alloc, buf.ptr);
+    if (owf_binary_reader_feed(&feeder, garbage, sizeof(garbage), &consumed) != OWF_BINARY_FEED_ERROR) {
+        OWF_TEST_FAIL("accepted a bad magic number");
+    }
+    owf_package_destroy(&feeder.reader.ctx.owf, &alloc);
+    owf_binary_reader_destroy(&feeder);
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_reader_feed_execute(const char *filename, size_t chunk) {
+    owf_buffer_t buf;
+    owf_binary_reader_t reader, feeder;
+    owf_error_t error = OWF_ERROR_DEFAULT, feed_error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf, fed;
+    size_t offset = 0, consumed, done = 0;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(filename, &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+    owf_binary_reader_init_feed(&feeder, &alloc, &feed_error, owf_reader_materialize_cb);
+
+    /* Feed the packet twice over, in small chunks */
+    while (offset < buf.length * 2) {
+        size_t position = offset % buf.length, length = OWF_MIN(chunk, buf.length - position);
+        switch (owf_binary_reader_feed(&feeder, (uint8_t *)buf.ptr + position, length, &consumed)) {
+            case OWF_BINARY_FEED_ERROR:
+                OWF_TEST_FAILF("error feeding: %s", owf_error_strerror(&feed_error));
+            case OWF_BINARY_FEED_DONE:
+                done++;
+                fed = feeder.reader.ctx.owf;
+                buf.position = 0;
+                if ((owf = owf_binary_materialize(&reader)) == NULL) {
+                    OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+                } else if (owf_package_compare(owf, &fed) != 0) {
+                    owf_test_fail("fed package did not match materialized package");
+                    ret = 2;
+                }
+                owf_package_destroy(owf, &alloc);
+                owf_package_destroy(&fed, &alloc);
+                break;
+            case OWF_BINARY_FEED_MORE:
+                if (consumed != length) {
+                    OWF_TEST_FAIL("feed needed more data without consuming all of it");
+                }
+                break;
+        }
+        offset += consumed;
+    }
+
+    if (ret == 0 && done != 2) {
+        OWF_TEST_FAILF("expected 2 packages, got " OWF_PRINT_SIZE, done);
+    }
+    owf_binary_reader_destroy(&feeder);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_reader_feed_bytewise_valid_1(void) {
+    return owf_test_binary_reader_feed_execute(OWF_TEST_PATH_TO("binary_valid_1"), 1);
+}
+
+static int owf_test_binary_reader_feed_chunked_valid_3(void) {
+    return owf_test_binary_reader_feed_execute(OWF_TEST_PATH_TO("binary_valid_3"), 7);
+}
+
+static int owf_test_byteswap64_kernel(void) {
+    uint8_t src[8 * 67 + 1], expected[8 * 67 + 1], actual[8 * 67 + 1];
+
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    /* Odd counts and an unaligned offset exercise every vector tail */
+    for (size_t count = 0; count <= 67; count++) {
+        for (size_t offset = 0; offset <= 1 && offset + count * 8 <= sizeof(src); offset++) {
+            owf_byteswap64_scalar(expected, src + offset, count);
+            owf_byteswap64(actual, src + offset, count);
+            if (memcmp(expected, actual, count * 8) != 0) {
+                OWF_TEST_FAILF("%s kernel mismatch at count " OWF_PRINT_SIZE ", offset " OWF_PRINT_SIZE, owf_byteswap64_kernel(), count, offset);
+            }
+
+            /* In place */
+            memcpy(actual, src + offset, count * 8);
+            owf_byteswap64(actual, actual, count);
+            if (memcmp(expected, actual, count * 8) != 0) {
+                OWF_TEST_FAILF("%s kernel in-place mismatch at count " OWF_PRINT_SIZE, owf_byteswap64_kernel(), count);
+            }
+        }
+    }
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_writer_buffer_valid_1(void) {
+    owf_buffer_t buf;
+    owf_binary_reader_t reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    int ret;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_1"), &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+
+    ret = OWF_TEST_WRITE_BUFFER("binary_valid_1", owf, &alloc, &error);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_buffer_valid_empty(void) {
+    owf_package_t owf;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_init(&owf);
+    int ret = OWF_TEST_WRITE_BUFFER("binary_valid_empty", &owf, &alloc, &error);
+    owf_package_destroy(&owf, &alloc);
+    return ret;
+}
+
+static int owf_test_binary_writer_buffer_valid_empty_channel(void) {
+    owf_package_t owf;
+    owf_channel_t c;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_init(&owf);
+    if (!owf_channel_init_id(&c, &alloc, &error, "BED_42") ||
+        !owf_package_push_channel(&owf, &alloc, &error, &c)) {
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+    int ret = OWF_TEST_WRITE_BUFFER("binary_valid_empty_channel", &owf, &alloc, &error);
+    owf_package_destroy(&owf, &alloc);
+    return ret;
+}
+
+static bool owf_test_binary_writer_append_cb(const void *src, const size_t size, void *data) {
+    owf_buffer_t *buf = (owf_buffer_t *)data;
+    if (buf->position + size > buf->length) {
+        return false;
+    }
+    memcpy((uint8_t *)buf->ptr + buf->position, src, size);
+    buf->position += size;
+    return true;
+}
+
+static int owf_test_binary_writer_file_valid_3(void) {
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    FILE *file;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((file = tmpfile()) == NULL) {
+        OWF_TEST_FAIL("couldn't open temporary file");
+    }
+
+    /* Seeking flushes stdio's buffer, so files take the size pass even when they're seekable */
+    owf_binary_writer_init_file(&writer, file, &alloc, &error);
+    if (writer.writer.patch != NULL) {
+        owf_test_fail("expected an unpatchable writer");
+        ret = 2;
+    } else if (!owf_binary_write(&writer, owf)) {
+        owf_test_fail("%s", owf_error_strerror(&error));
+        ret = 2;
+    } else if ((size_t)ftell(file) != expected.length) {
+        owf_test_fail("file had the wrong length");
+        ret = 2;
+    } else if ((actual.ptr = owf_malloc(&alloc, &error, expected.length)) == NULL) {
+        owf_test_fail("catastrophic failure");
+        ret = 2;
+    } else {
+        rewind(file);
+        if (fread(actual.ptr, 1, expected.length, file) != expected.length || memcmp(expected.ptr, actual.ptr, expected.length) != 0) {
+            owf_test_fail("file contents differed");
+            ret = 2;
+        }
+        owf_free(&alloc, actual.ptr);
+    }
+
+    fclose(file);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_file_append_valid_3(void) {
+    static const char path[] = "owf1_binary_append.owf.tmp", prefix[] = "PREFIX__";
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    FILE *file;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((file = owf_fopen(path, "wb")) == NULL || fwrite(prefix, 1, sizeof(prefix) - 1, file) != sizeof(prefix) - 1 || fclose(file) != 0) {
+        OWF_TEST_FAIL("couldn't write temporary file");
+    } else if ((file = owf_fopen(path, "ab+")) == NULL) {
+        OWF_TEST_FAIL("couldn't open temporary file");
+    }
+
+    /* Writes in append mode ignore seeks, so lengths can't be back-patched */
+    owf_binary_writer_init_file(&writer, file, &alloc, &error);
+    if (writer.writer.patch != NULL) {
+        owf_test_fail("expected an unpatchable writer");
+        ret = 2;
+    } else if (!owf_binary_write(&writer, owf) || fflush(file) != 0) {
+        owf_test_fail("%s", owf_error_strerror(&error));
+        ret = 2;
+    } else if ((actual.ptr = owf_malloc(&alloc, &error, expected.length + 1)) == NULL) {
+        owf_test_fail("catastrophic failure");
+        ret = 2;
+    } else {
+        /* The package follows the prefix, and nothing follows the package */
+        rewind(file);
+        if (fread(actual.ptr, 1, sizeof(prefix) - 1, file) != sizeof(prefix) - 1 || memcmp(prefix, actual.ptr, sizeof(prefix) - 1) != 0) {
+            owf_test_fail("prefix was overwritten");
+            ret = 2;
+        } else if (fread(actual.ptr, 1, expected.length + 1, file) != expected.length || memcmp(expected.ptr, actual.ptr, expected.length) != 0) {
+            owf_test_fail("file contents differed");
+            ret = 2;
+        }
+        owf_free(&alloc, actual.ptr);
+    }
+
+    fclose(file);
+    remove(path);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_callback_valid_3(void) {
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((actual.ptr = owf_malloc(&alloc, &error, expected.length)) == NULL) {
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+
+    /* Without a patch callback, sizes are computed before writing */
+    actual.length = expected.length;
+    actual.position = 0;
+    owf_binary_writer_init(&writer, &alloc, &error, owf_test_binary_writer_append_cb, &actual);
+    if (!owf_binary_write(&writer, owf)) {
+        owf_test_fail("%s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (actual.position != expected.length || memcmp(expected.ptr, actual.ptr, expected.length) != 0) {
+        owf_test_fail("buffer contents differed");
+        ret = 2;
+    }
+
+    owf_free(&alloc, actual.ptr);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_iovec_valid_3(void) {
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    owf_iovec_t iovec;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((actual.ptr = owf_malloc(&alloc, &error, expected.length)) == NULL) {
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+
+    owf_iovec_init(&iovec, &alloc, &error, 0);
+    owf_binary_writer_init_iovec(&writer, &iovec, &alloc, &error);
+    actual.length = expected.length;
+    actual.position = 0;
+    if (!owf_binary_write(&writer, owf)) {
+        owf_test_fail("%s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (iovec.length != expected.length) {
+        owf_test_fail("list had the wrong length (" OWF_PRINT_SIZE " vs. " OWF_PRINT_SIZE ")", iovec.length, expected.length);
+        ret = 2;
+    } else if (!owf_iovec_flush(&iovec, owf_test_binary_writer_append_cb, &actual) || memcmp(expected.ptr, actual.ptr, expected.length) != 0) {
+        owf_test_fail("flushed contents differed");
+        ret = 2;
+#if OWF_ENDIAN == OWF_ENDIAN_LITTLE
+    } else if (OWF_ARRAY_LEN(iovec.segments) != 1) {
+        /* Short strings and swapped samples all land in one coalesced scratch segment */
+        owf_test_fail("expected the list to be coalesced (" OWF_PRINT_U32 " segments)", OWF_ARRAY_LEN(iovec.segments));
+        ret = 2;
+#endif
+    }
+
+#if OWF_PLATFORM_IS_GNU
+    if (ret == 0) {
+        /* Gather the same list into a file, twice */
+        FILE *file = tmpfile();
+        memset(actual.ptr, 0, actual.length);
+        if (file == NULL) {
+            owf_test_fail("couldn't open temporary file");
+            ret = 2;
+        } else if (!owf_iovec_writev(&iovec, fileno(file)) || !owf_iovec_writev(&iovec, fileno(file))) {
+            owf_test_fail("%s", owf_error_strerror(&error));
+            ret = 2;
+        } else {
+            rewind(file);
+            for (int i = 0; i < 2 && ret == 0; i++) {
+                if (fread(actual.ptr, 1, actual.length, file) != actual.length || memcmp(expected.ptr, actual.ptr, expected.length) != 0) {
+                    owf_test_fail("gathered contents differed");
+                    ret = 2;
+                }
+            }
+        }
+        if (file != NULL) {
+            fclose(file);
+        }
+    }
+#endif
+
+    owf_iovec_destroy(&iovec);
+    owf_free(&alloc, actual.ptr);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_iovec_in_place_valid_3(void) {
+    owf_buffer_t expected, original_buf, actual;
+    owf_binary_reader_t reader, original_reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf, *original;
+    owf_iovec_t iovec;
+    uint32_t referenced = 0;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL) ||
+        !owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &original_reader, &alloc, &error, &original_buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((original = owf_binary_materialize(&original_reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((actual.ptr = owf_malloc(&alloc, &error, expected.length)) == NULL) {
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+
+    /* valid_3 has lots of short signals, so reference anything over 8 samples */
+    owf_iovec_init(&iovec, &alloc, &error, OWF_IOVEC_SWAP_IN_PLACE);
+    iovec.threshold = 8 * sizeof(double);
+    owf_binary_writer_init_iovec(&writer, &iovec, &alloc, &error);
+    actual.length = expected.length;
+    actual.position = 0;
+    if (!owf_binary_write(&writer, owf)) {
+        owf_test_fail("%s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (!owf_iovec_flush(&iovec, owf_test_binary_writer_append_cb, &actual) || memcmp(expected.ptr, actual.ptr, expected.length) != 0) {
+        owf_test_fail("flushed contents differed");
+        ret = 2;
+    }
+
+    /* Large sample arrays are referenced straight out of the package */
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(iovec.segments); i++) {
+        referenced += OWF_ARRAY_PTR(iovec.segments, owf_iovec_segment_t, i)->ptr != NULL;
+    }
+    if (ret == 0 && referenced == 0) {
+        owf_test_fail("expected some segments to be referenced");
+        ret = 2;
+    }
+
+    /* Clearing the list puts the samples back in host byte order */
+    owf_iovec_clear(&iovec);
+    if (ret == 0 && owf_package_compare(owf, original) != 0) {
+        owf_test_fail("package was not restored after clearing the list");
+        ret = 2;
+    }
+
+    owf_iovec_destroy(&iovec);
+    owf_free(&alloc, actual.ptr);
+    owf_package_destroy(original, &alloc);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&original_reader);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static uint32_t owf_test_binary_writer_append_count = 0;
+
+static bool owf_test_binary_writer_counting_append_cb(const void *src, const size_t size, void *data) {
+    owf_test_binary_writer_append_count++;
+    return owf_test_binary_writer_append_cb(src, size, data);
+}
+
+static bool owf_test_binary_writer_patch_cb(const void *src, const size_t size, const size_t distance, void *data) {
+    owf_buffer_t *buf = (owf_buffer_t *)data;
+    if (distance > buf->position || size > distance) {
+        return false;
+    }
+    memcpy((uint8_t *)buf->ptr + buf->position - distance, src, size);
+    return true;
+}
+
+static int owf_test_binary_writer_buffered_valid_3(void) {
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_buffered_t buffered;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((actual.ptr = owf_malloc(&alloc, &error, expected.length)) == NULL) {
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+
+    /* Try it with and without back-patching */
+    for (int i = 0; i < 2 && ret == 0; i++) {
+        actual.length = expected.length;
+        actual.position = 0;
+        owf_test_binary_writer_append_count = 0;
+        owf_buffered_init(&buffered, &alloc, &error, owf_test_binary_writer_counting_append_cb, i == 0 ? NULL : owf_test_binary_writer_patch_cb, &actual, 4096);
+        owf_binary_writer_init_buffered(&writer, &buffered, &alloc, &error);
+
+        if (!owf_binary_write(&writer, owf) || !owf_buffered_flush(&buffered)) {
+            owf_test_fail("%s", owf_error_strerror(&error));
+            ret = 2;
+        } else if (actual.position != expected.length || memcmp(expected.ptr, actual.ptr, expected.length) != 0) {
+            owf_test_fail("buffered contents differed");
+            ret = 2;
+        } else if (owf_test_binary_writer_append_count > expected.length / 2048 + 1) {
+            /* Nothing in this file is anywhere near half a block, so every write but the last should be at least that big */
+            owf_test_fail("expected large writes (" OWF_PRINT_U32 " writes)", owf_test_binary_writer_append_count);
+            ret = 2;
+        }
+        owf_buffered_destroy(&buffered);
+    }
+
+    owf_free(&alloc, actual.ptr);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_buffered_watermarks(void) {
+    uint8_t bytes[64] = {0}, big[32], value = 0xff;
+    owf_buffer_t out;
+    owf_buffered_t buffered;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    int ret = 0;
+
+    owf_buffer_init(&out, bytes, sizeof(bytes));
+    memset(big, 0x42, sizeof(big));
+    owf_test_binary_writer_append_count = 0;
+    owf_buffered_init(&buffered, &alloc, &error, owf_test_binary_writer_counting_append_cb, owf_test_binary_writer_patch_cb, &out, 16);
+
+    if (owf_buffered_set_watermarks(&buffered, 12, 8) || owf_buffered_set_watermarks(&buffered, 4, 17)) {
+        OWF_TEST_FAIL("accepted bad watermarks");
+    } else if (!owf_buffered_set_watermarks(&buffered, 4, 12)) {
+        OWF_TEST_FAILF("rejected good watermarks: %s", owf_error_strerror(&error));
+    }
+
+    /* 11 bytes stay buffered; the 12th drains all but 4 */
+    for (int i = 0; i < 11; i++) {
+        if (!owf_buffered_write(&buffered, &value, 1)) {
+            ret = 2;
+        }
+    }
+    if (owf_test_binary_writer_append_count != 0 || buffered.length != 11) {
+        owf_test_fail("wrote before the high watermark");
+        ret = 2;
+    } else if (!owf_buffered_write(&buffered, &value, 1) || owf_test_binary_writer_append_count != 1 || out.position != 8 || buffered.length != 4) {
+        owf_test_fail("didn't drain to the low watermark");
+        ret = 2;
+    }
+
+    /* Patch one byte that's still buffered and one that was drained */
+    value = 1;
+    if (ret == 0 && (!owf_buffered_patch(&buffered, &value, 1, 2) || buffered.ptr[2] != 1)) {
+        owf_test_fail("couldn't patch a buffered byte");
+        ret = 2;
+    } else if (ret == 0 && (!owf_buffered_patch(&buffered, &value, 1, 10) || bytes[2] != 1 || buffered.length != 0 || out.position != 12)) {
+        owf_test_fail("couldn't patch a written byte");
+        ret = 2;
+    }
+
+    /* Blocks and larger go straight through */
+    owf_test_binary_writer_append_count = 0;
+    if (ret == 0 && (!owf_buffered_write(&buffered, big, sizeof(big)) || owf_test_binary_writer_append_count != 1 || out.position != 44)) {
+        owf_test_fail("large write wasn't passed through");
+        ret = 2;
+    } else if (ret == 0 && bytes[11] != 0xff) {
+        owf_test_fail("output was reordered");
+        ret = 2;
+    }
+
+    owf_buffered_destroy(&buffered);
+    return ret;
+}
+
+static bool owf_test_binary_writer_stream_package(owf_binary_writer_t *writer, owf_package_t *owf) {
+    if (!owf_binary_writer_begin_package(writer)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(owf->channels); i++) {
+        owf_channel_t *channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i);
+        if (!owf_binary_writer_begin_channel(writer, OWF_STR_PTR(channel->id))) {
+            return false;
+        }
+
+        for (uint32_t j = 0; j < OWF_ARRAY_LEN(channel->namespaces); j++) {
+            owf_namespace_t *ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, j);
+            if (!owf_binary_writer_begin_namespace(writer, ns->t0, ns->dt, OWF_STR_PTR(ns->id))) {
+                return false;
+            }
+
+            for (uint32_t k = 0; k < OWF_ARRAY_LEN(ns->signals); k++) {
+                owf_signal_t *signal = OWF_ARRAY_PTR(ns->signals, owf_signal_t, k);
+                if (!owf_binary_writer_begin_signal(writer, OWF_STR_PTR(signal->id), OWF_STR_PTR(signal->unit))) {
+                    return false;
+                }
+
+                /* Stream the samples a few at a time, as if they were arriving from a device */
+                for (uint32_t l = 0; l < OWF_ARRAY_LEN(signal->samples); l += 5) {
+                    if (!owf_binary_writer_append_samples(writer, OWF_ARRAY_PTR(signal->samples, double, l), OWF_MIN(5, OWF_ARRAY_LEN(signal->samples) - l))) {
+                        return false;
+                    }
+                }
+
+                if (!owf_binary_writer_end_signal(writer)) {
+                    return false;
+                }
+            }
+
+            for (uint32_t k = 0; k < OWF_ARRAY_LEN(ns->events); k++) {
+                owf_event_t *event = OWF_ARRAY_PTR(ns->events, owf_event_t, k);
+                if (!owf_binary_writer_append_event(writer, event->t0, OWF_STR_PTR(event->message))) {
+                    return false;
+                }
+            }
+
+            for (uint32_t k = 0; k < OWF_ARRAY_LEN(ns->alarms); k++) {
+                owf_alarm_t *alarm = OWF_ARRAY_PTR(ns->alarms, owf_alarm_t, k);
+                if (!owf_binary_writer_append_alarm(writer, alarm->t0, alarm->dt, alarm->details.u8.level, alarm->details.u8.volume, OWF_STR_PTR(alarm->type), OWF_STR_PTR(alarm->message))) {
+                    return false;
+                }
+            }
+
+            if (!owf_binary_writer_end_namespace(writer)) {
+                return false;
+            }
+        }
+
+        if (!owf_binary_writer_end_channel(writer)) {
+            return false;
+        }
+    }
+
+    return owf_binary_writer_end_package(writer);
+}
+
+static int owf_test_binary_writer_stream_execute(const char *filename) {
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(filename, &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((actual.ptr = owf_malloc(&alloc, &error, expected.length)) == NULL) {
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+
+    actual.length = expected.length;
+    actual.position = 0;
+    owf_binary_writer_init_buffer(&writer, &actual, &alloc, &error);
+    if (!owf_test_binary_writer_stream_package(&writer, owf)) {
+        owf_test_fail("%s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (actual.position != expected.length || memcmp(expected.ptr, actual.ptr, expected.length) != 0) {
+        owf_test_fail("streamed contents differed");
+        ret = 2;
+    }
+
+    owf_free(&alloc, actual.ptr);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_stream_valid_1(void) {
+    return owf_test_binary_writer_stream_execute(OWF_TEST_PATH_TO("binary_valid_1"));
+}
+
+static int owf_test_binary_writer_stream_valid_3(void) {
+    return owf_test_binary_writer_stream_execute(OWF_TEST_PATH_TO("binary_valid_3"));
+}
+
+static int owf_test_binary_writer_stream_misuse(void) {
+    uint8_t bytes[256];
+    owf_buffer_t buf;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    double sample = 1.0;
+
+    /* Streaming needs a target that can be patched */
+    owf_binary_writer_init(&writer, &alloc, &error, owf_test_binary_writer_append_cb, &buf);
+    if (owf_binary_writer_begin_package(&writer)) {
+        OWF_TEST_FAIL("streamed to a target that can't be patched");
+    }
+
+    owf_buffer_init(&buf, bytes, sizeof(bytes));
+    owf_binary_writer_init_buffer(&writer, &buf, &alloc, &error);
+    if (owf_binary_writer_begin_channel(&writer, "BED_42")) {
+        OWF_TEST_FAIL("began a channel outside a package");
+    } else if (!owf_binary_writer_begin_package(&writer) ||
+        !owf_binary_writer_begin_channel(&writer, "BED_42") ||
+        !owf_binary_writer_begin_namespace(&writer, 0, 10, "GEWAVE")) {
+        OWF_TEST_FAILF("couldn't begin: %s", owf_error_strerror(&error));
+    } else if (owf_binary_writer_append_samples(&writer, &sample, 1)) {
+        OWF_TEST_FAIL("appended samples outside a signal");
+    } else if (owf_binary_writer_append_event(&writer, 10, "late")) {
+        OWF_TEST_FAIL("appended an event the namespace didn't cover");
+    } else if (!owf_binary_writer_append_event(&writer, 5, "on time")) {
+        OWF_TEST_FAILF("couldn't append an event: %s", owf_error_strerror(&error));
+    } else if (owf_binary_writer_begin_signal(&writer, "HR", "bpm")) {
+        OWF_TEST_FAIL("began a signal after an event");
+    } else if (owf_binary_writer_end_package(&writer)) {
+        OWF_TEST_FAIL("ended a package inside a namespace");
+    }
+    OWF_TEST_OK;
+}
+
+static int owf_test_binary_template_valid_3(void) {
+    owf_buffer_t buf, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_template_t tmpl;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    uint32_t ns_index = 0, signal_index = 0, found;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if (!owf_template_init(&tmpl, owf, &alloc, &error)) {
+        OWF_TEST_FAILF("error building template: %s", owf_error_strerror(&error));
+    } else if (tmpl.buffer.length != buf.length || memcmp(tmpl.buffer.ptr, buf.ptr, buf.length) != 0) {
+        OWF_TEST_FAIL("template didn't match the original encoding");
+    }
+
+    /* Stretch every namespace and negate every sample, in both the package and the template.
+     * Events and alarms aren't patched, so the namespaces have to keep covering them. */
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(owf->channels) && ret == 0; i++) {
+        owf_channel_t *channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i);
+        for (uint32_t j = 0; j < OWF_ARRAY_LEN(channel->namespaces) && ret == 0; j++, ns_index++) {
+            owf_namespace_t *ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, j);
+            ns->dt *= 2;
+            if (!owf_template_set_time(&tmpl, ns_index, ns->t0, ns->dt)) {
+                owf_test_fail("%s", owf_error_strerror(&error));
+                ret = 2;
+            }
+
+            for (uint32_t k = 0; k < OWF_ARRAY_LEN(ns->signals) && ret == 0; k++, signal_index++) {
+                owf_signal_t *signal = OWF_ARRAY_PTR(ns->signals, owf_signal_t, k);
+                for (uint32_t l = 0; l < OWF_ARRAY_LEN(signal->samples); l++) {
+                    OWF_ARRAY_PUT(signal->samples, double, l, -OWF_ARRAY_GET(signal->samples, double, l));
+                }
+
+                if (!owf_template_find_signal(&tmpl, OWF_STR_PTR(channel->id), OWF_STR_PTR(ns->id), OWF_STR_PTR(signal->id), &found) || found != signal_index) {
+                    owf_test_fail("couldn't find signal `%s`", OWF_STR_PTR(signal->id));
+                    ret = 2;
+                } else if (!owf_template_set_samples(&tmpl, signal_index, OWF_ARRAY_PTR(signal->samples, double, 0), OWF_ARRAY_LEN(signal->samples))) {
+                    owf_test_fail("%s", owf_error_strerror(&error));
+                    ret = 2;
+                }
+            }
+        }
+    }
+
+    if (ret == 0) {
+        if (!owf_binary_write_buffer(&writer, owf, &actual, &alloc, &error)) {
+            owf_test_fail("%s", owf_error_strerror(&error));
+            ret = 2;
+        } else {
+            if (actual.length != tmpl.buffer.length || memcmp(actual.ptr, tmpl.buffer.ptr, actual.length) != 0) {
+                owf_test_fail("patched template didn't match the re-encoded package");
+                ret = 2;
+            }
+            owf_free(&alloc, actual.ptr);
+        }
+    }
+
+    owf_template_destroy(&tmpl);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_template_bounds(void) {
+    owf_buffer_t buf;
+    owf_binary_reader_t reader;
+    owf_template_t tmpl;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    uint32_t index;
+    double sample = 0.0;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_1"), &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if (!owf_template_init(&tmpl, owf, &alloc, &error)) {
+        OWF_TEST_FAILF("error building template: %s", owf_error_strerror(&error));
+    }
+
+    if (owf_template_set_time(&tmpl, OWF_ARRAY_LEN(tmpl.namespaces), 0, 0) ||
+        owf_template_set_samples(&tmpl, OWF_ARRAY_LEN(tmpl.signals), &sample, 1)) {
+        owf_test_fail("patched a field that doesn't exist");
+        ret = 2;
+    } else if (OWF_ARRAY_LEN(tmpl.signals) > 0 &&
+        owf_template_set_samples(&tmpl, 0, &sample, OWF_ARRAY_PTR(tmpl.signals, owf_template_signal_t, 0)->count + 1)) {
+        owf_test_fail("patched the wrong number of samples");
+        ret = 2;
+    } else if (owf_template_find_signal(&tmpl, "nope", "nope", "nope", &index)) {
+        owf_test_fail("found a signal that doesn't exist");
+        ret = 2;
+    }
+
+    owf_template_destroy(&tmpl);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_template_empty_strings(void) {
+    owf_package_t owf;
+    owf_channel_t channel;
+    owf_namespace_t ns;
+    owf_signal_t signal;
+    owf_event_t event;
+    owf_alarm_t alarm;
+    owf_binary_writer_t writer;
+    owf_buffer_t expected;
+    owf_template_t tmpl;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    const double sample = 1.0;
+    uint32_t index;
+    int ret = 0;
+
+    /* Every string in this package is empty */
+    owf_package_init(&owf);
+    if (!owf_channel_init_id(&channel, &alloc, &error, "") ||
+        !owf_namespace_init_id(&ns, &alloc, &error, "") ||
+        !owf_signal_init_id_unit(&signal, &alloc, &error, "", "") ||
+        !owf_signal_push_samples(&signal, &alloc, &error, &sample, 1) ||
+        !owf_event_init_message(&event, &alloc, &error, "") ||
+        !owf_alarm_init_type_message(&alarm, &alloc, &error, "", "")) {
+        OWF_TEST_FAILF("catastrophic failure: %s", owf_error_strerror(&error));
+    }
+
+    /* The namespace has to cover the event and the alarm */
+    ns.t0 = 0;
+    ns.dt = 10;
+    event.t0 = 1;
+    alarm.t0 = 2;
+    alarm.dt = 1;
+    if (!owf_namespace_push_signal(&ns, &alloc, &error, &signal) ||
+        !owf_namespace_push_event(&ns, &alloc, &error, &event) ||
+        !owf_namespace_push_alarm(&ns, &alloc, &error, &alarm) ||
+        !owf_channel_push_namespace(&channel, &alloc, &error, &ns) ||
+        !owf_package_push_channel(&owf, &alloc, &error, &channel)) {
+        OWF_TEST_FAILF("catastrophic failure: %s", owf_error_strerror(&error));
+    }
+
+    if (!owf_binary_write_buffer(&writer, &owf, &expected, &alloc, &error)) {
+        owf_package_destroy(&owf, &alloc);
+        OWF_TEST_FAILF("%s", owf_error_strerror(&error));
+    } else if (!owf_template_init(&tmpl, &owf, &alloc, &error)) {
+        owf_test_fail("error building template: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else {
+        if (tmpl.buffer.length != expected.length || memcmp(tmpl.buffer.ptr, expected.ptr, expected.length) != 0) {
+            owf_test_fail("template didn't match the package's encoding");
+            ret = 2;
+        } else if (!owf_template_find_signal(&tmpl, "", "", "", &index) || index != 0) {
+            owf_test_fail("couldn't find the signal with an empty ID");
+            ret = 2;
+        }
+        owf_template_destroy(&tmpl);
+    }
+
+    owf_free(&alloc, expected.ptr);
+    owf_package_destroy(&owf, &alloc);
+    return ret;
+}
+
+static int owf_test_binary_writer_parallel_execute(const char *filename, uint32_t nthreads) {
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(filename, &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if ((actual.ptr = owf_malloc(&alloc, &error, expected.length)) == NULL) {
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+
+    /* A buffer one byte short must be refused before anything is written */
+    owf_buffer_init(&actual, actual.ptr, expected.length - 1);
+    owf_binary_writer_init_buffer(&writer, &actual, &alloc, &error);
+    if (owf_binary_write_parallel(&writer, owf, nthreads) || actual.position != 0) {
+        owf_test_fail("wrote to a buffer that was too small");
+        ret = 2;
+    }
+
+    owf_buffer_init(&actual, actual.ptr, expected.length);
+    owf_binary_writer_init_buffer(&writer, &actual, &alloc, &error);
+    if (ret == 0 && !owf_binary_write_parallel(&writer, owf, nthreads)) {
+        owf_test_fail("%s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (ret == 0 && (actual.position != expected.length || memcmp(expected.ptr, actual.ptr, expected.length) != 0)) {
+        owf_test_fail("parallel output differed");
+        ret = 2;
+    }
+
+    owf_free(&alloc, actual.ptr);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_parallel_valid_2(void) {
+    return owf_test_binary_writer_parallel_execute(OWF_TEST_PATH_TO("binary_valid_2"), 4);
+}
+
+static int owf_test_binary_writer_parallel_valid_3(void) {
+    return owf_test_binary_writer_parallel_execute(OWF_TEST_PATH_TO("binary_valid_3"), 4);
+}
+
+/* Forgets every memoized size in a package, then sizes it from scratch. */
+static bool owf_test_types_fresh_size(owf_package_t *owf, owf_error_t *error, uint32_t *size) {
+    owf_memoize_init(&owf->memoize);
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(owf->channels); i++) {
+        owf_channel_t *channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i);
+        owf_memoize_init(&channel->memoize);
+        for (uint32_t j = 0; j < OWF_ARRAY_LEN(channel->namespaces); j++) {
+            owf_namespace_t *ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, j);
+            owf_memoize_init(&ns->memoize);
+            for (uint32_t k = 0; k < OWF_ARRAY_LEN(ns->signals); k++) {
+                owf_memoize_init(&OWF_ARRAY_PTR(ns->signals, owf_signal_t, k)->memoize);
+            }
+        }
+    }
+    return owf_package_size(owf, error, size);
+}
+
+/* Checks that a package's memoized size is current and matches a full recalculation. */
+static bool owf_test_types_size_current(owf_package_t *owf, owf_error_t *error) {
+    uint32_t memoized = 0, fresh = 0;
+    if (owf_memoize_stale(&owf->memoize)) {
+        return false;
+    }
+    memoized = owf_memoize_fetch(&owf->memoize);
+    return owf_test_types_fresh_size(owf, error, &fresh) && memoized == fresh;
+}
+
+static int owf_test_types_path_memoize(void) {
+    owf_package_t owf;
+    owf_channel_t channel;
+    owf_namespace_t ns;
+    owf_signal_t signal;
+    owf_event_t event;
+    owf_alarm_t alarm;
+    owf_path_t path;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    double samples[10] = {0.0};
+    uint32_t size = 0;
+    int ret = 0;
+
+    owf_package_init(&owf);
+    if (!owf_channel_init_id(&channel, &alloc, &error, "BED_42") ||
+        !owf_package_push_channel(&owf, &alloc, &error, &channel) ||
+        !owf_package_size(&owf, &error, &size)) {
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+
+    /* Build the rest of the package through a path, checking the size at every step */
+    owf_path_init(&path, &owf, OWF_ARRAY_PTR(owf.channels, owf_channel_t, 0), NULL);
+    if (owf_path_push_signal(&path, &alloc, &error, &signal)) {
+        owf_test_fail("pushed a signal without a namespace");
+        ret = 2;
+    } else if (!owf_namespace_init_id(&ns, &alloc, &error, "NUMERICS") ||
+        !owf_path_push_namespace(&path, &alloc, &error, &ns) ||
+        !owf_test_types_size_current(&owf, &error)) {
+        owf_test_fail("size wrong after pushing a namespace");
+        ret = 2;
+    }
+
+    path.ns = OWF_ARRAY_PTR(path.channel->namespaces, owf_namespace_t, 0);
+    path.ns->t0 = 0;
+    path.ns->dt = 1000;
+    if (ret == 0 && (!owf_signal_init_id_unit(&signal, &alloc, &error, "ECG_LEAD_II", "mV") ||
+        !owf_path_push_signal(&path, &alloc, &error, &signal) ||
+        !owf_test_types_size_current(&owf, &error))) {
+        owf_test_fail("size wrong after pushing a signal");
+        ret = 2;
+    }
+
+    for (uint32_t i = 0; ret == 0 && i < 100; i++) {
+        samples[0] = (double)i;
+        if (!owf_path_push_samples(&path, OWF_ARRAY_PTR(path.ns->signals, owf_signal_t, 0), &alloc, &error, samples, 10) ||
+            owf_memoize_stale(&owf.memoize)) {
+            owf_test_fail("size went stale after pushing samples");
+            ret = 2;
+        }
+    }
+    if (ret == 0 && !owf_test_types_size_current(&owf, &error)) {
+        owf_test_fail("size wrong after pushing samples");
+        ret = 2;
+    }
+
+    if (ret == 0 && (!owf_event_init_message(&event, &alloc, &error, "hello") ||
+        !owf_path_push_event(&path, &alloc, &error, &event) ||
+        !owf_alarm_init_type_message(&alarm, &alloc, &error, "SPO2_LOW", "low SpO2") ||
+        !owf_path_push_alarm(&path, &alloc, &error, &alarm) ||
+        !owf_test_types_size_current(&owf, &error))) {
+        owf_test_fail("size wrong after pushing an event and an alarm");
+        ret = 2;
+    }
+
+    owf_package_destroy(&owf, &alloc);
+    return ret;
+}
+
+static int owf_test_types_memoize_valid_3(void) {
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    owf_channel_t *channel;
+    owf_namespace_t *ns;
+    owf_signal_t *signal;
+    owf_path_t path;
+    double samples[4] = {1.0, 2.0, 3.0, 4.0};
+    uint32_t size = 0;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if (!owf_package_size(owf, &error, &size) || size != expected.length) {
+        OWF_TEST_FAIL("wrong initial size");
+    }
+
+    channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, OWF_ARRAY_LEN(owf->channels) - 1);
+    ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, 0);
+    signal = OWF_ARRAY_PTR(ns->signals, owf_signal_t, 0);
+    owf_path_init(&path, owf, channel, ns);
+
+    /* Setters keep their own node current, but not the nodes above it */
+    if (!owf_signal_set_unit(signal, &alloc, &error, "a much longer unit than before") || owf_memoize_stale(&signal->memoize)) {
+        owf_test_fail("setting the unit made the signal stale");
+        ret = 2;
+    } else {
+        uint32_t memoized = owf_memoize_fetch(&signal->memoize);
+        owf_memoize_init(&signal->memoize);
+        if (!owf_signal_size(signal, &error, &size) || size != memoized) {
+            owf_test_fail("signal size was " OWF_PRINT_U32 ", expected " OWF_PRINT_U32, memoized, size);
+            ret = 2;
+        }
+    }
+
+    /* Resynchronize, then grow through the path */
+    if (ret == 0 && (!owf_test_types_fresh_size(owf, &error, &size) ||
+        !owf_path_push_samples(&path, signal, &alloc, &error, samples, 4) ||
+        !owf_package_size(owf, &error, &size) ||
+        !owf_test_types_size_current(owf, &error))) {
+        owf_test_fail("size wrong after pushing samples: %s", owf_error_strerror(&error));
+        ret = 2;
+    }
+
+    /* The memoized size must be exactly what gets written */
+    if (ret == 0 && (actual.ptr = owf_malloc(&alloc, &error, size)) != NULL) {
+        owf_buffer_init(&actual, actual.ptr, size);
+        owf_binary_writer_init_buffer(&writer, &actual, &alloc, &error);
+        if (!owf_binary_write(&writer, owf) || actual.position != size) {
+            owf_test_fail("wrote " OWF_PRINT_SIZE " of " OWF_PRINT_U32 " bytes", actual.position, size);
+            ret = 2;
+        }
+        owf_free(&alloc, actual.ptr);
+    }
+
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_growable_valid_3(void) {
+    owf_buffer_t expected;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_growable_t growable;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    void *ptr = NULL;
+    size_t capacity = 0;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+
+    /* The second write should reuse the first one's memory */
+    owf_growable_init(&growable, &alloc, &error, 0);
+    for (int i = 0; ret == 0 && i < 2; i++) {
+        owf_growable_clear(&growable);
+        owf_binary_writer_init_growable(&writer, &growable, &alloc, &error);
+        if (!owf_binary_write(&writer, owf)) {
+            owf_test_fail("error writing: %s", owf_error_strerror(&error));
+            ret = 2;
+        } else if (growable.buffer.position != expected.length || memcmp(growable.buffer.ptr, expected.ptr, expected.length) != 0) {
+            owf_test_fail("buffers differed");
+            ret = 2;
+        } else if (i > 0 && (growable.buffer.ptr != ptr || growable.buffer.length != capacity)) {
+            owf_test_fail("reallocated a buffer that was big enough");
+            ret = 2;
+        }
+        ptr = growable.buffer.ptr;
+        capacity = growable.buffer.length;
+    }
+
+    owf_growable_destroy(&growable);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_writer_growable_chunked(void) {
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_growable_t growable;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+
+    /* Small chunks force plenty of growth, even from the parallel writer's single reservation */
+    owf_growable_init(&growable, &alloc, &error, 1000);
+    owf_binary_writer_init_growable(&writer, &growable, &alloc, &error);
+    if (!owf_binary_write_parallel(&writer, owf, 4)) {
+        owf_test_fail("error writing: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (growable.buffer.length % 1000 != 0 || growable.buffer.length < expected.length) {
+        owf_test_fail("capacity of " OWF_PRINT_SIZE " wasn't a whole number of chunks", growable.buffer.length);
+        ret = 2;
+    }
+
+    owf_growable_take(&growable, &actual);
+    if (ret == 0 && (actual.length != expected.length || memcmp(actual.ptr, expected.ptr, expected.length) != 0)) {
+        owf_test_fail("buffers differed");
+        ret = 2;
+    } else if (growable.buffer.ptr != NULL) {
+        owf_test_fail("growable buffer kept its bytes");
+        ret = 2;
+    }
+
+    if (actual.ptr != NULL) {
+        owf_free(&alloc, actual.ptr);
+    }
+    owf_growable_destroy(&growable);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+/* Transforms binary_valid_3, and checks the result against the package edited in memory and written out. */
+static int owf_test_binary_transform_execute(owf_transform_t *transform, owf_projection_t *projection, bool strip_events) {
+    owf_buffer_t expected, input, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_growable_t growable;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    owf_buffer_init(&input, expected.ptr, expected.length);
+    owf_growable_init(&growable, &alloc, &error, 0);
+    owf_binary_writer_init_growable(&writer, &growable, &alloc, &error);
+    if (!owf_binary_transform(&writer, &input, transform)) {
+        OWF_TEST_FAILF("error transforming: %s", owf_error_strerror(&error));
+    } else if (input.position != input.length) {
+        OWF_TEST_FAIL("input wasn't consumed");
+    }
+
+    /* Do the same thing the slow way */
+    owf_binary_reader_set_projection(&reader, projection);
+    if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(owf->channels); i++) {
+        owf_channel_t *channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i);
+        for (uint32_t k = 0; k < transform->channel_count; k++) {
+            if (strcmp(OWF_STR_PTR(channel->id) ? OWF_STR_PTR(channel->id) : "", transform->channels[k].from) == 0) {
+                owf_channel_set_id(channel, &alloc, &error, transform->channels[k].to);
+                break;
+            }
+        }
+        for (uint32_t j = 0; j < OWF_ARRAY_LEN(channel->namespaces); j++) {
+            owf_namespace_t *ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, j);
+            for (uint32_t k = 0; k < transform->namespace_count; k++) {
+                if (strcmp(OWF_STR_PTR(ns->id) ? OWF_STR_PTR(ns->id) : "", transform->namespaces[k].from) == 0) {
+                    owf_namespace_set_id(ns, &alloc, &error, transform->namespaces[k].to);
+                    break;
+                }
+            }
+            if (strip_events) {
+                for (uint32_t k = 0; k < OWF_ARRAY_LEN(ns->events); k++) {
+                    owf_event_destroy(OWF_ARRAY_PTR(ns->events, owf_event_t, k), &alloc);
+                }
+                OWF_ARRAY_LEN(ns->events) = 0;
+            }
+            owf_memoize_init(&ns->memoize);
+        }
+        owf_memoize_init(&channel->memoize);
+    }
+    owf_memoize_init(&owf->memoize);
+
+    if (!owf_binary_write_buffer(&writer, owf, &actual, &alloc, &error)) {
+        owf_test_fail("error writing: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (actual.length != growable.buffer.position || memcmp(actual.ptr, growable.buffer.ptr, actual.length) != 0) {
+        owf_test_fail("transformed package differed (" OWF_PRINT_SIZE " bytes, expected " OWF_PRINT_SIZE ")", growable.buffer.position, actual.length);
+        ret = 2;
+    }
+
+    if (actual.ptr != NULL) {
+        owf_free(&alloc, actual.ptr);
+    }
+    owf_growable_destroy(&growable);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_transform_valid_3(void) {
+    owf_buffer_t expected, input, output;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_transform_t transform;
+    owf_projection_t projection;
+    owf_transform_rename_t channels[1], namespaces[1];
+    char channel_id[64] = "", ns_id[64] = "";
+    uint8_t *ptr;
+    int ret;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((ptr = owf_malloc(&alloc, &error, expected.length)) == NULL) {
+        OWF_TEST_FAIL("catastrophic failure");
+    }
+
+    /* Leaving everything alone forwards the package in one write */
+    owf_transform_init(&transform);
+    owf_buffer_init(&input, expected.ptr, expected.length);
+    owf_buffer_init(&output, ptr, expected.length);
+    owf_test_binary_writer_append_count = 0;
+    owf_binary_writer_init(&writer, &alloc, &error, owf_test_binary_writer_counting_append_cb, &output);
+    if (!owf_binary_transform(&writer, &input, &transform)) {
+        owf_free(&alloc, ptr);
+        OWF_TEST_FAILF("error transforming: %s", owf_error_strerror(&error));
+    } else if (owf_test_binary_writer_append_count != 1 || memcmp(ptr, expected.ptr, expected.length) != 0) {
+        owf_free(&alloc, ptr);
+        OWF_TEST_FAILF("package wasn't forwarded as it was (" OWF_PRINT_SIZE " writes)", owf_test_binary_writer_append_count);
+    }
+    owf_free(&alloc, ptr);
+
+    /* Rename the first channel and namespace everywhere they appear, and strip every event */
+    {
+        owf_package_t *owf = owf_binary_materialize(&reader);
+        owf_channel_t *channel;
+        if (owf == NULL || OWF_ARRAY_LEN(owf->channels) == 0) {
+            OWF_TEST_FAIL("error materializing");
+        }
+        channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, 0);
+        snprintf(channel_id, sizeof(channel_id), "%s", OWF_STR_PTR(channel->id) ? OWF_STR_PTR(channel->id) : "");
+        if (OWF_ARRAY_LEN(channel->namespaces) > 0) {
+            owf_namespace_t *ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, 0);
+            snprintf(ns_id, sizeof(ns_id), "%s", OWF_STR_PTR(ns->id) ? OWF_STR_PTR(ns->id) : "");
+        }
+        owf_package_destroy(owf, &alloc);
+        owf_test_binary_reader_buffer_close(&reader);
+    }
+
+    channels[0].from = channel_id;
+    channels[0].to = "A_MUCH_LONGER_CHANNEL_NAME_THAN_BEFORE";
+    namespaces[0].from = ns_id;
+    namespaces[0].to = "NS";
+    owf_transform_set_renames(&transform, channels, 1, namespaces, 1);
+    transform.projection.flags = OWF_PROJECTION_NO_EVENTS;
+    owf_projection_init(&projection);
+    ret = owf_test_binary_transform_execute(&transform, &projection, true);
+    return ret;
+}
+
+static int owf_test_binary_transform_projection(void) {
+    owf_buffer_t expected, input;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_growable_t growable;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_transform_t transform;
+    owf_package_t *owf;
+    char channel_ids[2][64] = {"", ""}, signal_id[64] = "";
+    const char *channels[2] = {channel_ids[0], channel_ids[1]}, *signals[1] = {signal_id};
+    int ret;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL || OWF_ARRAY_LEN(owf->channels) < 2) {
+        OWF_TEST_FAIL("error materializing");
+    }
+
+    /* Keep the first and last channels, and only one of their signals */
+    for (uint32_t i = 0; i < 2; i++) {
+        owf_channel_t *channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i == 0 ? 0 : OWF_ARRAY_LEN(owf->channels) - 1);
+        snprintf(channel_ids[i], sizeof(channel_ids[i]), "%s", OWF_STR_PTR(channel->id) ? OWF_STR_PTR(channel->id) : "");
+        if (i == 0 && OWF_ARRAY_LEN(channel->namespaces) > 0) {
+            owf_namespace_t *ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, 0);
+            if (OWF_ARRAY_LEN(ns->signals) > 0) {
+                owf_signal_t *signal = OWF_ARRAY_PTR(ns->signals, owf_signal_t, 0);
+                snprintf(signal_id, sizeof(signal_id), "%s", OWF_STR_PTR(signal->id) ? OWF_STR_PTR(signal->id) : "");
+            }
+        }
+    }
+
+    /* A truncated package is refused before anything is written */
+    owf_transform_init(&transform);
+    owf_buffer_init(&input, expected.ptr, expected.length - sizeof(uint32_t));
+    owf_growable_init(&growable, &alloc, &error, 0);
+    owf_binary_writer_init_growable(&writer, &growable, &alloc, &error);
+    if (owf_binary_transform(&writer, &input, &transform) || growable.buffer.position != 0) {
+        owf_test_fail("transformed a truncated package");
+        ret = 2;
+    } else {
+        owf_projection_set_init(&transform.projection.channels, channels, 2, false);
+        owf_projection_set_init(&transform.projection.signals, signals, 1, false);
+        ret = owf_test_binary_transform_execute(&transform, &transform.projection, false);
+    }
+
+    owf_growable_destroy(&growable);
+    owf_package_destroy(owf, &alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_splice_valid_3(void) {
+    static const char *const ids[] = {
+        "CHANNEL_0", "CHANNEL_1", "CHANNEL_2", "CHANNEL_3", "CHANNEL_4", "CHANNEL_5", "CHANNEL_6", "CHANNEL_7",
+        "CHANNEL_8", "CHANNEL_9", "CHANNEL_10", "CHANNEL_11", "CHANNEL_12", "CHANNEL_13", "CHANNEL_14", "CHANNEL_15"
+    };
+    owf_buffer_t expected, input, parts[2];
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_growable_t halves[2], growable;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_transform_t transform;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* Split the package in two: the first eight channels, and the last eight */
+    for (int i = 0; i < 2; i++) {
+        owf_transform_init(&transform);
+        owf_projection_set_init(&transform.projection.channels, ids + i * 8, 8, false);
+        owf_buffer_init(&input, expected.ptr, expected.length);
+        owf_growable_init(&halves[i], &alloc, &error, 0);
+        owf_binary_writer_init_growable(&writer, &halves[i], &alloc, &error);
+        if (!owf_binary_transform(&writer, &input, &transform)) {
+            OWF_TEST_FAILF("error transforming: %s", owf_error_strerror(&error));
+        }
+        owf_buffer_init(&parts[i], halves[i].buffer.ptr, halves[i].buffer.position);
+    }
+
+    /* Splicing them back together gets the original */
+    owf_growable_init(&growable, &alloc, &error, 0);
+    owf_binary_writer_init_growable(&writer, &growable, &alloc, &error);
+    if (!owf_binary_splice(&writer, parts, 2, 0)) {
+        owf_test_fail("error splicing: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (growable.buffer.position != expected.length || memcmp(growable.buffer.ptr, expected.ptr, expected.length) != 0) {
+        owf_test_fail("spliced package differed");
+        ret = 2;
+    } else if (parts[0].position != parts[0].length || parts[1].position != parts[1].length) {
+        owf_test_fail("inputs weren't consumed");
+        ret = 2;
+    }
+
+    owf_growable_destroy(&growable);
+    owf_growable_destroy(&halves[0]);
+    owf_growable_destroy(&halves[1]);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static int owf_test_binary_splice_merge(void) {
+    owf_buffer_t expected, parts[2], output;
+    owf_binary_reader_t reader, spliced;
+    owf_binary_writer_t writer;
+    owf_growable_t growable;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf, *merged;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_2"), &reader, &alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* Nothing is written if any input is bad */
+    owf_buffer_init(&parts[0], expected.ptr, expected.length);
+    owf_buffer_init(&parts[1], expected.ptr, expected.length - sizeof(uint32_t));
+    owf_growable_init(&growable, &alloc, &error, 0);
+    owf_binary_writer_init_growable(&writer, &growable, &alloc, &error);
+    if (owf_binary_splice(&writer, parts, 2, OWF_SPLICE_MERGE_CHANNELS) || growable.buffer.position != 0 || parts[0].position != 0) {
+        owf_growable_destroy(&growable);
+        OWF_TEST_FAIL("spliced a truncated package");
+    }
+
+    /* Merging a package with itself doubles up every channel's namespaces */
+    owf_buffer_init(&parts[1], expected.ptr, expected.length);
+    if (!owf_binary_splice(&writer, parts, 2, OWF_SPLICE_MERGE_CHANNELS)) {
+        owf_growable_destroy(&growable);
+        OWF_TEST_FAILF("error splicing: %s", owf_error_strerror(&error));
+    }
+
+    owf_buffer_init(&output, growable.buffer.ptr, growable.buffer.position);
+    owf_binary_reader_init_buffer(&spliced, &output, &alloc, &error, NULL);
+    if ((owf = owf_binary_materialize(&reader)) == NULL || (merged = owf_binary_materialize(&spliced)) == NULL) {
+        owf_growable_destroy(&growable);
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if (OWF_ARRAY_LEN(merged->channels) != OWF_ARRAY_LEN(owf->channels)) {
+        owf_test_fail("expected " OWF_PRINT_U32 " channels, got " OWF_PRINT_U32, OWF_ARRAY_LEN(owf->channels), OWF_ARRAY_LEN(merged->channels));
+        ret = 2;
+    }
+
+    for (uint32_t i = 0; ret == 0 && i < OWF_ARRAY_LEN(owf->channels); i++) {
+        owf_channel_t *lhs = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i), *rhs = OWF_ARRAY_PTR(merged->channels, owf_channel_t, i);
+        const uint32_t count = OWF_ARRAY_LEN(lhs->namespaces);
+        if (owf_str_binary_compare(&lhs->id, &rhs->id) != 0 || OWF_ARRAY_LEN(rhs->namespaces) != count * 2) {
+            owf_test_fail("channel " OWF_PRINT_U32 " wasn't merged", i);
+            ret = 2;
+        }
+        for (uint32_t j = 0; ret == 0 && j < count * 2; j++) {
+            if (owf_namespace_compare(OWF_ARRAY_PTR(lhs->namespaces, owf_namespace_t, j % count), OWF_ARRAY_PTR(rhs->namespaces, owf_namespace_t, j)) != 0) {
+                owf_test_fail("namespace " OWF_PRINT_U32 " of channel " OWF_PRINT_U32 " differed", j, i);
+                ret = 2;
+            }
+        }
+    }
+
+    owf_package_destroy(merged, &alloc);
+    owf_package_destroy(owf, &alloc);
+    owf_growable_destroy(&growable);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+/* The state behind <owf_test_ctx_vtable>. */
+typedef struct owf_test_ctx_alloc {
+    size_t mallocs, reallocs, frees, hinted, bad_hints, last_align;
+} owf_test_ctx_alloc_t;
+
+/* Each block is preceded by its size and the pointer malloc returned, so hints can be checked */
+#define OWF_TEST_CTX_HEADER (sizeof(size_t) + sizeof(void *))
+
+static void *owf_test_ctx_malloc(void *ctx, size_t size, size_t align) {
+    owf_test_ctx_alloc_t *state = ctx;
+    uint8_t *base, *ptr;
+
+    if ((base = malloc(OWF_TEST_CTX_HEADER + align + size)) == NULL) {
+        return NULL;
+    }
+    ptr = base + OWF_TEST_CTX_HEADER;
+    ptr += (align - (uintptr_t)ptr % align) % align;
+    memcpy(ptr - OWF_TEST_CTX_HEADER, &size, sizeof(size));
+    memcpy(ptr - sizeof(void *), &base, sizeof(base));
+    state->mallocs++;
+    state->last_align = align;
+    return ptr;
+}
+
+static void owf_test_ctx_check(owf_test_ctx_alloc_t *state, void *ptr, size_t hint) {
+    size_t size;
+    memcpy(&size, (uint8_t *)ptr - OWF_TEST_CTX_HEADER, sizeof(size));
+    if (hint != 0) {
+        state->hinted++;
+        state->bad_hints += hint != size;
+    }
+}
+
+static void owf_test_ctx_free(void *ctx, void *ptr, size_t size) {
+    owf_test_ctx_alloc_t *state = ctx;
+    void *base;
+    owf_test_ctx_check(state, ptr, size);
+    memcpy(&base, (uint8_t *)ptr - sizeof(void *), sizeof(base));
+    state->frees++;
+    free(base);
+}
+
+static void *owf_test_ctx_realloc(void *ctx, void *ptr, size_t old_size, size_t size, size_t align) {
+    owf_test_ctx_alloc_t *state = ctx;
+    size_t prev;
+    void *ret;
+
+    owf_test_ctx_check(state, ptr, old_size);
+    if ((ret = owf_test_ctx_malloc(ctx, size, align)) == NULL) {
+        return NULL;
+    }
+    memcpy(&prev, (uint8_t *)ptr - OWF_TEST_CTX_HEADER, sizeof(prev));
+    memcpy(ret, ptr, OWF_MIN(prev, size));
+
+    /* A realloc isn't a malloc and a free */
+    owf_test_ctx_free(ctx, ptr, 0);
+    state->mallocs--;
+    state->frees--;
+    state->reallocs++;
+    return ret;
+}
+
+static const owf_alloc_vtable_t owf_test_ctx_vtable = {
+    .malloc = owf_test_ctx_malloc,
+    .realloc = owf_test_ctx_realloc,
+    .free = owf_test_ctx_free
+};
+
+static int owf_test_alloc_vtable_valid_3(void) {
+    owf_test_ctx_alloc_t state = {0};
+    owf_alloc_t ctx_alloc;
+    owf_buffer_t expected;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_growable_t growable;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    int ret = 0;
+
+    owf_alloc_init_vtable(&ctx_alloc, &owf_test_ctx_vtable, &state, OWF_ALLOC_DEFAULT_MAX);
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &ctx_alloc, &error, &expected, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+
+    /* Start small, so the buffer has to grow a few times */
+    owf_growable_init(&growable, &ctx_alloc, &error, 64);
+    owf_binary_writer_init_growable(&writer, &growable, &ctx_alloc, &error);
+    if (!owf_binary_write(&writer, owf)) {
+        owf_test_fail("error writing: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (growable.buffer.position != expected.length || memcmp(growable.buffer.ptr, expected.ptr, expected.length) != 0) {
+        owf_test_fail("buffers differed");
+        ret = 2;
+    }
+
+    owf_growable_destroy(&growable);
+    owf_package_destroy(owf, &ctx_alloc);
+    owf_test_binary_reader_buffer_close(&reader);
+
+    if (ret != 0) {
+        return ret;
+    } else if (state.mallocs == 0 || state.reallocs == 0) {
+        OWF_TEST_FAILF("context wasn't used (" OWF_PRINT_SIZE " mallocs, " OWF_PRINT_SIZE " reallocs)", state.mallocs, state.reallocs);
+    } else if (state.mallocs != state.frees) {
+        OWF_TEST_FAILF("leaked (" OWF_PRINT_SIZE " mallocs, " OWF_PRINT_SIZE " frees)", state.mallocs, state.frees);
+    } else if (state.hinted == 0 || state.bad_hints != 0) {
+        OWF_TEST_FAILF("bad size hints (" OWF_PRINT_SIZE " of " OWF_PRINT_SIZE ")", state.bad_hints, state.hinted);
+    }
+    OWF_TEST_OK;
+}
+
+static int owf_test_alloc_vtable_aligned(void) {
+    owf_test_ctx_alloc_t state = {0};
+    owf_alloc_t ctx_alloc;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    void *ptr;
+
+    /* Context-aware callbacks get the alignment */
+    owf_alloc_init_vtable(&ctx_alloc, &owf_test_ctx_vtable, &state, OWF_ALLOC_DEFAULT_MAX);
+    if ((ptr = owf_malloc_aligned(&ctx_alloc, &error, 100, 64)) == NULL) {
+        OWF_TEST_FAILF("error allocating: %s", owf_error_strerror(&error));
+    } else if (state.last_align != 64 || (uintptr_t)ptr % 64 != 0) {
+        owf_free(&ctx_alloc, ptr);
+        OWF_TEST_FAILF("alignment wasn't passed through (" OWF_PRINT_SIZE ")", state.last_align);
+    }
+    owf_free_sized(&ctx_alloc, ptr, 100);
+    if (state.frees != 1 || state.bad_hints != 0) {
+        OWF_TEST_FAIL("free wasn't passed the size");
+    }
+
+    /* Plain callbacks can't do better than malloc, and nothing does odd alignments */
+    if ((ptr = owf_malloc_aligned(&alloc, &error, 100, 64)) != NULL) {
+        owf_free(&alloc, ptr);
+        OWF_TEST_FAIL("plain allocator claimed to align to 64 bytes");
+    } else if ((ptr = owf_malloc_aligned(&ctx_alloc, &error, 100, 3)) != NULL) {
+        owf_free(&ctx_alloc, ptr);
+        OWF_TEST_FAIL("allocated with an alignment that wasn't a power of two");
+    }
+    OWF_TEST_OK;
+}
+
+static int owf_test_arena_valid_3(void) {
+    owf_alloc_t counting = {.malloc = owf_test_counting_malloc, .realloc = owf_test_counting_realloc, .free = free, .max_alloc = OWF_ALLOC_DEFAULT_MAX * 16};
+    owf_arena_t arena;
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    size_t count = 0;
+    int ret = 0;
+
+    if (!owf_test_binary_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &alloc, &error, &expected)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* Small chunks, so the first packet spills over a few of them */
+    owf_arena_init(&arena, &counting, 1024);
+    for (int i = 0; ret == 0 && i < 3; i++) {
+        expected.position = 0;
+        owf_binary_reader_init_buffer(&reader, &expected, &arena.alloc, &error, NULL);
+        owf_test_malloc_count = 0;
+        if ((owf = owf_binary_materialize(&reader)) == NULL) {
+            owf_test_fail("error materializing: %s", owf_error_strerror(&error));
+            ret = 2;
+        } else if (!owf_binary_write_buffer(&writer, owf, &actual, &alloc, &error)) {
+            owf_test_fail("error writing: %s", owf_error_strerror(&error));
+            ret = 2;
+        } else {
+            if (actual.length != expected.length || memcmp(actual.ptr, expected.ptr, expected.length) != 0) {
+                owf_test_fail("buffers differed");
+                ret = 2;
+            } else if (i == 0 && arena.chunks == NULL) {
+                owf_test_fail("arena wasn't used");
+                ret = 2;
+            } else if (i > 0 && owf_test_malloc_count != count) {
+                owf_test_fail("packet " OWF_PRINT_SIZE " took " OWF_PRINT_SIZE " chunks", (size_t)i, owf_test_malloc_count);
+                ret = 2;
+            }
+            owf_free(&alloc, actual.ptr);
+        }
+
+        /* The chunks are coalesced into one, which is then kept */
+        count = i == 0 ? 1 : 0;
+        owf_arena_reset(&arena);
+    }
+
+    owf_arena_destroy(&arena);
+    owf_free(&alloc, expected.ptr);
+    return ret;
+}
+
+static int owf_test_arena_realloc(void) {
+    owf_arena_t arena;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    void *a, *b, *c;
+    int ret = 0;
+
+    owf_arena_init(&arena, &alloc, 256);
+    if ((a = owf_malloc(&arena.alloc, &error, 16)) == NULL || (b = owf_malloc(&arena.alloc, &error, 16)) == NULL) {
+        owf_test_fail("error allocating: %s", owf_error_strerror(&error));
+        ret = 2;
+        goto done;
+    }
+    memset(a, 'a', 16);
+
+    /* The most recent block grows in place; older ones move, but only if their size is known */
+    c = b;
+    if (!owf_realloc_sized(&arena.alloc, &error, &c, 16, 64) || c != b) {
+        owf_test_fail("most recent block wasn't grown in place");
+        ret = 2;
+    } else if ((c = a, owf_realloc(&arena.alloc, &error, &c, 32))) {
+        owf_test_fail("grew a block without knowing its size");
+        ret = 2;
+    } else if (!owf_realloc_sized(&arena.alloc, &error, &c, 16, 32) || c == a || memcmp(c, a, 16) != 0) {
+        owf_test_fail("older block wasn't copied");
+        ret = 2;
+    }
+    if (ret != 0) {
+        goto done;
+    }
+
+    /* Freeing the most recent block gives its space back */
+    owf_free(&arena.alloc, c);
+    if ((b = owf_malloc(&arena.alloc, &error, 8)) != c) {
+        owf_test_fail("freed block wasn't reused");
+        ret = 2;
+        goto done;
+    }
+
+    /* Big blocks get their own chunk, and resetting coalesces them */
+    if ((a = owf_malloc(&arena.alloc, &error, 1024)) == NULL) {
+        owf_test_fail("error allocating: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (arena.total < 256 + 1024) {
+        owf_test_fail("big block didn't get its own chunk");
+        ret = 2;
+    } else {
+        owf_arena_reset(&arena);
+        if (arena.chunks != NULL || arena.chunk_size < 256 + 1024) {
+            owf_test_fail("chunks weren't coalesced");
+            ret = 2;
+        } else if ((a = owf_malloc(&arena.alloc, &error, 1024)) == NULL || (b = owf_malloc(&arena.alloc, &error, 128)) == NULL) {
+            owf_test_fail("error allocating: %s", owf_error_strerror(&error));
+            ret = 2;
+        } else if (arena.total != arena.chunk_size) {
+            owf_test_fail("coalesced chunk was too small");
+            ret = 2;
+        }
+    }
+
+done:
+    owf_arena_destroy(&arena);
+    return ret;
+}
+
+static int owf_test_pool_valid_3(void) {
+    owf_pool_t pool;
+    owf_pool_magazine_t magazine;
+    owf_buffer_t expected, actual;
+    owf_binary_reader_t reader;
+    owf_binary_writer_t writer;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    uint32_t slabs = 0;
+    int ret = 0;
+
+    if (!owf_test_binary_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &alloc, &error, &expected)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    owf_pool_init(&pool, &alloc, 0);
+    owf_pool_magazine_init(&magazine, &pool);
+    for (int i = 0; ret == 0 && i < 3; i++) {
+        expected.position = 0;
+        owf_binary_reader_init_buffer(&reader, &expected, &magazine.alloc, &error, NULL);
+        if ((owf = owf_binary_materialize(&reader)) == NULL) {
+            owf_test_fail("error materializing: %s", owf_error_strerror(&error));
+            ret = 2;
+            break;
+        } else if (!owf_binary_write_buffer(&writer, owf, &actual, &alloc, &error)) {
+            owf_test_fail("error writing: %s", owf_error_strerror(&error));
+            ret = 2;
+        } else {
+            if (actual.length != expected.length || memcmp(actual.ptr, expected.ptr, expected.length) != 0) {
+                owf_test_fail("buffers differed");
+                ret = 2;
+            }
+            owf_free(&alloc, actual.ptr);
+        }
+        owf_package_destroy(owf, &magazine.alloc);
+
+        /* Later packets should be built entirely from blocks the first one gave back */
+        if (i == 0) {
+            slabs = pool.slab_count;
+        } else if (ret == 0 && pool.slab_count != slabs) {
+            owf_test_fail("packet %d took " OWF_PRINT_U32 " more slabs", i, pool.slab_count - slabs);
+            ret = 2;
+        }
+    }
+
+    if (ret == 0 && slabs == 0) {
+        owf_test_fail("pool wasn't used");
+        ret = 2;
+    }
+
+    owf_pool_magazine_flush(&magazine);
+    owf_pool_destroy(&pool);
+    owf_free(&alloc, expected.ptr);
+    return ret;
+}
+
+/* Work for one thread of <owf_test_pool_threads>. */
+typedef struct owf_test_pool_worker {
+    owf_thread_t thread;
+    owf_pool_magazine_t magazine;
+    owf_alloc_t *alloc;
+    uint8_t seed;
+    bool ok;
+} owf_test_pool_worker_t;
+
+static void owf_test_pool_worker(void *data) {
+    owf_test_pool_worker_t *worker = (owf_test_pool_worker_t *)data;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    uint8_t *blocks[128];
+    size_t sizes[128];
+
+    worker->ok = true;
+    for (int round = 0; round < 50 && worker->ok; round++) {
+        /* Allocate a spread of sizes, some too big for the pool, and grow every other one */
+        for (size_t i = 0; i < 128; i++) {
+            sizes[i] = (i * 37 + (size_t)round * 11) % 3000 + 1;
+            if ((blocks[i] = owf_malloc(worker->alloc, &error, sizes[i])) == NULL) {
+                worker->ok = false;
+                return;
+            }
+            memset(blocks[i], worker->seed + (int)i, sizes[i]);
+            if (i % 2 == 0) {
+                void *ptr = blocks[i];
+                if (!owf_realloc(worker->alloc, &error, &ptr, sizes[i] * 2)) {
+                    worker->ok = false;
+                    return;
+                }
+                blocks[i] = ptr;
+                memset(blocks[i] + sizes[i], worker->seed + (int)i, sizes[i]);
+                sizes[i] *= 2;
+            }
+        }
+
+        for (size_t i = 0; i < 128; i++) {
+            for (size_t j = 0; j < sizes[i]; j++) {
+                worker->ok = worker->ok && blocks[i][j] == (uint8_t)(worker->seed + (int)i);
+            }
+            owf_free(worker->alloc, blocks[i]);
+        }
+    }
+}
+
+static int owf_test_pool_threads(void) {
+    owf_pool_t pool;
+    owf_test_pool_worker_t workers[4];
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    int ret = 0;
+
+    /* Three threads get magazines, and one shares the pool's own allocator with them */
+    owf_pool_init(&pool, &alloc, 0);
+    for (uint32_t i = 0; i < 4; i++) {
+        owf_pool_magazine_init(&workers[i].magazine, &pool);
+        workers[i].alloc = i == 0 ? &pool.alloc : &workers[i].magazine.alloc;
+        workers[i].seed = (uint8_t)(i * 64);
+        if (!owf_thread_create(&workers[i].thread, &error, owf_test_pool_worker, &workers[i])) {
+            owf_test_fail("error starting thread: %s", owf_error_strerror(&error));
+            ret = 2;
+            workers[i].ok = false;
+            workers[i].alloc = NULL;
+        }
+    }
+
+    for (uint32_t i = 0; i < 4; i++) {
+        if (workers[i].alloc != NULL) {
+            owf_thread_join(&workers[i].thread);
+            owf_pool_magazine_flush(&workers[i].magazine);
+        }
+        if (ret == 0 && !workers[i].ok) {
+            owf_test_fail("thread " OWF_PRINT_U32 " saw corrupted blocks", i);
+            ret = 2;
+        }
+    }
+
+    /* Everything should be back in the pool */
+    for (uint32_t i = 0; ret == 0 && i < 4; i++) {
+        for (uint32_t cls = 0; cls < OWF_POOL_CLASSES; cls++) {
+            if (workers[i].magazine.free[cls].count != 0) {
+                owf_test_fail("magazine " OWF_PRINT_U32 " wasn't flushed", i);
+                ret = 2;
+                break;
+            }
+        }
+    }
+
+    owf_pool_destroy(&pool);
+    return ret;
+}
+
+static int owf_test_types_str_inline(void) {
+    owf_alloc_t counting = {.malloc = owf_test_counting_malloc, .realloc = owf_test_counting_realloc, .free = free, .max_alloc = OWF_ALLOC_DEFAULT_MAX};
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_str_t str, copy;
+    char longest[OWF_STR_INLINE_SIZE + 1];
+    int ret = 0;
+
+    /* The inline bytes share the array's storage instead of growing the string */
+    if (sizeof(owf_str_t) != 2 * sizeof(owf_memoize_t) + sizeof(owf_array_t) || offsetof(owf_str_t, small.tag) != offsetof(owf_str_t, bytes.capacity)) {
+        OWF_TEST_FAILF("owf_str_t is " OWF_PRINT_SIZE " bytes, and the inline tag doesn't overlay the capacity", sizeof(owf_str_t));
+    }
+
+    /* Short strings don't allocate, and survive being moved */
+    owf_str_init(&str);
+    owf_test_malloc_count = 0;
+    if (!owf_str_set(&str, &counting, &error, "ECG_II")) {
+        OWF_TEST_FAILF("error setting string: %s", owf_error_strerror(&error));
+    } else if (owf_test_malloc_count != 0 || !OWF_STR_INLINE(str)) {
+        OWF_TEST_FAIL("short string was allocated");
+    }
+    memcpy(&copy, &str, sizeof(str));
+    memset(&str, 0xff, sizeof(str));
+    if (strcmp(OWF_STR_PTR(copy), "ECG_II") != 0 || owf_str_length(&copy) != 6) {
+        OWF_TEST_FAIL("inline string didn't survive a copy");
+    }
+
+    /* Longer ones still go on the heap */
+    if (!owf_str_set(&copy, &counting, &error, "a message that's too long to inline")) {
+        OWF_TEST_FAILF("error setting string: %s", owf_error_strerror(&error));
+    } else if (owf_test_malloc_count != 1 || OWF_STR_INLINE(copy) || strcmp(OWF_STR_PTR(copy), "a message that's too long to inline") != 0) {
+        owf_test_fail("long string wasn't allocated");
+        ret = 2;
+    }
+
+    /* The longest string that fits, then an empty one */
+    memset(longest, 'x', OWF_STR_INLINE_SIZE - 1);
+    longest[OWF_STR_INLINE_SIZE - 1] = 0;
+    if (ret == 0 && (!owf_str_set(&copy, &counting, &error, longest) || !OWF_STR_INLINE(copy) || owf_test_malloc_count != 1 || owf_str_length(&copy) != OWF_STR_INLINE_SIZE - 1)) {
+        owf_test_fail("longest inline string wasn't inlined");
+        ret = 2;
+    } else if (ret == 0 && (!owf_str_set(&copy, &counting, &error, "") || OWF_STR_PTR(copy) != NULL || owf_str_length(&copy) != 0)) {
+        owf_test_fail("empty string wasn't empty");
+        ret = 2;
+    }
+
+    /* One more byte goes on the heap */
+    longest[OWF_STR_INLINE_SIZE - 1] = 'x';
+    longest[OWF_STR_INLINE_SIZE] = 0;
+    if (ret == 0 && (!owf_str_set(&copy, &counting, &error, longest) || OWF_STR_INLINE(copy) || owf_test_malloc_count != 2 || strcmp(OWF_STR_PTR(copy), longest) != 0)) {
+        owf_test_fail("string one byte too long was inlined");
+        ret = 2;
+    }
+
+    owf_str_destroy(&copy, &counting);
+    return ret;
+}
+
+/* Returns whether a string read off the wire fits inline, counting its terminator and padding. */
+#define OWF_TEST_STR_FITS(_str) (((owf_str_length(&(_str)) + 4) & ~3u) <= OWF_STR_INLINE_SIZE)
+
+static int owf_test_binary_reader_str_inline_valid_3(void) {
+    owf_alloc_t counting = {.malloc = owf_test_counting_malloc, .realloc = owf_test_counting_realloc, .free = free, .max_alloc = OWF_ALLOC_DEFAULT_MAX};
+    owf_buffer_t buf;
+    owf_binary_reader_t reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf;
+    uint32_t inlined = 0;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &counting, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    }
+
+    /* Every signal ID and unit that fits on the wire, padding included, is stored inline */
+    for (uint32_t i = 0; ret == 0 && i < OWF_ARRAY_LEN(owf->channels); i++) {
+        owf_channel_t *channel = OWF_ARRAY_PTR(owf->channels, owf_channel_t, i);
+        inlined += OWF_STR_INLINE(channel->id);
+        for (uint32_t j = 0; j < OWF_ARRAY_LEN(channel->namespaces); j++) {
+            owf_namespace_t *ns = OWF_ARRAY_PTR(channel->namespaces, owf_namespace_t, j);
+            inlined += OWF_STR_INLINE(ns->id);
+            for (uint32_t k = 0; k < OWF_ARRAY_LEN(ns->signals); k++) {
+                owf_signal_t *signal = OWF_ARRAY_PTR(ns->signals, owf_signal_t, k);
+                if (OWF_STR_INLINE(signal->id) != OWF_TEST_STR_FITS(signal->id) || OWF_STR_INLINE(signal->unit) != OWF_TEST_STR_FITS(signal->unit) ||
+                        strncmp(OWF_STR_PTR(signal->id), "SIG_", 4) != 0) {
+                    owf_test_fail("signal " OWF_PRINT_U32 " of namespace " OWF_PRINT_U32 " of channel " OWF_PRINT_U32 " was stored in the wrong place", k, j, i);
+                    ret = 2;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (ret == 0 && inlined == 0) {
+        owf_test_fail("no channel or namespace IDs were inlined");
+        ret = 2;
+    }
+
+    owf_package_destroy(owf, &counting);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+/* Checks that the IDs and units of two packages decoded through the same intern table share their bytes. */
+static int owf_test_binary_reader_intern_check(owf_package_t *lhs, owf_package_t *rhs) {
+    if (OWF_ARRAY_LEN(lhs->channels) != OWF_ARRAY_LEN(rhs->channels)) {
+        return 2;
+    }
+    for (uint32_t i = 0; i < OWF_ARRAY_LEN(lhs->channels); i++) {
+        owf_channel_t *lc = OWF_ARRAY_PTR(lhs->channels, owf_channel_t, i), *rc = OWF_ARRAY_PTR(rhs->channels, owf_channel_t, i);
+        if (OWF_STR_PTR(lc->id) != OWF_STR_PTR(rc->id) || OWF_ARRAY_LEN(lc->namespaces) != OWF_ARRAY_LEN(rc->namespaces)) {
+            return 2;
+        }
+        for (uint32_t j = 0; j < OWF_ARRAY_LEN(lc->namespaces); j++) {
+            owf_namespace_t *ln = OWF_ARRAY_PTR(lc->namespaces, owf_namespace_t, j), *rn = OWF_ARRAY_PTR(rc->namespaces, owf_namespace_t, j);
+            if (OWF_STR_PTR(ln->id) != OWF_STR_PTR(rn->id) || OWF_ARRAY_LEN(ln->signals) != OWF_ARRAY_LEN(rn->signals)) {
+                return 2;
+            }
+            for (uint32_t k = 0; k < OWF_ARRAY_LEN(ln->signals); k++) {
+                owf_signal_t *ls = OWF_ARRAY_PTR(ln->signals, owf_signal_t, k), *rs = OWF_ARRAY_PTR(rn->signals, owf_signal_t, k);
+                if (OWF_STR_PTR(ls->id) != OWF_STR_PTR(rs->id) || OWF_STR_PTR(ls->unit) != OWF_STR_PTR(rs->unit)) {
+                    return 2;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int owf_test_binary_reader_intern_valid_3(void) {
+    owf_buffer_t buf, interned_buf;
+    owf_binary_reader_t reader, interned_reader, file_reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf = NULL, *interned = NULL, *from_file = NULL;
+    owf_intern_t intern;
+    uint32_t count = 0;
+    int ret = 0;
+
+    owf_intern_init(&intern, &alloc);
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &buf, NULL) ||
+        !owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &interned_reader, &alloc, &error, &interned_buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if (!owf_test_binary_reader_open(&file_reader, OWF_TEST_PATH_TO("binary_valid_3"), &alloc, &error, NULL)) {
+        OWF_TEST_FAIL("error opening file");
+    }
+
+    /* Intern once in place from a buffer, and once through the skip buffer from a file */
+    owf_binary_reader_set_intern(&interned_reader, &intern);
+    owf_binary_reader_set_intern(&file_reader, &intern);
+    if ((owf = owf_binary_materialize(&reader)) == NULL ||
+        (interned = owf_binary_materialize(&interned_reader)) == NULL ||
+        ((count = owf_intern_count(&intern)) == 0) ||
+        (from_file = owf_binary_materialize(&file_reader)) == NULL) {
+        owf_test_fail("error materializing: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (owf_package_compare(owf, interned) != 0 || owf_package_compare(owf, from_file) != 0) {
+        owf_test_fail("interned package did not match");
+        ret = 2;
+    } else if (owf_test_binary_reader_intern_check(interned, from_file) != 0) {
+        owf_test_fail("interned strings weren't shared");
+        ret = 2;
+    } else if (owf_intern_count(&intern) != count) {
+        owf_test_fail("intern table grew from " OWF_PRINT_U32 " to " OWF_PRINT_U32 " strings", count, owf_intern_count(&intern));
+        ret = 2;
+    } else if (count < 16 + 256 + 4096) {
+        owf_test_fail("only " OWF_PRINT_U32 " strings were interned", count);
+        ret = 2;
+    }
+
+    if (owf != NULL) {
+        owf_package_destroy(owf, &alloc);
+    }
+    if (interned != NULL) {
+        owf_package_destroy(interned, &alloc);
+    }
+    if (from_file != NULL) {
+        owf_package_destroy(from_file, &alloc);
+    }
+    owf_intern_destroy(&intern);
+    owf_test_binary_reader_buffer_close(&reader);
+    owf_test_binary_reader_buffer_close(&interned_reader);
+    owf_test_binary_reader_file_close(&file_reader);
+    return ret;
+}
+
+static int owf_test_binary_reader_intern_parallel_valid_3(void) {
+    owf_buffer_t buf, parallel_buf;
+    owf_binary_reader_t reader, parallel_reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf = NULL, *parallel = NULL;
+    owf_intern_t intern;
+    int ret = 0;
+
+    owf_intern_init(&intern, &alloc);
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &buf, NULL) ||
+        !owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &parallel_reader, &alloc, &error, &parallel_buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* The workers all share the reader's table */
+    owf_binary_reader_set_intern(&reader, &intern);
+    owf_binary_reader_set_intern(&parallel_reader, &intern);
+    if ((parallel = owf_binary_materialize_parallel(&parallel_reader, 4, NULL)) == NULL ||
+        (owf = owf_binary_materialize(&reader)) == NULL) {
+        owf_test_fail("error materializing: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else if (owf_package_compare(owf, parallel) != 0) {
+        owf_test_fail("parallel package did not match serial package");
+        ret = 2;
+    } else if (owf_test_binary_reader_intern_check(owf, parallel) != 0) {
+        owf_test_fail("interned strings weren't shared");
+        ret = 2;
+    }
+
+    if (owf != NULL) {
+        owf_package_destroy(owf, &alloc);
+    }
+    if (parallel != NULL) {
+        owf_package_destroy(parallel, &alloc);
+    }
+    owf_intern_destroy(&intern);
+    owf_test_binary_reader_buffer_close(&reader);
+    owf_test_binary_reader_buffer_close(&parallel_reader);
+    return ret;
+}
+
+static int owf_test_binary_reader_materialize_parallel_magazines(void) {
+    owf_pool_t pool;
+    owf_pool_magazine_t magazines[4];
+    owf_alloc_t *allocs[4];
+    owf_buffer_t buf, parallel_buf;
+    owf_binary_reader_t reader, parallel_reader;
+    owf_error_t error = OWF_ERROR_DEFAULT;
+    owf_package_t *owf, *parallel;
+    int ret = 0;
+
+    if (!owf_test_binary_reader_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &reader, &alloc, &error, &buf, NULL)) {
+        OWF_TEST_FAIL("error reading file");
+    } else if ((owf = owf_binary_materialize(&reader)) == NULL) {
+        OWF_TEST_FAILF("error materializing: %s", owf_error_strerror(&error));
+    } else if (!owf_test_binary_read_file(OWF_TEST_PATH_TO("binary_valid_3"), &alloc, &error, &parallel_buf)) {
+        OWF_TEST_FAIL("error reading file");
+    }
+
+    /* Each worker allocates from its own magazine; the package is freed through the pool */
+    owf_pool_init(&pool, &alloc, 0);
+    for (uint32_t i = 0; i < 4; i++) {
+        owf_pool_magazine_init(&magazines[i], &pool);
+        allocs[i] = &magazines[i].alloc;
+    }
+    owf_binary_reader_init_buffer(&parallel_reader, &parallel_buf, &pool.alloc, &error, NULL);
+
+    if ((parallel = owf_binary_materialize_parallel(&parallel_reader, 4, allocs)) == NULL) {
+        owf_test_fail("error materializing in parallel: %s", owf_error_strerror(&error));
+        ret = 2;
+    } else {
+        if (owf_package_compare(owf, parallel) != 0) {
+            owf_test_fail("parallel package did not match serial package");
+            ret = 2;
+        } else if (pool.slab_count == 0) {
+            owf_test_fail("workers didn't allocate from their magazines");
+            ret = 2;
+        }
+        owf_package_destroy(parallel, &pool.alloc);
+    }
+
+    if (ret == 0 && owf_binary_materialize_parallel(&parallel_reader, 0, allocs) != NULL) {
+        owf_test_fail("used per-thread allocators without a thread count");
+        ret = 2;
+    }
+
+    for (uint32_t i = 0; i < 4; i++) {
+        owf_pool_magazine_flush(&magazines[i]);
+    }
+    owf_pool_destroy(&pool);
+    owf_package_destroy(owf, &alloc);
+    owf_free(&alloc, parallel_buf.ptr);
+    owf_test_binary_reader_buffer_close(&reader);
+    return ret;
+}
+
+static owf_test_t tests[] = {
+    {"binary_reader_visitor_file_valid_1", owf_test_binary_reader_visitor_file_valid_1},
+    {"binary_reader_visitor_buffer_valid_1", owf_test_binary_reader_visitor_buffer_valid_1},
+    {"binary_reader_visitor_file_valid_2", owf_test_binary_reader_visitor_file_valid_2},
+    {"binary_reader_visitor_buffer_valid_2", owf_test_binary_reader_visitor_buffer_valid_2},
+    {"binary_reader_visitor_file_valid_3", owf_test_binary_reader_visitor_file_valid_3},
+    {"binary_reader_visitor_buffer_valid_3", owf_test_binary_reader_visitor_buffer_valid_3},
+    {"binary_reader_visitor_file_valid_empty", owf_test_binary_reader_visitor_file_valid_empty},
+    {"binary_reader_visitor_buffer_valid_empty", owf_test_binary_reader_visitor_buffer_valid_empty},
+    {"binary_reader_materialize_file_valid_1", owf_test_binary_reader_materialize_file_valid_1},
+    {"binary_reader_materialize_buffer_valid_1", owf_test_binary_reader_materialize_buffer_valid_1},
     {"binary_reader_materialize_file_valid_2", owf_test_binary_reader_materialize_file_valid_2},
     {"binary_reader_materialize_buffer_valid_2", owf_test_binary_reader_materialize_buffer_valid_2},
     {"binary_reader_materialize_file_valid_3", owf_test_binary_reader_materialize_file_valid_3},
     {"binary_reader_materialize_buffer_valid_3", owf_test_binary_reader_materialize_buffer_valid_3},
     {"binary_reader_materialize_file_valid_empty", owf_test_binary_reader_materialize_file_valid_empty},
     {"binary_reader_materialize_buffer_valid_empty", owf_test_binary_reader_materialize_buffer_valid_empty},
+    {"binary_reader_materialize_borrowed_valid_1", owf_test_binary_reader_materialize_borrowed_valid_1},
+    {"binary_reader_materialize_borrowed_valid_3", owf_test_binary_reader_materialize_borrowed_valid_3},
+    {"binary_reader_materialize_buffer_truncated", owf_test_binary_reader_materialize_buffer_truncated},
+    {"binary_reader_materialize_parallel_valid_2", owf_test_binary_reader_materialize_parallel_valid_2},
+    {"binary_reader_materialize_parallel_valid_3", owf_test_binary_reader_materialize_parallel_valid_3},
+    {"binary_reader_materialize_parallel_corrupt", owf_test_binary_reader_materialize_parallel_corrupt},
+    {"binary_reader_skip_file_valid_3", owf_test_binary_reader_skip_file_valid_3},
+#if OWF_PLATFORM_IS_GNU
+    {"binary_reader_skip_fd_valid_3", owf_test_binary_reader_skip_fd_valid_3},
+#endif
+    {"binary_reader_projection_file_valid_3", owf_test_binary_reader_projection_file_valid_3},
+    {"binary_reader_projection_buffer_valid_3", owf_test_binary_reader_projection_buffer_valid_3},
+    {"binary_reader_projection_no_alloc", owf_test_binary_reader_projection_no_alloc},
+    {"binary_validate_valid_1", owf_test_binary_validate_valid_1},
+    {"binary_validate_valid_3", owf_test_binary_validate_valid_3},
+    {"binary_validate_corrupt", owf_test_binary_validate_corrupt},
+    {"binary_reader_materialize_block_valid_2", owf_test_binary_reader_materialize_block_valid_2},
+    {"binary_reader_materialize_block_valid_3", owf_test_binary_reader_materialize_block_valid_3},
+    {"binary_reader_materialize_block_split_valid_3", owf_test_binary_reader_materialize_block_split_valid_3},
+    {"binary_reader_reuse_steady", owf_test_binary_reader_reuse_steady},
+    {"binary_reader_reuse_reshape", owf_test_binary_reader_reuse_reshape},
+    {"binary_reader_feed_bytewise_valid_1", owf_test_binary_reader_feed_bytewise_valid_1},
+    {"binary_reader_feed_chunked_valid_3", owf_test_binary_reader_feed_chunked_valid_3},
+    {"byteswap64_kernel", owf_test_byteswap64_kernel},
+    {"binary_writer_buffer_valid_1", owf_test_binary_writer_buffer_valid_1},
     {"binary_writer_buffer_valid_empty", owf_test_binary_writer_buffer_valid_empty},
-    {"binary_writer_buffer_valid_empty_channel", owf_test_binary_writer_buffer_valid_empty_channel}
+    {"binary_writer_buffer_valid_empty_channel", owf_test_binary_writer_buffer_valid_empty_channel},
+    {"binary_writer_file_valid_3", owf_test_binary_writer_file_valid_3},
+    {"binary_writer_callback_valid_3", owf_test_binary_writer_callback_valid_3},
+    {"binary_writer_iovec_valid_3", owf_test_binary_writer_iovec_valid_3},
+    {"binary_writer_iovec_in_place_valid_3", owf_test_binary_writer_iovec_in_place_valid_3},
+    {"binary_writer_buffered_valid_3", owf_test_binary_writer_buffered_valid_3},
+    {"binary_writer_buffered_watermarks", owf_test_binary_writer_buffered_watermarks},
+    {"binary_writer_stream_valid_1", owf_test_binary_writer_stream_valid_1},
+    {"binary_writer_stream_valid_3", owf_test_binary_writer_stream_valid_3},
+    {"binary_writer_stream_misuse", owf_test_binary_writer_stream_misuse},
+    {"binary_template_valid_3", owf_test_binary_template_valid_3},
+    {"binary_template_bounds", owf_test_binary_template_bounds},
+    {"binary_writer_parallel_valid_2", owf_test_binary_writer_parallel_valid_2},
+    {"binary_writer_parallel_valid_3", owf_test_binary_writer_parallel_valid_3},
+    {"types_path_memoize", owf_test_types_path_memoize},
+    {"types_memoize_valid_3", owf_test_types_memoize_valid_3},
+    {"binary_writer_growable_valid_3", owf_test_binary_writer_growable_valid_3},
+    {"binary_writer_growable_chunked", owf_test_binary_writer_growable_chunked},
+    {"binary_transform_valid_3", owf_test_binary_transform_valid_3},
+    {"binary_transform_projection", owf_test_binary_transform_projection},
+    {"binary_splice_valid_3", owf_test_binary_splice_valid_3},
+    {"binary_splice_merge", owf_test_binary_splice_merge},
+    {"alloc_vtable_valid_3", owf_test_alloc_vtable_valid_3},
+    {"alloc_vtable_aligned", owf_test_alloc_vtable_aligned},
+    {"arena_valid_3", owf_test_arena_valid_3},
+    {"arena_realloc", owf_test_arena_realloc},
+    {"pool_valid_3", owf_test_pool_valid_3},
+    {"pool_threads", owf_test_pool_threads},
+    {"types_str_inline", owf_test_types_str_inline},
+    {"binary_reader_str_inline_valid_3", owf_test_binary_reader_str_inline_valid_3},
+    {"binary_reader_intern_valid_3", owf_test_binary_reader_intern_valid_3},
+    {"binary_reader_intern_parallel_valid_3", owf_test_binary_reader_intern_parallel_valid_3},
+    {"binary_writer_file_append_valid_3", owf_test_binary_writer_file_append_valid_3},
+    {"binary_template_empty_strings", owf_test_binary_template_empty_strings},
+    {"binary_reader_skip_file_truncated", owf_test_binary_reader_skip_file_truncated},
+#if OWF_PLATFORM_IS_GNU
+    {"binary_reader_skip_fd_truncated", owf_test_binary_reader_skip_fd_truncated},
+#endif
+    {"binary_reader_reuse_empty_str", owf_test_binary_reader_reuse_empty_str},
+    {"binary_reader_feed_error", owf_test_binary_reader_feed_error},
+    {"binary_reader_materialize_parallel_magazines", owf_test_binary_reader_materialize_parallel_magazines}
 };
 
 static bool owf_test_opt(const char *opt, int argc, char **argv) {